@@ -1,8 +1,8 @@
 #include "drw_textcodec.h"
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 #include <cstring>
+#include <string_view>
+#include <vector>
 #include "../drw_base.h"
 #include "drw_cptables.h"
 #include "drw_cptable932.h"
@@ -137,16 +137,154 @@ std::string DRW_TextCodec::fromUtf8(const std::string &s) {
     return conv->fromUtf8(s);
 }
 
+namespace {
+/** true if 's' holds a \U+XXXX encoded char at 'i' */
+bool isEncodedChar(std::string_view s, std::size_t i) {
+    return s[i] == '\\' && i + 6 < s.size() && s[i+1] == 'U' && s[i+2] == '+';
+}
+
+/** value of the leading hex digits of 's' */
+int parseHex(std::string_view s) {
+    int code = 0;
+    for (char c : s) {
+        int digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else
+            break;
+        code = code * 16 + digit;
+    }
+    return code;
+}
+
+/** appends the utf8 bytes of code point 'c', a nul char isn't written */
+void appendUtf8(std::string &res, int c) {
+    if (c < 128) { // 0-7F US-ASCII 7 bits
+        if (c != 0)
+            res += static_cast<char>(c);
+    } else if (c < 0x800) { //80-07FF 2 bytes
+        res += static_cast<char>(0xC0 | (c >> 6));
+        res += static_cast<char>(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) { //800-FFFF 3 bytes
+        res += static_cast<char>(0xe0 | (c >> 12));
+        res += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        res += static_cast<char>(0x80 | (c & 0x3f));
+    } else { //10000-10FFFF 4 bytes
+        res += static_cast<char>(0xf0 | (c >> 18));
+        res += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        res += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        res += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+/** appends 'c' as \U+XXXX encoded text, at least 4 hex digits */
+void appendEncoded(std::string &res, int c) {
+    static const char digits[] = "0123456789ABCDEF";
+    res += "\\U+";
+    int n = 4;
+    while (n < 8 && (c >> (4 * n)) != 0)
+        ++n;
+    for (int k = n - 1; k >= 0; --k)
+        res += digits[(c >> (4 * k)) & 0xF];
+}
+
+/** code point of the utf8 char at 'i', 'b' is its byte length;
+** invalid or truncated chars are decoded as U+FFFD
+**/
+int decodeUtf8(std::string_view s, std::size_t i, int *b) {
+    unsigned char c = s[i];
+    int code;
+    int length;
+    if ( (c& 0xE0)  == 0xC0) { //2 bytes
+        code = c & 0x1F;
+        length = 2;
+    } else if ( (c& 0xF0)  == 0xE0) { //3 bytes
+        code = c & 0x0F;
+        length = 3;
+    } else if ( (c& 0xF8)  == 0xF0) { //4 bytes
+        code = c & 0x07;
+        length = 4;
+    } else {
+        *b = 1;
+        return 0xFFFD;
+    }
+    if (i + length > s.size()) {
+        *b = static_cast<int>(s.size() - i);
+        return 0xFFFD;
+    }
+    for (int k = 1; k < length; k++)
+        code = (code << 6) | (s[i+k] & 0x3F);
+    *b = length;
+    return code;
+}
+
+/** converts the non ascii chars of utf8 text 's' with 'encode', chars it can't
+** convert are written as \U+XXXX encoded text
+**/
+template <typename Encode>
+std::string encodeUtf8(std::string_view s, Encode encode) {
+    std::string result;
+    result.reserve(s.size());
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < s.size();) {
+        if (static_cast<unsigned char>(s[i]) < 0x80) {
+            i++;
+            continue;
+        }
+        result.append(s.substr(j, i - j));
+        int l;
+        int code = decodeUtf8(s, i, &l);
+        if (!encode(result, code))
+            appendEncoded(result, code);
+        i += l;
+        j = i;
+    }
+    result.append(s.substr(j));
+    return result;
+}
+
+/** appends the double byte char 'data' */
+void appendDoubleByte(std::string &res, int data) {
+    res += static_cast<char>(data >> 8);
+    res += static_cast<char>(data & 0xFF);
+}
+
+/** unicode of double byte char 'code' in the entries [sta, end) of the sorted table, 0 if not found */
+int findDoubleByte(const int (*doubleTable)[2], int sta, int end, int code) {
+    const int (*first)[2] = doubleTable + sta;
+    const int (*last)[2] = doubleTable + end;
+    const int (*entry)[2] = std::lower_bound(first, last, code, [](const int (&e)[2], int c) {
+        return e[0] < c;
+    });
+    return (entry != last && (*entry)[0] == code) ? (*entry)[1] : 0;
+}
+
+/** flat map from unicode to double byte chars, the first table entry of a unicode wins */
+std::vector<duint16> reverseDoubleTable(const int (*doubleTable)[2], int length) {
+    std::vector<duint16> reverse(0x10000, 0);
+    for (int k = length - 1; k >= 0; k--) {
+        if (doubleTable[k][1] >= 0 && doubleTable[k][1] < 0x10000)
+            reverse[doubleTable[k][1]] = static_cast<duint16>(doubleTable[k][0]);
+    }
+    return reverse;
+}
+}
+
 std::string DRW_Converter::toUtf8(const std::string &s) {
+    std::string_view text{s};
     std::string result;
-    int j = 0;
-    unsigned int i= 0;
-    for (i=0; i < s.length(); i++) {
-        unsigned char c = s.at(i);
+    result.reserve(text.size());
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < text.size(); i++) {
+        unsigned char c = text[i];
         if (c < 0x80) { //ascii check for /U+????
-            if (c == '\\' && i+6 < s.length() && s.at(i+1) == 'U' && s.at(i+2) == '+') {
-                result += s.substr(j,i-j);
-                result += encodeText(s.substr(i,7));
+            if (isEncodedChar(text, i)) {
+                result.append(text.substr(j, i - j));
+                appendUtf8(result, parseHex(text.substr(i + 3, 4)));
                 i +=6;
                 j = i+1;
             }
@@ -158,60 +296,43 @@ std::string DRW_Converter::toUtf8(const std::string &s) {
             i +=3;
         }
     }
-    result += s.substr(j);
+    result.append(text.substr(j));
 
     return result;
 }
 
 std::string DRW_ConvTable::fromUtf8(const std::string &s) {
-    std::string result;
-    bool notFound;
-    int code;
-
-    int j = 0;
-    for (unsigned int i=0; i < s.length(); i++) {
-        unsigned char c = s.at(i);
-        if (c > 0x7F) { //need to decode
-            result += s.substr(j,i-j);
-            std::string part1 = s.substr(i,4);
-            int l;
-            code = decodeNum(part1, &l);
-            j = i+l;
-            i = j - 1;
-            notFound = true;
-            for (int k=0; k<cpLength; k++){
-                if(table[k] == code) {
-                    result += CPOFFSET + k; //translate from table
-                    notFound = false;
-                    break;
-                }
-            }
-            if (notFound)
-                result += decodeText(code);
+    if (reverseTable.empty()) {
+        // the first table entry of a unicode wins
+        reverseTable.assign(0x10000, 0);
+        for (int k = cpLength - 1; k >= 0; k--) {
+            if (table[k] >= 0 && table[k] < 0x10000)
+                reverseTable[table[k]] = static_cast<unsigned char>(CPOFFSET + k);
         }
     }
-    result += s.substr(j);
-
-    return result;
+    return encodeUtf8(s, [this](std::string &result, int code) {
+        if (code >= 0x10000 || reverseTable[code] == 0)
+            return false;
+        result += static_cast<char>(reverseTable[code]); //translate from table
+        return true;
+    });
 }
 
 std::string DRW_ConvTable::toUtf8(const std::string &s) {
+    std::string_view text{s};
     std::string res;
-    for ( auto it=s.begin() ; it < s.end(); ++it ) {
-        unsigned char c = *it;
+    res.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); i++) {
+        unsigned char c = text[i];
         if (c < 0x80) {
             //check for \U+ encoded text
-            if (c == '\\') {
-                if (s.end()-it > 6 && *(it+1) == 'U' && *(it+2) == '+')  {
-                    res += encodeText(std::string(it, it+7));
-                    it +=6;
-                } else {
-                    res +=c; //no \U+ encoded text write
-                }
+            if (isEncodedChar(text, i)) {
+                appendUtf8(res, parseHex(text.substr(i + 3, 4)));
+                i +=6;
             } else
-                res +=c; //c!='\' ascii char write
+                res +=c; //ascii char write
         } else {//end c < 0x80
-            res += encodeNum(table[c-0x80]); //translate from table
+            appendUtf8(res, table[c-0x80]); //translate from table
         }
     } //end for
 
@@ -219,157 +340,64 @@ std::string DRW_ConvTable::toUtf8(const std::string &s) {
 }
 
 std::string DRW_Converter::encodeText(const std::string &stmp){
-    int code;
-#if defined(__APPLE__)
-    int Succeeded = sscanf (&( stmp.substr(3,4)[0]), "%x", &code );
-    if ( !Succeeded || Succeeded == EOF )
-        code = 0;
-#else
-    std::istringstream sd(stmp.substr(3,4));
-    sd >> std::hex >> code;
-#endif
-    return encodeNum(code);
+    return encodeNum(parseHex(std::string_view{stmp}.substr(3, 4)));
 }
 
 std::string DRW_Converter::decodeText(int c){
-    std::string res = "\\U+";
-    std::string num;
-#if defined(__APPLE__)
-    std::string str(16, '\0');
-    snprintf (&(str[0]), 16, "%04X", c );
-    num = str;
-#else
-    std::stringstream ss;
-    ss << std::uppercase << std::setfill('0') << std::setw(4) << std::hex << c;
-    ss >> num;
-#endif
-    res += num;
+    std::string res;
+    appendEncoded(res, c);
     return res;
 }
 
 std::string DRW_Converter::encodeNum(int c){
-    unsigned char ret[5];
-    if (c < 128) { // 0-7F US-ASCII 7 bits
-        ret[0] = c;
-        ret[1] = 0;
-    } else if (c < 0x800) { //80-07FF 2 bytes
-        ret[0] = 0xC0 | (c >> 6);
-        ret[1] = 0x80 | (c & 0x3f);
-        ret[2] = 0;
-    } else if (c< 0x10000) { //800-FFFF 3 bytes
-        ret[0] = 0xe0 | (c >> 12);
-        ret[1] = 0x80 | ((c >> 6) & 0x3f);
-        ret[2] = 0x80 | (c & 0x3f);
-        ret[3] = 0;
-    } else { //10000-10FFFF 4 bytes
-        ret[0] = 0xf0 | (c >> 18);
-        ret[1] = 0x80 | ((c >> 12) & 0x3f);
-        ret[2] = 0x80 | ((c >> 6) & 0x3f);
-        ret[3] = 0x80 | (c & 0x3f);
-        ret[4] = 0;
-    }
-    return std::string(reinterpret_cast<char*>(ret));
+    std::string res;
+    appendUtf8(res, c);
+    return res;
 }
 
 /** 's' is a string with at least 4 bytes length
 ** returned 'b' is byte length of encoded char: 2,3 or 4
 **/
 int DRW_Converter::decodeNum(const std::string &s, int *b){
-    int code= 0;
-    unsigned char c = s.at(0);
-    if ( (c& 0xE0)  == 0xC0) { //2 bytes
-        code = ( c&0x1F)<<6;
-        code = (s.at(1) &0x3F) | code;
-        *b = 2;
-    } else if ( (c& 0xF0)  == 0xE0) { //3 bytes
-        code = ( c&0x0F)<<12;
-        code = ((s.at(1) &0x3F)<<6) | code;
-        code = (s.at(2) &0x3F) | code;
-        *b = 3;
-    } else if ( (c& 0xF8)  == 0xF0) { //4 bytes
-        code = ( c&0x07)<<18;
-        code = ((s.at(1) &0x3F)<<12) | code;
-        code = ((s.at(2) &0x3F)<<6) | code;
-        code = (s.at(3) &0x3F) | code;
-        *b = 4;
-    }
-
-    return code;
+    return decodeUtf8(s, 0, b);
 }
 
 
 std::string DRW_ConvDBCSTable::fromUtf8(const std::string &s) {
-    std::string result;
-    bool notFound;
-    int code;
-
-    int j = 0;
-    for (unsigned int i=0; i < s.length(); i++) {
-        unsigned char c = s.at(i);
-        if (c > 0x7F) { //need to decode
-            result += s.substr(j,i-j);
-            std::string part1 = s.substr(i,4);
-            int l;
-            code = decodeNum(part1, &l);
-            j = i+l;
-            i = j - 1;
-            notFound = true;
-                for (int k=0; k<cpLength; k++){
-                    if(doubleTable[k][1] == code) {
-                        int data = doubleTable[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            if (notFound)
-                result += decodeText(code);
-        } //direct conversion
-    }
-    result += s.substr(j);
-
-    return result;
+    if (reverseTable.empty())
+        reverseTable = reverseDoubleTable(doubleTable, cpLength);
+    return encodeUtf8(s, [this](std::string &result, int code) {
+        if (code >= 0x10000 || reverseTable[code] == 0)
+            return false;
+        appendDoubleByte(result, reverseTable[code]); //translate from table
+        return true;
+    });
 }
 
 std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
+    std::string_view text{s};
     std::string res;
-    for (auto it=s.begin() ; it < s.end(); ++it ) {
-        bool notFound = true;
-        unsigned char c = *it;
+    res.reserve(text.size() * 3 / 2);
+    for (std::size_t i = 0; i < text.size(); i++) {
+        unsigned char c = text[i];
+        int unicode = 0;
         if (c < 0x80) {
-            notFound = false;
             //check for \U+ encoded text
-            if (c == '\\') {
-                if (s.end()-it > 6 && *(it+1) == 'U' && *(it+2) == '+')  {
-                    res += encodeText(std::string(it, it+7));
-                    it +=6;
-                } else {
-                    res +=c; //no \U+ encoded text write
-                }
+            if (isEncodedChar(text, i)) {
+                appendUtf8(res, parseHex(text.substr(i + 3, 4)));
+                i +=6;
             } else
-                res +=c; //c!='\' ascii char write
+                res +=c; //ascii char write
+            continue;
         } else if(c == 0x80 ){//1 byte table
-            notFound = false;
-            res += encodeNum(0x20AC);//euro sign
-        } else {//2 bytes
-            ++it;
-            int code = (c << 8) | static_cast<unsigned char >(*it);
-            int sta = leadTable[c-0x81];
-            int end = leadTable[c-0x80];
-            for (int k=sta; k<end; k++){
-                if(doubleTable[k][0] == code) {
-                    res += encodeNum(doubleTable[k][1]); //translate from table
-                    notFound = false;
-                    break;
-                }
-            }
+            unicode = 0x20AC;//euro sign
+        } else if (i + 1 < text.size()) {//2 bytes
+            ++i;
+            int code = (c << 8) | static_cast<unsigned char>(text[i]);
+            unicode = findDoubleByte(doubleTable, leadTable[c-0x81], leadTable[c-0x80], code);
         }
         //not found
-        if (notFound) res += encodeNum(NOTFOUND936);
+        appendUtf8(res, unicode != 0 ? unicode : NOTFOUND936);
     } //end for
 
     return res;
@@ -380,73 +408,44 @@ DRW_Conv932Table::DRW_Conv932Table()
 }
 
 std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
-    std::string result;
-    bool notFound;
-    int code;
-
-    int j = 0;
-    for (unsigned int i=0; i < s.length(); i++) {
-        unsigned char c = s.at(i);
-        if (c > 0x7F) { //need to decode
-            result += s.substr(j,i-j);
-            std::string part1 = s.substr(i,4);
-            int l;
-            code = decodeNum(part1, &l);
-            j = i+l;
-            i = j - 1;
-            notFound = true;
-            // 1 byte table
-            if (code > 0xff60 && code < 0xFFA0) {
-                result += code - CPOFFSET932; //translate from table
-                notFound = false;
-            }
-            if (notFound && ( code<0xF8 || (code>0x390 && code<0x542) ||
-                    (code>0x200F && code<0x9FA1) || code>0xF928 )) {
-                for (int k=0; k<cpLength; k++){
-                    if(DRW_DoubleTable932[k][1] == code) {
-                        int data = DRW_DoubleTable932[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            }
-            if (notFound)
-                result += decodeText(code);
-        } //direct conversion
-    }
-    result += s.substr(j);
-
-    return result;
+    if (reverseTable.empty())
+        reverseTable = reverseDoubleTable(DRW_DoubleTable932, cpLength);
+    return encodeUtf8(s, [this](std::string &result, int code) {
+        // 1 byte table
+        if (code > 0xff60 && code < 0xFFA0) {
+            result += static_cast<char>(code - CPOFFSET932); //translate from table
+            return true;
+        }
+        if (( code<0xF8 || (code>0x390 && code<0x542) ||
+                (code>0x200F && code<0x9FA1) || (code>0xF928 && code < 0x10000) )
+                && reverseTable[code] != 0) {
+            appendDoubleByte(result, reverseTable[code]); //translate from table
+            return true;
+        }
+        return false;
+    });
 }
 
 std::string DRW_Conv932Table::toUtf8(const std::string &s) {
+    std::string_view text{s};
     std::string res;
-    for (auto it=s.begin() ; it < s.end(); ++it ) {
-        bool notFound = true;
-        unsigned char c = *it;
+    res.reserve(text.size() * 3 / 2);
+    for (std::size_t i = 0; i < text.size(); i++) {
+        unsigned char c = text[i];
+        int unicode = 0;
         if (c < 0x80) {
-            notFound = false;
             //check for \U+ encoded text
-            if (c == '\\') {
-                if (s.end()-it > 6 && *(it+1) == 'U' && *(it+2) == '+')  {
-                    res += encodeText(std::string(it, it+7));
-                    it +=6;
-                } else {
-                    res +=c; //no \U+ encoded text write
-                }
+            if (isEncodedChar(text, i)) {
+                appendUtf8(res, parseHex(text.substr(i + 3, 4)));
+                i +=6;
             } else
-                res +=c; //c!='\' ascii char write
+                res +=c; //ascii char write
+            continue;
         } else if(c > 0xA0 && c < 0xE0 ){//1 byte table
-            notFound = false;
-            res += encodeNum(c + CPOFFSET932); //translate from table
-        } else {//2 bytes
-            ++it;
-            int code = (c << 8) | static_cast<unsigned char>(*it);
+            unicode = c + CPOFFSET932; //translate from table
+        } else if (i + 1 < text.size()) {//2 bytes
+            ++i;
+            int code = (c << 8) | static_cast<unsigned char>(text[i]);
             int sta=0;
             int end=0;
             if (c > 0x80 && c < 0xA0) {
@@ -456,18 +455,11 @@ std::string DRW_Conv932Table::toUtf8(const std::string &s) {
                 sta = DRW_LeadTable932[c-0xC1];
                 end = DRW_LeadTable932[c-0xC0];
             }
-            if (end > 0) {
-                for (int k=sta; k<end; k++){
-                    if(DRW_DoubleTable932[k][0] == code) {
-                        res += encodeNum(DRW_DoubleTable932[k][1]); //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            }
+            if (end > 0)
+                unicode = findDoubleByte(DRW_DoubleTable932, sta, end, code);
         }
         //not found
-        if (notFound) res += encodeNum(NOTFOUND932);
+        appendUtf8(res, unicode != 0 ? unicode : NOTFOUND932);
     } //end for
 
     return res;
@@ -481,11 +473,12 @@ std::string DRW_ConvUTF16::fromUtf8(const std::string &s){
 
 std::string DRW_ConvUTF16::toUtf8(const std::string &s){//RLZ: pending to write
     std::string res;
-    for ( auto it=s.begin() ; it < s.end(); ++it ) {
-        unsigned char c1 = *it;
-        unsigned char c2 = *(++it);
+    res.reserve(s.size());
+    for (std::size_t i = 0; i + 1 < s.size(); i += 2) {
+        unsigned char c1 = s[i];
+        unsigned char c2 = s[i+1];
         duint16 ch = (c2 <<8) | c1;
-        res +=encodeNum(ch);
+        appendUtf8(res, ch);
     } //end for
 
     return res;
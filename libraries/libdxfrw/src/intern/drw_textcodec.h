@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include "../drw_base.h"
 
 class DRW_Converter;
@@ -59,6 +60,9 @@ public:
     DRW_ConvTable(const int *t, int l):DRW_Converter(t, l) {}
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
+private:
+    /** unicode to code page char, 0 if not found; built on first use */
+    std::vector<unsigned char> reverseTable;
 };
 
 class DRW_ConvDBCSTable : public DRW_Converter {
@@ -74,6 +78,8 @@ public:
 private:
     const int *leadTable{nullptr};
     const int (*doubleTable)[2];
+    /** unicode to double byte char, 0 if not found; built on first use */
+    std::vector<duint16> reverseTable;
 
 };
 
@@ -82,6 +88,9 @@ public:
     DRW_Conv932Table();
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
+private:
+    /** unicode to double byte char, 0 if not found; built on first use */
+    std::vector<duint16> reverseTable;
 
 };
 
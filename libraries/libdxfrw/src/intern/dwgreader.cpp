@@ -10,11 +10,15 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <system_error>
+#include <thread>
 #include "dwgreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
@@ -913,16 +917,48 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
     bool ret = true;
 
     DRW_DBG("\nobject map total size= "); DRW_DBG(ObjectMap.size());
-    auto itB=ObjectMap.begin();
-    auto itE=ObjectMap.end();
-    while (itB != itE) {
-        if (ret) {
-            // once readDwgEntity() failed, just clear the ObjectMap
-            ret = readDwgEntity( dbuf, itB->second, intfa);
+    //entities are sent in handle order, independent of the hash order of ObjectMap
+    std::vector<duint32> handles;
+    handles.reserve(ObjectMap.size());
+    for (const auto& it: ObjectMap)
+        handles.push_back(it.first);
+    std::sort(handles.begin(), handles.end());
+
+    //keep the debug output readable, decode on this thread only
+    unsigned int threads = 1;
+    if (DRW_DBGGL != DRW_dbg::Level::Debug)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t batchSize = threads * 1024;
+
+    std::vector<dwgObjectData> batch;
+    for (size_t first = 0; ret && first < handles.size(); first += batchSize) {
+        size_t last = first + batchSize < handles.size() ? first + batchSize : handles.size();
+        batch.clear();
+        batch.reserve(last - first);
+        //raw data is read sequentially, the stream of the file is not shared between threads
+        for (size_t i = first; i < last; ++i) {
+            auto it = ObjectMap.find(handles[i]);
+            if (it == ObjectMap.end())
+                continue; //already read as vertex of a polyline
+            batch.emplace_back();
+            dwgObjectData &od = batch.back();
+            od.obj = it->second;
+            od.good = readObjectData(dbuf, od);
+        }
+        decodeEntities(batch, threads);
+        //replay in handle order, polylines read its vertices from ObjectMap
+        for (auto &od: batch) {
+            auto it = ObjectMap.find(od.obj.handle);
+            if (it == ObjectMap.end())
+                continue;
+            ObjectMap.erase(it);
+            // once sendEntity() failed, just clear the ObjectMap
+            ret = sendEntity(od, dbuf, intfa);
+            if (!ret)
+                break;
         }
-        ObjectMap.erase( itB);
-        itB = ObjectMap.begin();
     }
+    ObjectMap.clear();
     return ret;
 }
 
@@ -930,11 +966,19 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
  * Reads a dwg drawing entity (dwg object entity) given its offset in the file
  */
 bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa){
-    bool ret = true;
-    duint32 bs = 0;
+    dwgObjectData od;
+    od.obj = obj;
+    od.good = readObjectData(dbuf, od);
+    decodeEntity(od);
+    obj.type = od.obj.type;
+    return sendEntity(od, dbuf, intfa);
+}
 
-    nextEntLink = prevEntLink = 0;// set to 0 to skip unimplemented entities
-    dbuf->setPosition(obj.loc);
+/**
+ * Reads the size and the raw data of a dwg object given its offset in the file
+ */
+bool dwgReader::readObjectData(dwgBuffer *dbuf, dwgObjectData &od){
+    dbuf->setPosition(od.obj.loc);
     //verify if position is ok:
     if (!dbuf->isGood()){
         DRW_DBG(" Warning: readDwgEntity, bad location\n");
@@ -942,24 +986,77 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
     }
     int size = dbuf->getModularShort();
     if (version > DRW::AC1021) {//2010+
-        bs = dbuf->getUModularChar();
+        od.bs = dbuf->getUModularChar();
     }
-    std::vector<duint8> tmpByteStr(size);
-    dbuf->getBytes(tmpByteStr.data(), size);
+    od.data.resize(size);
+    dbuf->getBytes(od.data.data(), size);
     //verify if getBytes is ok:
     if (!dbuf->isGood()) {
         DRW_DBG(" Warning: readDwgEntity, bad size\n");
         return false;
     }
-    dwgBuffer buff(tmpByteStr.data(), size, &decoder);
+    return true;
+}
+
+/**
+ * Creates an empty entity for the dwg object type, nullptr for objects
+ * and unsupported entities
+ */
+std::unique_ptr<DRW_Entity> dwgReader::createEntity(dint16 oType){
+    switch (oType) {
+    case 1: return std::make_unique<DRW_Text>();
+    case 7:
+    case 8: return std::make_unique<DRW_Insert>(); //minsert = 8
+    case 15:    // pline 2D
+    case 16:    // pline 3D
+    case 29: return std::make_unique<DRW_Polyline>(); // pline PFACE
+    case 17: return std::make_unique<DRW_Arc>();
+    case 18: return std::make_unique<DRW_Circle>();
+    case 19: return std::make_unique<DRW_Line>();
+    case 20: return std::make_unique<DRW_DimOrdinate>();
+    case 21: return std::make_unique<DRW_DimLinear>();
+    case 22: return std::make_unique<DRW_DimAligned>();
+    case 23: return std::make_unique<DRW_DimAngular3p>();
+    case 24: return std::make_unique<DRW_DimAngular>();
+    case 25: return std::make_unique<DRW_DimRadial>();
+    case 26: return std::make_unique<DRW_DimDiametric>();
+    case 27: return std::make_unique<DRW_Point>();
+    case 28: return std::make_unique<DRW_3Dface>();
+//    case 30: MESH (not pline)
+    case 31: return std::make_unique<DRW_Solid>();
+    case 32: return std::make_unique<DRW_Trace>();
+    case 34: return std::make_unique<DRW_Viewport>();
+    case 35: return std::make_unique<DRW_Ellipse>();
+    case 36: return std::make_unique<DRW_Spline>();
+    case 40: return std::make_unique<DRW_Ray>();
+    case 41: return std::make_unique<DRW_Xline>();
+    case 44: return std::make_unique<DRW_MText>();
+    case 45: return std::make_unique<DRW_Leader>();
+    case 77: return std::make_unique<DRW_LWPolyline>();
+    case 78: return std::make_unique<DRW_Hatch>();
+    case 101: return std::make_unique<DRW_Image>();
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * Parses the raw data of a dwg entity. Only reads the tables & classes,
+ * can run concurrently for different objects
+ */
+void dwgReader::decodeEntity(dwgObjectData &od){
+    if (!od.good)
+        return;
+    dwgBuffer buff(od.data.data(), od.data.size(), &decoder);
     dint16 oType = buff.getObjType(version);
     buff.resetPosition();
 
     if (oType > 499){
         auto it = classesmap.find(oType);
         if (it == classesmap.end()){//fail, not found in classes set error
-            DRW_DBG("Class "); DRW_DBG(oType);DRW_DBG("not found, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
-            return false;
+            DRW_DBG("Class "); DRW_DBG(oType);DRW_DBG("not found, handle: "); DRW_DBG(od.obj.handle); DRW_DBG("\n");
+            od.good = false;
+            return;
         } else {
             DRW_Class *cl = it->second;
             if (cl->dwgType != 0)
@@ -967,202 +1064,169 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         }
     }
 
-    obj.type = oType;
-    switch (oType) {
-        case 17: {
-            DRW_Arc e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addArc(e);
-            }
-            break; }
-        case 18: {
-            DRW_Circle e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addCircle(e);
-            }
-            break; }
-        case 19:{
-            DRW_Line e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLine(e);
-            }
-            break;}
-        case 27: {
-            DRW_Point e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addPoint(e);
-            }
-            break; }
-        case 35: {
-            DRW_Ellipse e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addEllipse(e);
-            }
-            break; }
+    od.obj.type = oType;
+    od.entity = createEntity(oType);
+    if (od.entity)
+        od.parsed = od.entity->parseDwg(version, &buff, od.bs);
+}
+
+/**
+ * Decodes the entities on a pool of threads, each object is parsed from
+ * its own buffer
+ */
+void dwgReader::decodeEntities(std::vector<dwgObjectData> &objects, unsigned int threads){
+    const size_t chunk = 64;
+    if (threads < 2 || objects.size() <= chunk) {
+        for (auto &od: objects)
+            decodeEntity(od);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto worker = [this, &objects, &next](){
+        for (size_t first = next.fetch_add(chunk); first < objects.size(); first = next.fetch_add(chunk)) {
+            size_t last = first + chunk < objects.size() ? first + chunk : objects.size();
+            for (size_t i = first; i < last; ++i)
+                decodeEntity(objects[i]);
+        }
+    };
+    size_t needed = (objects.size() + chunk - 1) / chunk;
+    if (needed < threads)
+        threads = static_cast<unsigned int>(needed);
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned int i = 1; i < threads; ++i) {
+        try {
+            pool.emplace_back(worker);
+        } catch (const std::system_error&) {
+            break; //the remaining objects are decoded by the running threads
+        }
+    }
+    worker();
+    for (auto &t: pool)
+        t.join();
+}
+
+/**
+ * Completes a decoded entity with table names & polyline vertex and sends it
+ * to the interface, must be called in handle order
+ */
+bool dwgReader::sendEntity(dwgObjectData &od, dwgBuffer *dbuf, DRW_Interface& intfa){
+    nextEntLink = prevEntLink = 0;// set to 0 to skip unimplemented entities
+    if (!od.good)
+        return false;
+    DRW_Entity *ent = od.entity.get();
+    if (ent == nullptr) {
+        //not supported or are object add to remaining map
+        objObjectMap[od.obj.handle]= od.obj;
+        return true;
+    }
+    if (!od.parsed) {
+        DRW_DBG("Warning: Entity type "); DRW_DBG(od.obj.type);DRW_DBG("has failed, handle: "); DRW_DBG(od.obj.handle); DRW_DBG("\n");
+        return false;
+    }
+    parseAttribs(ent);
+    nextEntLink = ent->nextEntLink;
+    prevEntLink = ent->prevEntLink;
+
+    switch (od.obj.type) {
+        case 17:
+            intfa.addArc(*static_cast<DRW_Arc*>(ent));
+            break;
+        case 18:
+            intfa.addCircle(*static_cast<DRW_Circle*>(ent));
+            break;
+        case 19:
+            intfa.addLine(*static_cast<DRW_Line*>(ent));
+            break;
+        case 27:
+            intfa.addPoint(*static_cast<DRW_Point*>(ent));
+            break;
+        case 35:
+            intfa.addEllipse(*static_cast<DRW_Ellipse*>(ent));
+            break;
         case 7:
         case 8: {//minsert = 8
-            DRW_Insert e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.name = findTableName(DRW::BLOCK_RECORD,
-                                       e.blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
-                intfa.addInsert(e);
-            }
-            break; }
-        case 77: {
-            DRW_LWPolyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLWPolyline(e);
-            }
+            auto *e = static_cast<DRW_Insert*>(ent);
+            e->name = findTableName(DRW::BLOCK_RECORD,
+                                    e->blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
+            intfa.addInsert(*e);
             break; }
+        case 77:
+            intfa.addLWPolyline(*static_cast<DRW_LWPolyline*>(ent));
+            break;
         case 1: {
-            DRW_Text e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addText(e);
-            }
+            auto *e = static_cast<DRW_Text*>(ent);
+            e->style = findTableName(DRW::STYLE, e->styleH.ref);
+            intfa.addText(*e);
             break; }
         case 44: {
-            DRW_MText e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addMText(e);
-            }
-            break; }
-        case 28: {
-            DRW_3Dface e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.add3dFace(e);
-            }
-            break; }
-        case 20: {
-            DRW_DimOrdinate e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimOrdinate(&e);
-            }
-            break; }
-        case 21: {
-            DRW_DimLinear e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimLinear(&e);
-            }
-            break; }
-        case 22: {
-            DRW_DimAligned e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAlign(&e);
-            }
-            break; }
-        case 23: {
-            DRW_DimAngular3p e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular3P(&e);
-            }
-            break; }
-        case 24: {
-            DRW_DimAngular e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular(&e);
-            }
-            break; }
-        case 25: {
-            DRW_DimRadial e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimRadial(&e);
-            }
+            auto *e = static_cast<DRW_MText*>(ent);
+            e->style = findTableName(DRW::STYLE, e->styleH.ref);
+            intfa.addMText(*e);
             break; }
+        case 28:
+            intfa.add3dFace(*static_cast<DRW_3Dface*>(ent));
+            break;
+        case 20:
+        case 21:
+        case 22:
+        case 23:
+        case 24:
+        case 25:
         case 26: {
-            DRW_DimDiametric e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimDiametric(&e);
+            auto *e = static_cast<DRW_Dimension*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            switch (od.obj.type) {
+            case 20: intfa.addDimOrdinate(static_cast<DRW_DimOrdinate*>(e)); break;
+            case 21: intfa.addDimLinear(static_cast<DRW_DimLinear*>(e)); break;
+            case 22: intfa.addDimAlign(static_cast<DRW_DimAligned*>(e)); break;
+            case 23: intfa.addDimAngular3P(static_cast<DRW_DimAngular3p*>(e)); break;
+            case 24: intfa.addDimAngular(static_cast<DRW_DimAngular*>(e)); break;
+            case 25: intfa.addDimRadial(static_cast<DRW_DimRadial*>(e)); break;
+            default: intfa.addDimDiametric(static_cast<DRW_DimDiametric*>(e)); break;
             }
             break; }
         case 45: {
-            DRW_Leader e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addLeader(&e);
-            }
-            break; }
-        case 31: {
-            DRW_Solid e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSolid(e);
-            }
-            break; }
-        case 78: {
-            DRW_Hatch e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addHatch(&e);
-            }
-            break; }
-        case 32: {
-            DRW_Trace e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addTrace(e);
-            }
-            break; }
-        case 34: {
-            DRW_Viewport e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addViewport(e);
-            }
-            break; }
-        case 36: {
-            DRW_Spline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSpline(&e);
-            }
-            break; }
-        case 40: {
-            DRW_Ray e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addRay(e);
-            }
+            auto *e = static_cast<DRW_Leader*>(ent);
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+            intfa.addLeader(e);
             break; }
+        case 31:
+            intfa.addSolid(*static_cast<DRW_Solid*>(ent));
+            break;
+        case 78:
+            intfa.addHatch(static_cast<DRW_Hatch*>(ent));
+            break;
+        case 32:
+            intfa.addTrace(*static_cast<DRW_Trace*>(ent));
+            break;
+        case 34:
+            intfa.addViewport(*static_cast<DRW_Viewport*>(ent));
+            break;
+        case 36:
+            intfa.addSpline(static_cast<DRW_Spline*>(ent));
+            break;
+        case 40:
+            intfa.addRay(*static_cast<DRW_Ray*>(ent));
+            break;
         case 15:    // pline 2D
         case 16:    // pline 3D
         case 29: {  // pline PFACE
-            DRW_Polyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                readPlineVertex(e, dbuf);
-                intfa.addPolyline(e);
-            }
-            break; }
-//        case 30: {
-//            DRW_Polyline e;// MESH (not pline)
-//            ENTRY_PARSE(e)
-//            intfa.addRay(e);
-//            break; }
-        case 41: {
-            DRW_Xline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addXline(e);
-            }
+            auto *e = static_cast<DRW_Polyline*>(ent);
+            readPlineVertex(*e, dbuf);
+            intfa.addPolyline(*e);
             break; }
-        case 101: {
-            DRW_Image e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addImage(&e);
-            }
-            break; }
-
+        case 41:
+            intfa.addXline(*static_cast<DRW_Xline*>(ent));
+            break;
+        case 101:
+            intfa.addImage(static_cast<DRW_Image*>(ent));
+            break;
         default:
-            //not supported or are object add to remaining map
-            objObjectMap[obj.handle]= obj;
             break;
     }
-    if (!ret){
-        DRW_DBG("Warning: Entity type "); DRW_DBG(oType);DRW_DBG("has failed, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
-    }
 
-    return ret;
+    return true;
 }
 
 bool dwgReader::readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf){
@@ -1171,16 +1235,19 @@ bool dwgReader::readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf){
     duint32 i=0;
     DRW_DBG("\nentities map total size= "); DRW_DBG(ObjectMap.size());
     DRW_DBG("\nobjects map total size= "); DRW_DBG(objObjectMap.size());
-    auto itB=objObjectMap.begin();
-    auto itE=objObjectMap.end();
-    while (itB != itE){
-        if (ret) {
-            // once readDwgObject() failed, just clear the ObjectMap
-            ret = readDwgObject(dbuf, itB->second, intfa);
-        }
-        objObjectMap.erase(itB);
-        itB=objObjectMap.begin();
+    //objects are sent in handle order, like the entities
+    std::vector<duint32> handles;
+    handles.reserve(objObjectMap.size());
+    for (const auto& it: objObjectMap)
+        handles.push_back(it.first);
+    std::sort(handles.begin(), handles.end());
+    for (duint32 handle: handles){
+        // once readDwgObject() failed, just clear the ObjectMap
+        if (!ret)
+            break;
+        ret = readDwgObject(dbuf, objObjectMap[handle], intfa);
     }
+    objObjectMap.clear();
     if (DRW_DBGGL == DRW_dbg::Level::Debug) {
         for (auto it=remainingMap.begin(); it != remainingMap.end(); ++it){
             DRW_DBG("\nnum.# "); DRW_DBG(i++); DRW_DBG(" Remaining object Handle, loc, type= "); DRW_DBG(it->first);
@@ -16,6 +16,7 @@
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <vector>
 #include "drw_textcodec.h"
 #include "dwgutil.h"
 #include "dwgbuffer.h"
@@ -156,6 +157,21 @@ protected:
     bool readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf);
 
+    /** raw data of a dwg object & the entity decoded from it */
+    struct dwgObjectData {
+        objHandle obj;
+        duint32 bs{0};
+        std::vector<duint8> data;
+        bool good{false}; //data read & type resolved
+        bool parsed{false}; //entity parsed without errors
+        std::unique_ptr<DRW_Entity> entity;
+    };
+    bool readObjectData(dwgBuffer *dbuf, dwgObjectData &od);
+    static std::unique_ptr<DRW_Entity> createEntity(dint16 oType);
+    void decodeEntity(dwgObjectData &od);
+    void decodeEntities(std::vector<dwgObjectData> &objects, unsigned int threads);
+    bool sendEntity(dwgObjectData &od, dwgBuffer *dbuf, DRW_Interface& intfa);
+
 public:
     std::unordered_map<duint32, objHandle>ObjectMap;
     std::unordered_map<duint32, objHandle>objObjectMap; //stores the objects & entities not read in readDwgEntities
@@ -190,20 +206,6 @@ protected:
 //    duint32 blockCtrl;
     duint32 nextEntLink{0};
     duint32 prevEntLink{0};
-
-private:
-    template <class T>
-    bool entryParse(T &e, dwgBuffer &buff, duint32 bs, bool &ret) {
-        ret = e.parseDwg( version, &buff, bs);
-        if (ret) {
-            parseAttribs(&e);
-            nextEntLink = e.nextEntLink;
-            prevEntLink = e.prevEntLink;
-        }
-
-        return ret;
-    }
-
 };
 
 
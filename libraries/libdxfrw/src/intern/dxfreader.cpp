@@ -10,10 +10,25 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "dxfreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
@@ -95,8 +110,13 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return good();
 }
+
+bool dxfReader::good() const {
+    return filestr->good();
+}
+
 int dxfReader::getHandleString(){
     int res;
 #if defined(__APPLE__)
@@ -286,3 +306,232 @@ bool dxfReaderAscii::readBool() {
         return false;
 }
 
+
+bool dxfMappedFile::open(const std::string &fileName) {
+    close();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0
+        || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const char *>(view);
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    //the mapping stays valid after closing the descriptor
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+#if defined(MADV_SEQUENTIAL)
+    madvise(view, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+    m_data = static_cast<const char *>(view);
+    m_size = static_cast<std::size_t>(st.st_size);
+#endif
+    DRW_DBG("dxfMappedFile::open mapped "); DRW_DBG(m_size); DRW_DBG(" bytes\n");
+    return true;
+}
+
+void dxfMappedFile::close() {
+    if (m_data == nullptr)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(const_cast<char *>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+namespace {
+//skip blanks around numbers: group codes are right aligned, and values may be padded
+std::string_view trimmed(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t");
+    if (first == std::string_view::npos)
+        return {};
+    const auto last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+}
+
+dxfReaderAsciiMapped::dxfReaderAsciiMapped(const char *data, std::size_t size)
+    :dxfReader(nullptr)
+    ,m_data{data}
+    ,m_size{size}
+{
+    skip = true;
+}
+
+bool dxfReaderAsciiMapped::readLine(std::string_view *line) {
+    if (m_pos >= m_size) {
+        m_good = false;
+        *line = {};
+        return false;
+    }
+    const char *start = m_data + m_pos;
+    const std::size_t remaining = m_size - m_pos;
+    const char *end = static_cast<const char *>(std::memchr(start, '\n', remaining));
+    std::size_t length;
+    if (end == nullptr) {
+        //last line without newline: the data is read, but as for getline() the stream is not good anymore
+        length = remaining;
+        m_pos = m_size;
+        m_good = false;
+    } else {
+        length = static_cast<std::size_t>(end - start);
+        m_pos += length + 1;
+    }
+    if (length > 0 && start[length - 1] == '\r')
+        --length;
+    *line = std::string_view(start, length);
+    return true;
+}
+
+bool dxfReaderAsciiMapped::readInt(long long *value) {
+    std::string_view line;
+    if (!readLine(&line))
+        return false;
+    std::string_view text = trimmed(line);
+    if (!text.empty() && text.front() == '+')
+        text.remove_prefix(1);
+    //as atoi(), an invalid number is read as 0
+    if (std::from_chars(text.data(), text.data() + text.size(), *value).ec != std::errc())
+        *value = 0;
+    return true;
+}
+
+bool dxfReaderAsciiMapped::readCode(int *code) {
+    long long value {0};
+    readInt(&value);
+    *code = static_cast<int>(value);
+    DRW_DBG(*code); DRW_DBG("\n");
+    return good();
+}
+
+bool dxfReaderAsciiMapped::readString(std::string *text) {
+    type = STRING;
+    std::string_view line;
+    readLine(&line);
+    text->assign(line.data(), line.size());
+    return good();
+}
+
+bool dxfReaderAsciiMapped::readString() {
+    type = STRING;
+    std::string_view line;
+    readLine(&line);
+    //assign() reuses the capacity of strData, so most values are read without allocations
+    strData.assign(line.data(), line.size());
+    DRW_DBG(strData); DRW_DBG("\n");
+    return good();
+}
+
+bool dxfReaderAsciiMapped::readBinary() {
+    return readString();
+}
+
+bool dxfReaderAsciiMapped::readInt16() {
+    type = INT32;
+    long long value {0};
+    if (readInt(&value)) {
+        intData = static_cast<int>(value);
+        DRW_DBG(intData); DRW_DBG("\n");
+        return true;
+    } else
+        return false;
+}
+
+bool dxfReaderAsciiMapped::readInt32() {
+    type = INT32;
+    return readInt16();
+}
+
+bool dxfReaderAsciiMapped::readInt64() {
+    type = INT64;
+    long long value {0};
+    if (readInt(&value)) {
+        intData = static_cast<int>(value);
+        int64 = static_cast<unsigned long long int>(value);
+        DRW_DBG(int64); DRW_DBG(" int64\n");
+        return true;
+    } else
+        return false;
+}
+
+bool dxfReaderAsciiMapped::readDouble() {
+    type = DOUBLE;
+    std::string_view line;
+    if (!readLine(&line))
+        return false;
+    std::string_view text = trimmed(line);
+    if (!text.empty() && text.front() == '+')
+        text.remove_prefix(1);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    if (std::from_chars(text.data(), text.data() + text.size(), doubleData).ec != std::errc()) {
+        DRW_DBG("dxfReaderAsciiMapped::readDouble(): reading double error: ");
+        DRW_DBG(std::string(line));
+        DRW_DBG('\n');
+    }
+#else
+    //no floating point from_chars in the standard library, the value is copied for strtod()
+    char buffer[64];
+    const std::size_t length = text.size() < sizeof(buffer) ? text.size() : sizeof(buffer) - 1;
+    std::memcpy(buffer, text.data(), length);
+    buffer[length] = '\0';
+    char *end = nullptr;
+    const double value = std::strtod(buffer, &end);
+    if (end == buffer) {
+        DRW_DBG("dxfReaderAsciiMapped::readDouble(): reading double error: ");
+        DRW_DBG(std::string(line));
+        DRW_DBG('\n');
+    } else {
+        doubleData = value;
+    }
+#endif
+    DRW_DBG(doubleData); DRW_DBG('\n');
+    return true;
+}
+
+//saved as int or add a bool member??
+bool dxfReaderAsciiMapped::readBool() {
+    type = BOOL;
+    long long value {0};
+    if (readInt(&value)) {
+        intData = static_cast<int>(value);
+        DRW_DBG(intData); DRW_DBG("\n");
+        return true;
+    } else
+        return false;
+}
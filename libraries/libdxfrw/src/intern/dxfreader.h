@@ -13,6 +13,9 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <cstddef>
+#include <string_view>
+
 #include "drw_textcodec.h"
 
 class dxfReader {
@@ -33,6 +36,8 @@ public:
     }
     virtual ~dxfReader() = default;
     bool readRec(int *code);
+    //return false after EOF or a read error, as std::ios::good()
+    virtual bool good() const;
 
     std::string getString() {return strData;}
     int getHandleString();//Convert hex string to int
@@ -99,4 +104,58 @@ public:
     bool readBool() override;
 };
 
+/**
+ * Read only memory mapping of a whole file, used by dxfReaderAsciiMapped.
+ */
+class dxfMappedFile {
+public:
+    dxfMappedFile() = default;
+    ~dxfMappedFile() {close();}
+    dxfMappedFile(const dxfMappedFile &) = delete;
+    dxfMappedFile &operator=(const dxfMappedFile &) = delete;
+
+    //return false if the file can not be mapped, e.g. it's empty or mapping is not supported
+    bool open(const std::string &fileName);
+    void close();
+    const char *data() const {return m_data;}
+    std::size_t size() const {return m_size;}
+
+private:
+    const char *m_data {nullptr};
+    std::size_t m_size {0};
+#if defined(_WIN32)
+    void *m_file {nullptr};
+    void *m_mapping {nullptr};
+#endif
+};
+
+/**
+ * ASCII dxf reader tokenizing a memory mapped file in place: lines are not copied
+ * to temporary strings and numbers are parsed with std::from_chars.
+ */
+class dxfReaderAsciiMapped : public dxfReader {
+public:
+    dxfReaderAsciiMapped(const char *data, std::size_t size);
+    bool good() const override {return m_good;}
+    bool readCode(int *code) override;
+    bool readString(std::string *text) override;
+    bool readString() override;
+    bool readBinary() override;
+    bool readInt16() override;
+    bool readDouble() override;
+    bool readInt32() override;
+    bool readInt64() override;
+    bool readBool() override;
+
+private:
+    //next line without the line end, sets m_good to false at the end of data
+    bool readLine(std::string_view *line);
+    bool readInt(long long *value);
+
+    const char *m_data;
+    std::size_t m_size;
+    std::size_t m_pos {0};
+    bool m_good {true};
+};
+
 #endif // DXFREADER_H
@@ -67,6 +67,7 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
     drw_assert(fileName.empty() == false);
     applyExt = ext;
     std::ifstream filestr;
+    dxfMappedFile mappedFile;
     if (nullptr == interface_) {
         return setError(DRW::BAD_UNKNOWN);
     }
@@ -94,8 +95,14 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
         DRW_DBG("dxfRW::read binary file\n");
     } else {
         binFile = false;
-        filestr.open (fileName.c_str(), std::ios_base::in);
-        reader = new dxfReaderAscii(&filestr);
+        //ascii files are tokenized in place when the file can be mapped to memory
+        if (mappedFile.open(fileName)) {
+            reader = new dxfReaderAsciiMapped(mappedFile.data(), mappedFile.size());
+            DRW_DBG("dxfRW::read mapped ascii file\n");
+        } else {
+            filestr.open (fileName.c_str(), std::ios_base::in);
+            reader = new dxfReaderAscii(&filestr);
+        }
     }
 
     bool isOk {processDxf()};
@@ -45,6 +45,7 @@
 #include "rs_snapper.h"
 #include "lc_crosshair.h"
 #include "lc_defaults.h"
+#include "lc_trace.h"
 #include "rs_units.h"
 #include "lc_cursoroverlayinfo.h"
 #include "lc_overlayentitiescontainer.h"
@@ -350,6 +351,7 @@ RS_Vector RS_Snapper::snapFree(QMouseEvent* e) {
  * @return The coordinates of the point or an invalid vector.
  */
 RS_Vector RS_Snapper::snapPoint(QMouseEvent* e){
+    LC_TRACE_ZONE("snap", "snapPoint");
     pImpData->snapSpot = RS_Vector(false);
     RS_Vector t(false);
 
@@ -640,8 +642,16 @@ RS_Vector RS_Snapper::snapDist(const RS_Vector& coord) {
  * @return The coordinates of the point or an invalid vector.
  */
 RS_Vector RS_Snapper::snapIntersection(const RS_Vector& coord) {
-    RS_Vector vec{};
-    vec = container->getNearestIntersection(coord,nullptr);
+    if (graphicView == nullptr) {
+        return container->getNearestIntersection(coord, nullptr);
+    }
+    LC_IntersectionCache* cache = graphicView->getIntersectionCache();
+    // only intersections within the snap range are searched around the cursor
+    RS_Vector vec = container->getNearestIntersection(coord, nullptr, getSnapRange(), cache);
+    if (!vec.valid && !snapMode.snapFree) {
+        // without free snapping, farther intersections are snapped to
+        vec = container->getNearestIntersection(coord, nullptr, 0., cache);
+    }
     return vec;
 }
 
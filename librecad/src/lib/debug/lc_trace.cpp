@@ -0,0 +1,228 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QThread>
+
+#include "lc_trace.h"
+#include "rs_debug.h"
+
+namespace {
+struct Event {
+    const char* category = nullptr;
+    const char* name = nullptr;
+    std::int64_t start = 0;
+    // the duration of zones, the value of counters
+    double value = 0.;
+    bool isCounter = false;
+};
+
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::size_t dropped = 0;
+    int tid = 0;
+    bool isMainThread = false;
+};
+
+// bounds the memory of a capture, which was forgotten
+constexpr std::size_t maxEventsPerThread = 1 << 22;
+
+struct Registry {
+    std::mutex mutex;
+    // buffers of ended threads are only owned here, and are released by the next start
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    // ids are not reused, so threads of a capture are distinct
+    int lastTid = 0;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer = []() {
+        auto created = std::make_shared<ThreadBuffer>();
+        const QCoreApplication* app = QCoreApplication::instance();
+        created->isMainThread = app != nullptr && QThread::currentThread() == app->thread();
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        created->tid = ++reg.lastTid;
+        reg.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+void append(const Event& event)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock{buffer.mutex};
+    if (buffer.events.size() < maxEventsPerThread) {
+        buffer.events.push_back(event);
+    } else {
+        ++buffer.dropped;
+    }
+}
+
+// names are literals of the code, only quotes and backslashes need escaping
+QByteArray quoted(const char* text)
+{
+    QByteArray result{"\""};
+    for (const char* c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            result += '\\';
+        }
+        result += *c;
+    }
+    result += '"';
+    return result;
+}
+
+QByteArray microseconds(double ns)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", ns / 1000.);
+    return buffer;
+}
+}
+
+void LC_Trace::start()
+{
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+                                         [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                             return buffer.use_count() == 1;
+                                         }),
+                          reg.buffers.end());
+        for (const auto& buffer: reg.buffers) {
+            std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void LC_Trace::stop()
+{
+    s_enabled.store(false, std::memory_order_relaxed);
+}
+
+std::int64_t LC_Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch)
+        .count();
+}
+
+void LC_Trace::complete(const char* category, const char* name, std::int64_t startNs, std::int64_t endNs)
+{
+    append({category, name, startNs, static_cast<double>(endNs - startNs), false});
+}
+
+void LC_Trace::counter(const char* category, const char* name, double value)
+{
+    append({category, name, now(), value, true});
+}
+
+bool LC_Trace::write(const QString& fileName)
+{
+    QFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        RS_DEBUG->print(RS_Debug::D_ERROR, "LC_Trace::write: can't open %s", fileName.toLocal8Bit().constData());
+        return false;
+    }
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    std::size_t dropped = 0;
+    QByteArray json{"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"};
+    bool first = true;
+    auto addEvent = [&json, &first](const QByteArray& event) {
+        if (!first) {
+            json += ",\n";
+        }
+        json += event;
+        first = false;
+    };
+    for (const auto& buffer: reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        const QByteArray threadName = buffer->isMainThread ? QByteArray{"main"} : QByteArray{"worker "} + tid;
+        addEvent(R"({"ph":"M","name":"thread_name","pid":1,"tid":)" + tid + R"(,"args":{"name":")" + threadName
+                 + "\"}}");
+        for (const Event& event: buffer->events) {
+            QByteArray line = "{\"cat\":" + quoted(event.category) + ",\"name\":" + quoted(event.name)
+                              + ",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + microseconds(event.start);
+            if (event.isCounter) {
+                line += ",\"ph\":\"C\",\"args\":{\"value\":" + QByteArray::number(event.value, 'g', 17) + "}}";
+            } else {
+                line += ",\"ph\":\"X\",\"dur\":" + microseconds(event.value) + "}";
+            }
+            addEvent(line);
+        }
+        dropped += buffer->dropped;
+        // flush large captures by parts
+        if (json.size() > (1 << 24)) {
+            file.write(json);
+            json.clear();
+        }
+    }
+    json += "\n]}\n";
+    file.write(json);
+    if (dropped > 0) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_Trace::write: %zu events were dropped", dropped);
+    }
+    return file.error() == QFileDevice::NoError;
+}
+
+LC_TraceCapture::LC_TraceCapture(const QString& fileName):
+    m_fileName{fileName}
+{
+    if (!m_fileName.isEmpty()) {
+        LC_Trace::start();
+    }
+}
+
+LC_TraceCapture::~LC_TraceCapture()
+{
+    if (!m_fileName.isEmpty()) {
+        LC_Trace::stop();
+        LC_Trace::write(m_fileName);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_TRACE_H
+#define LC_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <QString>
+
+#define LC_TRACE_CONCAT_(a, b) a##b
+#define LC_TRACE_CONCAT(a, b) LC_TRACE_CONCAT_(a, b)
+
+// scoped zone, recorded from here to the end of the scope: LC_TRACE_ZONE("render", "drawLayerEntities");
+// the category and the name must be string literals, they are stored by pointer
+#define LC_TRACE_ZONE(category, name) const LC_TraceZone LC_TRACE_CONCAT(lcTraceZone, __LINE__){category, name}
+
+// counter value at this moment; the value isn't evaluated, while tracing is off
+#define LC_TRACE_COUNTER(category, name, value) \
+    do { \
+        if (LC_Trace::isEnabled()) { \
+            LC_Trace::counter(category, name, static_cast<double>(value)); \
+        } \
+    } while (false)
+
+/**
+ * @brief The LC_Trace class, runtime tracing of scoped zones and counters, written as a Chrome trace.
+ *
+ * Tracing is off by default, which costs a relaxed atomic load per zone. While it's on, the events are kept in
+ * buffers per thread, and are written by write() in the Chrome trace event format, which is opened by
+ * chrome://tracing or ui.perfetto.dev. Tracing is started with the --trace command line option or the
+ * LC_TRACE_FILE environment variable, see LC_TraceCapture.
+ */
+class LC_Trace {
+public:
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /** @brief start drop the events of a previous capture, and start recording */
+    static void start();
+    /** @brief stop recording; the events are kept until the next start() */
+    static void stop();
+
+    /**
+     * @brief write the recorded events as Chrome trace JSON
+     * @return false, if the file can't be written
+     */
+    static bool write(const QString& fileName);
+
+    // nanoseconds since the first use of the trace clock
+    static std::int64_t now();
+    static void complete(const char* category, const char* name, std::int64_t startNs, std::int64_t endNs);
+    static void counter(const char* category, const char* name, double value);
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/**
+ * @brief The LC_TraceZone class, records the zone of its lifetime, if tracing was on when it was created.
+ */
+class LC_TraceZone {
+public:
+    LC_TraceZone(const char* category, const char* name):
+        m_category{category}
+        , m_name{name}
+        , m_start{LC_Trace::isEnabled() ? LC_Trace::now() : -1}
+    {}
+
+    ~LC_TraceZone()
+    {
+        if (m_start >= 0) {
+            LC_Trace::complete(m_category, m_name, m_start, LC_Trace::now());
+        }
+    }
+
+    LC_TraceZone(const LC_TraceZone&) = delete;
+    LC_TraceZone& operator=(const LC_TraceZone&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    std::int64_t m_start;
+};
+
+/**
+ * @brief The LC_TraceCapture class, traces for its lifetime and writes the trace to the file, if the file name
+ *        isn't empty.
+ */
+class LC_TraceCapture {
+public:
+    explicit LC_TraceCapture(const QString& fileName);
+    ~LC_TraceCapture();
+
+    LC_TraceCapture(const LC_TraceCapture&) = delete;
+    LC_TraceCapture& operator=(const LC_TraceCapture&) = delete;
+
+private:
+    QString m_fileName;
+};
+
+#endif // LC_TRACE_H
@@ -28,6 +28,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <iostream>
+#include <mutex>
 #include <string_view>
 
 #include <QDateTime>
@@ -38,6 +39,8 @@
 
 namespace {
 FILE *s_logStream = nullptr;
+// entities are updated by worker threads after import, so a message is written at once, without interleaving
+std::mutex s_printMutex;
 }
 
 // The implementation to delegate methods to QTextStream
@@ -237,6 +240,7 @@ RS_Debug::RS_DebugLevel RS_Debug::getLevel() { return debugLevel; }
  */
 void RS_Debug::print(const char *format...) {
     if (debugLevel == D_DEBUGGING) {
+        std::lock_guard<std::mutex> lock{s_printMutex};
         va_list ap;
         va_start(ap, format);
         vfprintf(s_logStream, format, ap);
@@ -255,6 +259,7 @@ void RS_Debug::print(const char *format...) {
 void RS_Debug::print(RS_DebugLevel level, const char *format...) {
 
     if (debugLevel >= level) {
+        std::lock_guard<std::mutex> lock{s_printMutex};
         va_list ap;
         va_start(ap, format);
         vfprintf(s_logStream, format, ap);
@@ -217,9 +217,23 @@ public:
      */
     QStringList findNestedInsert(const QString& bName);
 
+    /**
+     * @return true, if the inserts of this block were updated since the inserts of the graphic were updated last.
+     * Inserts of the block are shared by its instanced inserts, so they are updated by the first of them only.
+     */
+    bool hasUpdatedInserts() const {
+        return m_insertsUpdated;
+    }
+    void setInsertsUpdated(bool updated) {
+        m_insertsUpdated = updated;
+    }
+
 protected:
 	//! Block data
 	RS_BlockData data;
+
+private:
+    bool m_insertsUpdated = false;
 };
 
 
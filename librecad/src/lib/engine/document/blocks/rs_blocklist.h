@@ -29,9 +29,10 @@
 #define RS_BLOCKLIST_H
 
 
+#include <QHash>
 #include <QList>
+#include <QString>
 
-class QString;
 class RS_Block;
 class RS_BlockListListener;
 
@@ -105,6 +106,8 @@ private:
     bool owner = false;
     //! Blocks in the graphic
     QList<RS_Block*> blocks;
+    //! Blocks by name. Block names are unique, and blocks are renamed by rename() only
+    QHash<QString, RS_Block*> blocksByName;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> blockListListeners;
     //! Currently active block
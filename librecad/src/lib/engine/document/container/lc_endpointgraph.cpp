@@ -0,0 +1,206 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "lc_endpointgraph.h"
+#include "rs_entity.h"
+#include "rs_vector.h"
+
+namespace {
+using Cell = std::pair<long long, long long>;
+
+struct CellHash {
+    std::size_t operator()(const Cell& cell) const
+    {
+        return std::hash<long long>{}(cell.first) * 31 + std::hash<long long>{}(cell.second);
+    }
+};
+
+bool isUsable(const RS_Vector& point)
+{
+    return point.valid && std::isfinite(point.x) && std::isfinite(point.y)
+           && std::abs(point.x) < RS_MAXDOUBLE && std::abs(point.y) < RS_MAXDOUBLE;
+}
+
+// cell indices are clamped, so far away points share the border cells
+long long quantize(double coordinate, double cellSize)
+{
+    constexpr double limit = 1e18;
+    return static_cast<long long>(std::floor(std::clamp(coordinate / cellSize, -limit, limit)));
+}
+
+double endpointDistance(const RS_Entity& entity, const RS_Vector& point)
+{
+    double distance = RS_MAXDOUBLE;
+    const RS_Vector start = entity.getStartpoint();
+    if (isUsable(start)) {
+        distance = start.distanceTo(point);
+    }
+    const RS_Vector end = entity.getEndpoint();
+    if (isUsable(end)) {
+        distance = std::min(distance, end.distanceTo(point));
+    }
+    return distance;
+}
+}
+
+struct LC_EndpointGraph::Impl {
+    struct Entry {
+        // the end points as indexed, which may differ from the current ones until the entity is re-indexed
+        std::array<RS_Vector, 2> points;
+        std::size_t order = 0;
+    };
+
+    explicit Impl(double cellSize):
+        m_cellSize{cellSize}
+    {}
+
+    Cell cellOf(const RS_Vector& point) const
+    {
+        return {quantize(point.x, m_cellSize), quantize(point.y, m_cellSize)};
+    }
+
+    void add(RS_Entity* entity, const Cell& cell)
+    {
+        std::vector<RS_Entity*>& entities = m_cells[cell];
+        if (std::find(entities.cbegin(), entities.cend(), entity) == entities.cend()) {
+            entities.push_back(entity);
+        }
+    }
+
+    void erase(RS_Entity* entity, const Cell& cell)
+    {
+        auto it = m_cells.find(cell);
+        if (it == m_cells.end()) {
+            return;
+        }
+        std::vector<RS_Entity*>& entities = it->second;
+        entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
+        if (entities.empty()) {
+            m_cells.erase(it);
+        }
+    }
+
+    double m_cellSize = 1.;
+    std::size_t m_nextOrder = 0;
+    std::unordered_map<Cell, std::vector<RS_Entity*>, CellHash> m_cells;
+    std::unordered_map<RS_Entity*, Entry> m_entries;
+};
+
+LC_EndpointGraph::LC_EndpointGraph(double cellSize):
+    m_pImpl{std::make_unique<Impl>(cellSize)}
+{
+    assert(cellSize > 0.);
+}
+
+LC_EndpointGraph::~LC_EndpointGraph() = default;
+
+void LC_EndpointGraph::insert(RS_Entity* entity)
+{
+    if (entity == nullptr) {
+        return;
+    }
+    remove(entity);
+    Impl::Entry entry{{entity->getStartpoint(), entity->getEndpoint()}, m_pImpl->m_nextOrder++};
+    bool indexed = false;
+    for (const RS_Vector& point: entry.points) {
+        if (isUsable(point)) {
+            m_pImpl->add(entity, m_pImpl->cellOf(point));
+            indexed = true;
+        }
+    }
+    if (indexed) {
+        m_pImpl->m_entries.emplace(entity, entry);
+    }
+}
+
+void LC_EndpointGraph::remove(RS_Entity* entity)
+{
+    auto it = m_pImpl->m_entries.find(entity);
+    if (it == m_pImpl->m_entries.end()) {
+        return;
+    }
+    for (const RS_Vector& point: it->second.points) {
+        if (isUsable(point)) {
+            m_pImpl->erase(entity, m_pImpl->cellOf(point));
+        }
+    }
+    m_pImpl->m_entries.erase(it);
+}
+
+bool LC_EndpointGraph::contains(RS_Entity* entity) const
+{
+    return m_pImpl->m_entries.count(entity) == 1;
+}
+
+void LC_EndpointGraph::clear()
+{
+    m_pImpl->m_cells.clear();
+    m_pImpl->m_entries.clear();
+}
+
+std::size_t LC_EndpointGraph::size() const
+{
+    return m_pImpl->m_entries.size();
+}
+
+double LC_EndpointGraph::getCellSize() const
+{
+    return m_pImpl->m_cellSize;
+}
+
+std::vector<RS_Entity*> LC_EndpointGraph::getConnected(const RS_Vector& point, double tolerance) const
+{
+    assert(tolerance <= m_pImpl->m_cellSize);
+    std::vector<RS_Entity*> connected;
+    if (!isUsable(point)) {
+        return connected;
+    }
+    const Cell center = m_pImpl->cellOf(point);
+    for (long long dx = -1; dx <= 1; ++dx) {
+        for (long long dy = -1; dy <= 1; ++dy) {
+            auto it = m_pImpl->m_cells.find({center.first + dx, center.second + dy});
+            if (it == m_pImpl->m_cells.end()) {
+                continue;
+            }
+            for (RS_Entity* entity: it->second) {
+                if (std::find(connected.cbegin(), connected.cend(), entity) == connected.cend()
+                    && endpointDistance(*entity, point) <= tolerance) {
+                    connected.push_back(entity);
+                }
+            }
+        }
+    }
+    const auto& entries = m_pImpl->m_entries;
+    std::sort(connected.begin(), connected.end(), [&entries](RS_Entity* e1, RS_Entity* e2) {
+        return entries.at(e1).order < entries.at(e2).order;
+    });
+    return connected;
+}
@@ -0,0 +1,75 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ENDPOINTGRAPH_H
+#define LC_ENDPOINTGRAPH_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class RS_Entity;
+class RS_Vector;
+
+/**
+ * @brief The LC_EndpointGraph class, an adjacency index of entities by their start and end points.
+ *
+ * The end points are stored in a hash grid of square cells, keyed by the quantized coordinates. Entities
+ * connected at a point are found among the 3x3 cells around the point, so a chain of N entities is walked in
+ * O(N) instead of searching all entities for each step.
+ *
+ * Entities are inserted or removed individually; an entity whose end points changed in place is re-indexed by
+ * inserting it again. Queries check the current end points of the found entities.
+ */
+class LC_EndpointGraph {
+public:
+    /**
+     * @param cellSize - the size of the grid cells, which is the largest tolerance of queries
+     */
+    explicit LC_EndpointGraph(double cellSize);
+    ~LC_EndpointGraph();
+
+    /**
+     * @brief insert index the start and end points of an entity, or re-index an indexed entity;
+     *        entities without valid end points are not indexed
+     */
+    void insert(RS_Entity* entity);
+    void remove(RS_Entity* entity);
+    bool contains(RS_Entity* entity) const;
+    void clear();
+    std::size_t size() const;
+    double getCellSize() const;
+
+    /**
+     * @brief getConnected entities with the start or the end point within the tolerance of the point,
+     *        in the order of insertion
+     * @param tolerance - the connection tolerance, not larger than the cell size
+     */
+    std::vector<RS_Entity*> getConnected(const RS_Vector& point, double tolerance) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pImpl;
+};
+
+#endif // LC_ENDPOINTGRAPH_H
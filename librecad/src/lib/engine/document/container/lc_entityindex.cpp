@@ -0,0 +1,369 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "lc_entityindex.h"
+#include "rs.h"
+#include "rs_block.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_insert.h"
+#include "rs_vector.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+using BPoint = bg::model::point<double, 2, bg::cs::cartesian>;
+using BBox = bg::model::box<BPoint>;
+using TreeValue = std::pair<BBox, RS_Entity*>;
+using Tree = bgi::rtree<TreeValue, bgi::quadratic<16>>;
+
+namespace {
+
+bool isUsable(const RS_Vector& point)
+{
+    return point.valid && std::isfinite(point.x) && std::isfinite(point.y)
+           && std::abs(point.x) < RS_MAXDOUBLE && std::abs(point.y) < RS_MAXDOUBLE;
+}
+
+void extend(BBox& box, bool& valid, const RS_Vector& point)
+{
+    if (!isUsable(point))
+        return;
+    BPoint p{point.x, point.y};
+    if (valid) {
+        bg::expand(box, p);
+    } else {
+        box = {p, p};
+        valid = true;
+    }
+}
+
+BBox windowBox(const RS_Vector& corner1, const RS_Vector& corner2)
+{
+    return {{std::min(corner1.x, corner2.x), std::min(corner1.y, corner2.y)},
+            {std::max(corner1.x, corner2.x), std::max(corner1.y, corner2.y)}};
+}
+
+// the bounding box of the entity, extended by reference points. Snapping to centers or reference points never
+// finds a point outside of this box
+bool snappingBox(const RS_Entity& entity, BBox& box)
+{
+    // construction lines are infinite, so they are reported by every query
+    if (entity.rtti() == RS2::EntityConstructionLine)
+        return false;
+    bool valid = false;
+    const RS_Vector minV = entity.getMin();
+    const RS_Vector maxV = entity.getMax();
+    if (isUsable(minV) && isUsable(maxV) && minV.x <= maxV.x && minV.y <= maxV.y) {
+        extend(box, valid, minV);
+        extend(box, valid, maxV);
+    }
+    for (const RS_Vector& ref: entity.getRefPoints())
+        extend(box, valid, ref);
+
+    if (entity.rtti() == RS2::EntityInsert && static_cast<const RS_Insert&>(entity).isInstanced()) {
+        // instanced inserts have no sub-entities, so the snapping box of the block is transformed instead
+        auto& insert = static_cast<const RS_Insert&>(entity);
+        BBox blockBox;
+        RS_Block* block = insert.getBlockForInsert();
+        if (block != nullptr && snappingBox(*block, blockBox)) {
+            const RS_Vector blockMin{blockBox.min_corner().get<0>(), blockBox.min_corner().get<1>()};
+            const RS_Vector blockMax{blockBox.max_corner().get<0>(), blockBox.max_corner().get<1>()};
+            const RS_Vector corners[] = {blockMin, {blockMax.x, blockMin.y}, blockMax, {blockMin.x, blockMax.y}};
+            for (int col = 0; col < insert.getCols(); ++col) {
+                for (int row = 0; row < insert.getRows(); ++row) {
+                    for (const RS_Vector& corner: corners)
+                        extend(box, valid, insert.mapToWorld(corner, col, row));
+                }
+            }
+        }
+    } else if (entity.isContainer() && entity.rtti() != RS2::EntitySpline) {
+        // splines are bounded by their stroke points and control points; iterating them would create line children
+        auto* container = static_cast<const RS_EntityContainer*>(&entity);
+        // sub-entities of texts, dimensions and hatches are never snapped to individually
+        if (!container->ignoredOnModification()) {
+            for (const RS_Entity* child: *container) {
+                BBox childBox;
+                if (child != nullptr && snappingBox(*child, childBox)) {
+                    extend(box, valid, {childBox.min_corner().get<0>(), childBox.min_corner().get<1>()});
+                    extend(box, valid, {childBox.max_corner().get<0>(), childBox.max_corner().get<1>()});
+                }
+            }
+        }
+    }
+    return valid;
+}
+}
+
+struct LC_EntityIndex::Impl {
+    struct Entry {
+        BBox box;
+        bool bounded = false;
+        double order = 0.;
+    };
+
+    void insert(RS_Entity* entity, double order)
+    {
+        Entry entry;
+        entry.order = order;
+        entry.bounded = snappingBox(*entity, entry.box);
+        if (entry.bounded)
+            m_tree.insert({entry.box, entity});
+        else
+            m_unbounded.insert(entity);
+        m_entries.emplace(entity, entry);
+        if (entity->getFlag(RS2::FlagSelected))
+            m_selected.insert(entity);
+        if (m_entries.size() == 1) {
+            m_firstOrder = order;
+            m_lastOrder = order;
+        } else {
+            m_firstOrder = std::min(m_firstOrder, order);
+            m_lastOrder = std::max(m_lastOrder, order);
+        }
+    }
+
+    // remove the entity from the geometric part of the index
+    void unlink(RS_Entity* entity, const Entry& entry)
+    {
+        if (entry.bounded)
+            m_tree.remove(TreeValue{entry.box, entity});
+        else
+            m_unbounded.erase(entity);
+    }
+
+    void remove(RS_Entity* entity)
+    {
+        auto it = m_entries.find(entity);
+        if (it == m_entries.end())
+            return;
+        unlink(entity, it->second);
+        m_entries.erase(it);
+        m_dirty.erase(entity);
+        m_selected.erase(entity);
+    }
+
+    // re-index entities changed in place
+    void flush()
+    {
+        if (m_dirty.empty())
+            return;
+        for (RS_Entity* entity: m_dirty) {
+            auto it = m_entries.find(entity);
+            if (it == m_entries.end())
+                continue;
+            Entry& entry = it->second;
+            unlink(entity, entry);
+            entry.bounded = snappingBox(*entity, entry.box);
+            if (entry.bounded)
+                m_tree.insert({entry.box, entity});
+            else
+                m_unbounded.insert(entity);
+        }
+        m_dirty.clear();
+    }
+
+    std::vector<RS_Entity*> sorted(std::vector<std::pair<double, RS_Entity*>>& ordered) const
+    {
+        std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        std::vector<RS_Entity*> result;
+        result.reserve(ordered.size());
+        for (const auto& [order, entity]: ordered)
+            result.push_back(entity);
+        return result;
+    }
+
+    Tree m_tree;
+    std::unordered_map<RS_Entity*, Entry> m_entries;
+    std::unordered_set<RS_Entity*> m_unbounded;
+    std::unordered_set<RS_Entity*> m_dirty;
+    // superset of selected entities: the selection flag is checked on each query
+    std::unordered_set<RS_Entity*> m_selected;
+    double m_firstOrder = 0.;
+    double m_lastOrder = 0.;
+};
+
+LC_EntityIndex::LC_EntityIndex():
+    m_pImpl{std::make_unique<Impl>()}
+{}
+
+LC_EntityIndex::~LC_EntityIndex() = default;
+
+void LC_EntityIndex::append(RS_Entity* entity)
+{
+    if (entity == nullptr || contains(entity))
+        return;
+    m_pImpl->insert(entity, m_pImpl->m_entries.empty() ? 0. : m_pImpl->m_lastOrder + 1.);
+}
+
+void LC_EntityIndex::prepend(RS_Entity* entity)
+{
+    if (entity == nullptr || contains(entity))
+        return;
+    m_pImpl->insert(entity, m_pImpl->m_entries.empty() ? 0. : m_pImpl->m_firstOrder - 1.);
+}
+
+bool LC_EntityIndex::insertBetween(RS_Entity* entity, RS_Entity* previous, RS_Entity* next)
+{
+    if (entity == nullptr || contains(entity))
+        return true;
+    auto itPrevious = m_pImpl->m_entries.find(previous);
+    auto itNext = m_pImpl->m_entries.find(next);
+    if (itPrevious == m_pImpl->m_entries.end() || itNext == m_pImpl->m_entries.end())
+        return false;
+    const double low = itPrevious->second.order;
+    const double high = itNext->second.order;
+    const double order = 0.5 * (low + high);
+    if (!(order > low && order < high))
+        return false;
+    m_pImpl->insert(entity, order);
+    return true;
+}
+
+void LC_EntityIndex::replace(RS_Entity* entity, RS_Entity* replacement)
+{
+    auto it = m_pImpl->m_entries.find(entity);
+    if (it == m_pImpl->m_entries.end())
+        return;
+    const double order = it->second.order;
+    m_pImpl->remove(entity);
+    if (replacement != nullptr && !contains(replacement))
+        m_pImpl->insert(replacement, order);
+}
+
+void LC_EntityIndex::remove(RS_Entity* entity)
+{
+    if (entity != nullptr)
+        m_pImpl->remove(entity);
+}
+
+bool LC_EntityIndex::contains(RS_Entity* entity) const
+{
+    return m_pImpl->m_entries.count(entity) > 0;
+}
+
+bool LC_EntityIndex::precedes(RS_Entity* first, RS_Entity* second) const
+{
+    const auto& entries = m_pImpl->m_entries;
+    auto itFirst = entries.find(first);
+    auto itSecond = entries.find(second);
+    if (itFirst == entries.end() || itSecond == entries.end())
+        return false;
+    return itFirst->second.order < itSecond->second.order;
+}
+
+void LC_EntityIndex::markDirty(RS_Entity* entity)
+{
+    if (contains(entity))
+        m_pImpl->m_dirty.insert(entity);
+}
+
+void LC_EntityIndex::clear()
+{
+    m_pImpl = std::make_unique<Impl>();
+}
+
+std::size_t LC_EntityIndex::size() const
+{
+    return m_pImpl->m_entries.size();
+}
+
+void LC_EntityIndex::visitNearest(const RS_Vector& point, const NearestVisitor& visitor) const
+{
+    m_pImpl->flush();
+    for (RS_Entity* entity: m_pImpl->m_unbounded) {
+        if (!visitor(entity, 0.))
+            return;
+    }
+    const Tree& tree = m_pImpl->m_tree;
+    if (tree.empty())
+        return;
+    const BPoint query{point.x, point.y};
+    // incremental nearest query: values are reported in the order of increasing distance
+    for (auto it = tree.qbegin(bgi::nearest(query, static_cast<unsigned>(tree.size()))); it != tree.qend(); ++it) {
+        if (!visitor(it->second, bg::distance(query, it->first)))
+            return;
+    }
+}
+
+void LC_EntityIndex::visitInBox(const RS_Vector& corner1, const RS_Vector& corner2, const BoxVisitor& visitor) const
+{
+    m_pImpl->flush();
+    for (RS_Entity* entity: m_pImpl->m_unbounded) {
+        if (!visitor(entity))
+            return;
+    }
+    const BBox window = windowBox(corner1, corner2);
+    const Tree& tree = m_pImpl->m_tree;
+    for (auto it = tree.qbegin(bgi::intersects(window)); it != tree.qend(); ++it) {
+        if (!visitor(it->second))
+            return;
+    }
+}
+
+std::vector<RS_Entity*> LC_EntityIndex::entitiesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const
+{
+    std::vector<std::pair<double, RS_Entity*>> ordered;
+    const auto& entries = m_pImpl->m_entries;
+    visitInBox(corner1, corner2, [&ordered, &entries](RS_Entity* entity) {
+        ordered.emplace_back(entries.at(entity).order, entity);
+        return true;
+    });
+    return m_pImpl->sorted(ordered);
+}
+
+void LC_EntityIndex::setSelected(RS_Entity* entity, bool selected)
+{
+    if (!contains(entity))
+        return;
+    if (selected)
+        m_pImpl->m_selected.insert(entity);
+    else
+        m_pImpl->m_selected.erase(entity);
+}
+
+std::vector<RS_Entity*> LC_EntityIndex::selectedInBox(const RS_Vector& corner1, const RS_Vector& corner2) const
+{
+    m_pImpl->flush();
+    const BBox window = windowBox(corner1, corner2);
+    std::vector<std::pair<double, RS_Entity*>> ordered;
+    for (RS_Entity* entity: m_pImpl->m_selected) {
+        if (!entity->getFlag(RS2::FlagSelected))
+            continue;
+        const auto& entry = m_pImpl->m_entries.at(entity);
+        if (!entry.bounded || bg::intersects(window, entry.box))
+            ordered.emplace_back(entry.order, entity);
+    }
+    return m_pImpl->sorted(ordered);
+}
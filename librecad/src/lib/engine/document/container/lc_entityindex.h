@@ -0,0 +1,133 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_ENTITYINDEX_H
+#define LC_ENTITYINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class RS_Entity;
+class RS_Vector;
+
+/**
+ * @brief The LC_EntityIndex class, a spatial index (R-tree) of the direct children of an entity container.
+ *
+ * Each entity is stored with its snapping box: the bounding box extended to cover the reference points
+ * of the entity, and of its sub-entities for containers, so an arc center or a dimension definition point
+ * is never outside the indexed box.
+ * Entities without valid borders and construction lines, which are infinite, are kept aside and are reported
+ * by every query.
+ *
+ * The index is maintained incrementally: entities are inserted or removed individually, and entities whose
+ * geometry changed in place are marked dirty and re-indexed lazily on the next query.
+ *
+ * Each entity also has an order key, which follows the order of the entity list of the container, so results
+ * of window queries can be reported in the drawing order. Selected entities are tracked in a separate set, so
+ * the selection can be drawn without traversing the whole container.
+ */
+class LC_EntityIndex {
+public:
+    /**
+     * @brief Visitor callback for nearest queries
+     * @param entity - the candidate entity
+     * @param boxDistance - the distance from the query point to the snapping box of the entity, which is a lower
+     *                      bound of any distance from the query point to the entity
+     * @return false to stop the query
+     */
+    using NearestVisitor = std::function<bool(RS_Entity* entity, double boxDistance)>;
+    /**
+     * @brief Visitor callback for window queries
+     * @return false to stop the query
+     */
+    using BoxVisitor = std::function<bool(RS_Entity* entity)>;
+
+    LC_EntityIndex();
+    ~LC_EntityIndex();
+
+    /**
+     * @brief append insert an entity after all indexed entities in the drawing order
+     */
+    void append(RS_Entity* entity);
+    /**
+     * @brief prepend insert an entity before all indexed entities in the drawing order
+     */
+    void prepend(RS_Entity* entity);
+    /**
+     * @brief insertBetween insert an entity between two indexed neighbors in the drawing order
+     * @return false, if the order keys of the neighbors are too close to insert between them; the entity is
+     *         not indexed in this case, and the index must be rebuilt
+     */
+    bool insertBetween(RS_Entity* entity, RS_Entity* previous, RS_Entity* next);
+    /**
+     * @brief replace replace an entity keeping its position in the drawing order
+     */
+    void replace(RS_Entity* entity, RS_Entity* replacement);
+    void remove(RS_Entity* entity);
+    bool contains(RS_Entity* entity) const;
+    /**
+     * @brief precedes whether the first entity is before the second one in the drawing order, by their order keys;
+     *        false, if any of them is not indexed
+     */
+    bool precedes(RS_Entity* first, RS_Entity* second) const;
+    /**
+     * @brief markDirty the geometry of the entity was changed in place; the entity is re-indexed on the next query
+     */
+    void markDirty(RS_Entity* entity);
+    void clear();
+    std::size_t size() const;
+
+    /**
+     * @brief visitNearest visit entities in the order of increasing distance from the point to their snapping boxes
+     */
+    void visitNearest(const RS_Vector& point, const NearestVisitor& visitor) const;
+
+    /**
+     * @brief visitInBox visit entities with snapping boxes intersecting the window given by two corners
+     */
+    void visitInBox(const RS_Vector& corner1, const RS_Vector& corner2, const BoxVisitor& visitor) const;
+
+    /**
+     * @brief entitiesInBox entities with snapping boxes intersecting the window given by two corners,
+     *        sorted by the drawing order
+     */
+    std::vector<RS_Entity*> entitiesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const;
+
+    /**
+     * @brief setSelected track selection state of an indexed entity; calls for entities not in the index are ignored
+     */
+    void setSelected(RS_Entity* entity, bool selected);
+    /**
+     * @brief selectedInBox entities with the selection flag set and snapping boxes intersecting the window given
+     *        by two corners, sorted by the drawing order
+     */
+    std::vector<RS_Entity*> selectedInBox(const RS_Vector& corner1, const RS_Vector& corner2) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pImpl;
+};
+
+#endif // LC_ENTITYINDEX_H
@@ -0,0 +1,549 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+
+#include "lc_hatchscanline.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_entitycontainer.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_vector.h"
+
+namespace {
+
+// maximum denominator of the ratio of lattice offsets, for lines merging copies of a tile segment
+constexpr long long maxLatticeDenominator = 1024;
+
+// an edge of the contour: a line from p0 to p1, or an elliptic arc center + major*cos(t) + minor*sin(t),
+// for t in [t0, t1]
+struct Edge {
+    bool line = true;
+    RS_Vector p0;
+    RS_Vector p1;
+    RS_Vector center;
+    RS_Vector major;
+    RS_Vector minor;
+    double t0 = 0.;
+    double t1 = 0.;
+
+    void rotate(const RS_Vector& angleVector)
+    {
+        p0.rotate(angleVector);
+        p1.rotate(angleVector);
+        center.rotate(angleVector);
+        major.rotate(angleVector);
+        minor.rotate(angleVector);
+    }
+
+    RS_Vector pointAt(double t) const
+    {
+        return center + major * std::cos(t) + minor * std::sin(t);
+    }
+};
+
+// a piece of an edge, monotone in the sweep coordinate v. The line v = c crosses the piece, if vLow <= c < vHigh.
+// The half open range counts a contour vertex once, if the contour passes the line there, and zero or two times
+// at a local extremum
+struct Piece {
+    double vLow = 0.;
+    double vHigh = 0.;
+    const Edge* edge = nullptr;
+    // lines: v at p0 and p1
+    // curves: v(t) = v0 + amplitude*cos(t - phase), and t - phase is in the half period [k*pi, (k+1)*pi]
+    double v0 = 0.;
+    double v1 = 0.;
+    double amplitude = 0.;
+    double phase = 0.;
+    long long k = 0;
+
+    // the coordinate along the direction d, where the line v = c crosses the piece
+    double crossing(double c, const RS_Vector& d) const
+    {
+        if (edge->line) {
+            const RS_Vector p = edge->p0 + (edge->p1 - edge->p0) * ((c - v0) / (v1 - v0));
+            return d.dotP(p);
+        }
+        const double x = std::clamp((c - v0) / amplitude, -1., 1.);
+        const double s = (k % 2 == 0) ? std::acos(x) : std::acos(-x);
+        return d.dotP(edge->pointAt(phase + k * M_PI + s));
+    }
+};
+
+// a line of a pattern family, with the dashes [u0 + t*period, u1 + t*period] for any integer t.
+// A period of 0 means a single dash
+struct ScanLine {
+    double c = 0.;
+    double u0 = 0.;
+    double u1 = 0.;
+    double period = 0.;
+};
+
+// the copies of a tile segment
+struct Family {
+    // sweep coordinate of the segment in the tile at the origin
+    double c0 = 0.;
+    // range of the segment along the direction, u0 <= u1
+    double u0 = 0.;
+    double u1 = 0.;
+    // the segment start, in the tile at the origin
+    RS_Vector start;
+};
+
+// pattern segments of the same direction, scanned with the same edge table
+struct Direction {
+    RS_Vector d;
+    RS_Vector n;
+    std::vector<Family> families;
+};
+
+void addPieces(const Edge& edge, const RS_Vector& n, std::vector<Piece>& pieces)
+{
+    if (edge.line) {
+        Piece piece;
+        piece.edge = &edge;
+        piece.v0 = n.dotP(edge.p0);
+        piece.v1 = n.dotP(edge.p1);
+        // edges along the sweep lines are never crossed
+        if (piece.v0 == piece.v1) {
+            return;
+        }
+        piece.vLow = std::min(piece.v0, piece.v1);
+        piece.vHigh = std::max(piece.v0, piece.v1);
+        pieces.push_back(piece);
+        return;
+    }
+    // v(t) = n.center + (n.major)*cos(t) + (n.minor)*sin(t) = v0 + amplitude*cos(t - phase)
+    const double a = n.dotP(edge.major);
+    const double b = n.dotP(edge.minor);
+    const double amplitude = std::hypot(a, b);
+    if (amplitude < RS_TOLERANCE) {
+        return;
+    }
+    const double phase = std::atan2(b, a);
+    const double v0 = n.dotP(edge.center);
+    // split at the extremes of v, t = phase + k*pi
+    for (auto k = static_cast<long long>(std::floor((edge.t0 - phase) / M_PI)); phase + k * M_PI < edge.t1; ++k) {
+        const double tStart = std::max(edge.t0, phase + k * M_PI);
+        const double tEnd = std::min(edge.t1, phase + (k + 1) * M_PI);
+        if (tEnd <= tStart) {
+            continue;
+        }
+        Piece piece;
+        piece.edge = &edge;
+        piece.v0 = v0;
+        piece.amplitude = amplitude;
+        piece.phase = phase;
+        piece.k = k;
+        const double vStart = v0 + amplitude * std::cos(tStart - phase);
+        const double vEnd = v0 + amplitude * std::cos(tEnd - phase);
+        piece.vLow = std::min(vStart, vEnd);
+        piece.vHigh = std::max(vStart, vEnd);
+        if (piece.vLow < piece.vHigh) {
+            pieces.push_back(piece);
+        }
+    }
+}
+
+// finds coprime integers p and q >= 0, with a*q == b*p within tolerance, so the lattice vector (q, -p) is parallel
+// to the lines of a family, and a, b are multiples of the distance between the lines
+bool latticeRatio(double a, double b, long long& p, long long& q)
+{
+    const double tolerance = 1e-8 * std::max(std::abs(a), std::abs(b));
+    if (std::abs(a) <= tolerance) {
+        p = 0;
+        q = 1;
+        return true;
+    }
+    if (std::abs(b) <= tolerance) {
+        p = 1;
+        q = 0;
+        return true;
+    }
+    // convergents of the continued fraction of a/b
+    long long h1 = 1, h2 = 0;
+    long long k1 = 0, k2 = 1;
+    double r = a / b;
+    for (int i = 0; i < 64; ++i) {
+        const double term = std::floor(r);
+        if (std::abs(term) > static_cast<double>(maxLatticeDenominator) * maxLatticeDenominator) {
+            return false;
+        }
+        const auto an = static_cast<long long>(term);
+        const long long h = an * h1 + h2;
+        const long long k = an * k1 + k2;
+        if (k > maxLatticeDenominator) {
+            return false;
+        }
+        if (std::abs(a * k - b * h) <= tolerance * (std::abs(h) + k)) {
+            p = h;
+            q = k;
+            return true;
+        }
+        h2 = h1;
+        h1 = h;
+        k2 = k1;
+        k1 = k;
+        const double fraction = r - term;
+        if (fraction < 1e-12) {
+            return false;
+        }
+        r = 1. / fraction;
+    }
+    return false;
+}
+
+// x*a + y*b == gcd(a, b)
+long long extendedGcd(long long a, long long b, long long& x, long long& y)
+{
+    if (b == 0) {
+        x = a >= 0 ? 1 : -1;
+        y = 0;
+        return std::abs(a);
+    }
+    long long x1 = 0, y1 = 0;
+    const long long g = extendedGcd(b, a % b, x1, y1);
+    x = y1;
+    y = x1 - (a / b) * y1;
+    return g;
+}
+
+// range of n.P for points P of the edge
+void edgeRange(const Edge& edge, const RS_Vector& n, double& low, double& high)
+{
+    if (edge.line) {
+        low = std::min(n.dotP(edge.p0), n.dotP(edge.p1));
+        high = std::max(n.dotP(edge.p0), n.dotP(edge.p1));
+        return;
+    }
+    low = std::min(n.dotP(edge.pointAt(edge.t0)), n.dotP(edge.pointAt(edge.t1)));
+    high = std::max(n.dotP(edge.pointAt(edge.t0)), n.dotP(edge.pointAt(edge.t1)));
+    const double a = n.dotP(edge.major);
+    const double b = n.dotP(edge.minor);
+    const double phase = std::atan2(b, a);
+    for (auto k = static_cast<long long>(std::ceil((edge.t0 - phase) / M_PI)); phase + k * M_PI <= edge.t1; ++k) {
+        const double v = n.dotP(edge.pointAt(phase + k * M_PI));
+        low = std::min(low, v);
+        high = std::max(high, v);
+    }
+}
+}
+
+struct LC_HatchScanline::Data {
+    bool collect(const RS_EntityContainer& container)
+    {
+        for (const RS_Entity* e: container) {
+            if (e == nullptr || e->getFlag(RS2::FlagTemp)) {
+                continue;
+            }
+            if (e->isContainer()) {
+                if (!collect(*static_cast<const RS_EntityContainer*>(e))) {
+                    return false;
+                }
+                continue;
+            }
+            Edge edge;
+            switch (e->rtti()) {
+                case RS2::EntityLine: {
+                    auto* line = static_cast<const RS_Line*>(e);
+                    edge.p0 = line->getStartpoint();
+                    edge.p1 = line->getEndpoint();
+                    break;
+                }
+                case RS2::EntityArc: {
+                    auto* arc = static_cast<const RS_Arc*>(e);
+                    edge.line = false;
+                    edge.center = arc->getCenter();
+                    edge.major = {arc->getRadius(), 0.};
+                    edge.minor = {0., arc->getRadius()};
+                    edge.t0 = arc->isReversed() ? arc->getAngle2() : arc->getAngle1();
+                    edge.t1 = edge.t0 + arc->getAngleLength();
+                    break;
+                }
+                case RS2::EntityCircle: {
+                    auto* circle = static_cast<const RS_Circle*>(e);
+                    edge.line = false;
+                    edge.center = circle->getCenter();
+                    edge.major = {circle->getRadius(), 0.};
+                    edge.minor = {0., circle->getRadius()};
+                    edge.t1 = 2. * M_PI;
+                    break;
+                }
+                case RS2::EntityEllipse: {
+                    auto* ellipse = static_cast<const RS_Ellipse*>(e);
+                    edge.line = false;
+                    edge.center = ellipse->getCenter();
+                    edge.major = ellipse->getMajorP();
+                    edge.minor = RS_Vector{-edge.major.y, edge.major.x} * ellipse->getRatio();
+                    if (ellipse->isEllipticArc()) {
+                        edge.t0 = ellipse->isReversed() ? ellipse->getAngle2() : ellipse->getAngle1();
+                        edge.t1 = edge.t0 + ellipse->getAngleLength();
+                    } else {
+                        edge.t1 = 2. * M_PI;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+            edges.push_back(edge);
+        }
+        return true;
+    }
+
+    std::vector<Edge> edges;
+    bool valid = false;
+};
+
+LC_HatchScanline::LC_HatchScanline(const RS_EntityContainer& contour):
+    m_data{std::make_unique<Data>()}
+{
+    m_data->valid = m_data->collect(contour) && !m_data->edges.empty();
+}
+
+LC_HatchScanline::~LC_HatchScanline() = default;
+
+bool LC_HatchScanline::isValid() const
+{
+    return m_data->valid;
+}
+
+bool LC_HatchScanline::isSupported(const RS_EntityContainer& pattern)
+{
+    return std::all_of(pattern.begin(), pattern.end(), [](const RS_Entity* e) {
+        return e == nullptr || e->rtti() == RS2::EntityLine;
+    });
+}
+
+bool LC_HatchScanline::fill(const RS_EntityContainer& pattern, double angle, std::size_t maxSegments,
+                            std::vector<Segment>& segments) const
+{
+    segments.clear();
+    if (!m_data->valid) {
+        return false;
+    }
+
+    // the pattern frame: the lattice of tiles is axis aligned, and the contour is rotated by -angle
+    const RS_Vector tileOrigin = pattern.getMin();
+    const RS_Vector tileSize = pattern.getSize();
+    std::vector<Direction> directions;
+    for (const RS_Entity* e: pattern) {
+        if (e == nullptr) {
+            continue;
+        }
+        if (e->rtti() != RS2::EntityLine) {
+            return false;
+        }
+        auto* line = static_cast<const RS_Line*>(e);
+        const RS_Vector start = line->getStartpoint() - tileOrigin;
+        const RS_Vector end = line->getEndpoint() - tileOrigin;
+        RS_Vector d = end - start;
+        const double length = d.magnitude();
+        // dots of zero length are scanned as horizontal lines
+        d = length > RS_TOLERANCE ? d / length : RS_Vector{1., 0.};
+        if (d.x < -RS_TOLERANCE || (d.x <= RS_TOLERANCE && d.y < 0.)) {
+            d = -d;
+        }
+        auto it = std::find_if(directions.begin(), directions.end(), [&d](const Direction& direction) {
+            return std::abs(direction.d.x * d.y - direction.d.y * d.x) < RS_TOLERANCE_ANGLE
+                   && direction.d.dotP(d) > 0.;
+        });
+        if (it == directions.end()) {
+            directions.push_back({d, {-d.y, d.x}, {}});
+            it = std::prev(directions.end());
+        }
+        Family family;
+        family.c0 = it->n.dotP(start);
+        family.u0 = std::min(it->d.dotP(start), it->d.dotP(end));
+        family.u1 = std::max(it->d.dotP(start), it->d.dotP(end));
+        family.start = start;
+        it->families.push_back(family);
+    }
+
+    std::vector<Edge> edges = m_data->edges;
+    const RS_Vector toPattern{-angle};
+    for (Edge& edge: edges) {
+        edge.rotate(toPattern);
+    }
+
+    // bounding box of the contour in the pattern frame, for families scanned copy by copy
+    RS_Vector contourMin{RS_MAXDOUBLE, RS_MAXDOUBLE};
+    RS_Vector contourMax{RS_MINDOUBLE, RS_MINDOUBLE};
+    for (const Edge& edge: edges) {
+        double low = 0., high = 0.;
+        edgeRange(edge, {1., 0.}, low, high);
+        contourMin.x = std::min(contourMin.x, low);
+        contourMax.x = std::max(contourMax.x, high);
+        edgeRange(edge, {0., 1.}, low, high);
+        contourMin.y = std::min(contourMin.y, low);
+        contourMax.y = std::max(contourMax.y, high);
+    }
+
+    const RS_Vector toWorld{angle};
+    std::vector<Piece> pieces;
+    std::vector<ScanLine> lines;
+    std::vector<const Piece*> active;
+    std::vector<double> crossings;
+    for (const Direction& direction: directions) {
+        const RS_Vector& d = direction.d;
+        const RS_Vector& n = direction.n;
+
+        // the edge table of the direction, sorted by the sweep coordinate
+        pieces.clear();
+        for (const Edge& edge: edges) {
+            addPieces(edge, n, pieces);
+        }
+        if (pieces.empty()) {
+            continue;
+        }
+        std::sort(pieces.begin(), pieces.end(), [](const Piece& p0, const Piece& p1) {
+            return p0.vLow < p1.vLow;
+        });
+        double vMin = RS_MAXDOUBLE;
+        double vMax = RS_MINDOUBLE;
+        for (const Piece& piece: pieces) {
+            vMin = std::min(vMin, piece.vLow);
+            vMax = std::max(vMax, piece.vHigh);
+        }
+
+        // offsets of lattice vectors across and along the lines
+        const double a = n.x * tileSize.x;
+        const double b = n.y * tileSize.y;
+        const double alpha = d.x * tileSize.x;
+        const double beta = d.y * tileSize.y;
+
+        lines.clear();
+        long long p = 0, q = 0;
+        if (latticeRatio(a, b, p, q)) {
+            // the lines are c0 + m*spacing, and the copies on the same line repeat by the lattice vector (q, -p)
+            const double spacing = q != 0 ? b / q : a / p;
+            const double period = std::abs(q * alpha - p * beta);
+            long long x = 0, y = 0;
+            if (extendedGcd(p, q, x, y) < 0) {
+                x = -x;
+                y = -y;
+            }
+            // the tile (m*x, m*y) has the copy on line m
+            const double shift = x * alpha + y * beta;
+            for (const Family& family: direction.families) {
+                const double m0 = (vMin - family.c0) / spacing;
+                const double m1 = (vMax - family.c0) / spacing;
+                const double mFirst = std::ceil(std::min(m0, m1));
+                const double mLast = std::floor(std::max(m0, m1));
+                if (mLast - mFirst + lines.size() > maxSegments) {
+                    return false;
+                }
+                for (double m = mFirst; m <= mLast; m += 1.) {
+                    const double offset = std::remainder(m * shift, period);
+                    lines.push_back({family.c0 + m * spacing, family.u0 + offset, family.u1 + offset, period});
+                }
+            }
+        } else {
+            // no lattice vector is parallel to the lines, each copy is on its own line
+            for (const Family& family: direction.families) {
+                const RS_Vector end = family.start + d * (family.u1 - family.u0);
+                const double iFirst = std::floor((contourMin.x - std::max(family.start.x, end.x)) / tileSize.x);
+                const double iLast = std::ceil((contourMax.x - std::min(family.start.x, end.x)) / tileSize.x);
+                const double jFirst = std::floor((contourMin.y - std::max(family.start.y, end.y)) / tileSize.y);
+                const double jLast = std::ceil((contourMax.y - std::min(family.start.y, end.y)) / tileSize.y);
+                if ((iLast - iFirst + 1.) * (jLast - jFirst + 1.) + lines.size() > maxSegments) {
+                    return false;
+                }
+                for (double i = iFirst; i <= iLast; i += 1.) {
+                    for (double j = jFirst; j <= jLast; j += 1.) {
+                        const double c = family.c0 + i * a + j * b;
+                        if (c < vMin || c > vMax) {
+                            continue;
+                        }
+                        const double offset = i * alpha + j * beta;
+                        lines.push_back({c, family.u0 + offset, family.u1 + offset, 0.});
+                    }
+                }
+            }
+        }
+        std::sort(lines.begin(), lines.end(), [](const ScanLine& l0, const ScanLine& l1) {
+            return l0.c < l1.c;
+        });
+
+        const RS_Vector dWorld = d.rotated(toWorld);
+        const RS_Vector nWorld = n.rotated(toWorld);
+        auto addSegment = [&](double u0, double u1, double c) {
+            const RS_Vector p0 = dWorld * u0 + nWorld * c;
+            const RS_Vector p1 = dWorld * u1 + nWorld * c;
+            segments.push_back({p0.x, p0.y, p1.x, p1.y});
+        };
+
+        // sweep the lines with the active edge list
+        active.clear();
+        std::size_t nextPiece = 0;
+        for (const ScanLine& line: lines) {
+            const double c = line.c;
+            while (nextPiece < pieces.size() && pieces[nextPiece].vLow <= c) {
+                active.push_back(&pieces[nextPiece++]);
+            }
+            active.erase(std::remove_if(active.begin(), active.end(), [c](const Piece* piece) {
+                return piece->vHigh <= c;
+            }), active.end());
+
+            crossings.clear();
+            for (const Piece* piece: active) {
+                crossings.push_back(piece->crossing(c, d));
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            // inside intervals by the even-odd rule
+            for (std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+                const double inStart = crossings[i];
+                const double inEnd = crossings[i + 1];
+                const bool dot = line.u0 == line.u1;
+                if (line.period <= 0.) {
+                    const double u0 = std::max(inStart, line.u0);
+                    const double u1 = std::min(inEnd, line.u1);
+                    if (u1 > u0 || (dot && u1 == u0)) {
+                        addSegment(u0, u1, c);
+                    }
+                } else if (line.u1 - line.u0 >= line.period - RS_TOLERANCE) {
+                    // continuous line
+                    addSegment(inStart, inEnd, c);
+                } else {
+                    const double tFirst = std::ceil((inStart - line.u1) / line.period);
+                    const double tLast = std::floor((inEnd - line.u0) / line.period);
+                    for (double t = tFirst; t <= tLast; t += 1.) {
+                        const double u0 = std::max(inStart, line.u0 + t * line.period);
+                        const double u1 = std::min(inEnd, line.u1 + t * line.period);
+                        if (u1 > u0 || (dot && u1 == u0)) {
+                            addSegment(u0, u1, c);
+                        }
+                    }
+                }
+                if (segments.size() > maxSegments) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
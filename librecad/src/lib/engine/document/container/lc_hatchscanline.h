@@ -0,0 +1,85 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_HATCHSCANLINE_H
+#define LC_HATCHSCANLINE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class RS_EntityContainer;
+
+/**
+ * @brief The LC_HatchScanline class, fills hatch contours with line based patterns by scanlines.
+ *
+ * A pattern is a tile of line segments, repeated on the lattice of the tile size and rotated by the hatch angle.
+ * All copies of a tile segment lie on a family of parallel lines, which are computed analytically: the copies
+ * on the same line form a dash pattern with the period of the shortest lattice vector along the line.
+ *
+ * The contour edges are split into pieces monotone along the line normal (the sweep coordinate), and sorted
+ * into an edge table. The lines of each direction are swept in the order of their sweep coordinate with an active
+ * edge list; the crossings of a line with the active pieces give the inside intervals by the even-odd rule,
+ * which are intersected with the dashes of the line.
+ *
+ * Contours may contain lines, arcs, circles and ellipses, also inside of sub-containers like polylines.
+ */
+class LC_HatchScanline {
+public:
+    /** a segment of a hatch line, in world coordinates */
+    struct Segment {
+        double x1 = 0.;
+        double y1 = 0.;
+        double x2 = 0.;
+        double y2 = 0.;
+    };
+
+    /**
+     * @param contour - the hatch, or any container with loops of edges
+     */
+    explicit LC_HatchScanline(const RS_EntityContainer& contour);
+    ~LC_HatchScanline();
+
+    /** @return true, if all contour edges are supported */
+    bool isValid() const;
+
+    /** @return true, if the pattern consists of lines only */
+    static bool isSupported(const RS_EntityContainer& pattern);
+
+    /**
+     * @brief fill - creates the segments of the pattern inside of the contour
+     * @param pattern - the scaled pattern tile, only lines are supported
+     * @param angle - the hatch angle
+     * @param maxSegments - maximum number of segments and pattern lines
+     * @param segments - the resulting segments
+     * @return false, if the pattern is not supported, or the limit is exceeded
+     */
+    bool fill(const RS_EntityContainer& pattern, double angle, std::size_t maxSegments,
+              std::vector<Segment>& segments) const;
+
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
+#endif // LC_HATCHSCANLINE_H
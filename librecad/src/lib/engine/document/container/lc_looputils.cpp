@@ -37,6 +37,7 @@
 #include <boost/geometry/geometries/register/point.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
+#include "lc_endpointgraph.h"
 #include "lc_looputils.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
@@ -200,12 +201,16 @@ struct LoopExtractor::LoopData {
     {
         edges.forcedCalculateBorders();
         size = edges.getSize().magnitude();
+        for (RS_Entity* edge: edges)
+            graph.insert(edge);
     }
     double size = 0.;
     RS_Vector vertex;
     RS_Vector vertexTarget;
     RS_Entity* current = nullptr;
     RS_EntityContainer& edges;
+    // end points of the unprocessed edges
+    LC_EndpointGraph graph{g_contourGapTolerance};
 };
 
 LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
@@ -219,15 +224,8 @@ LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
 //------------------------------------------------------------------------------------//
 std::vector<RS_Entity*> LoopExtractor::getConnected() const
 {
-    std::vector<RS_Entity *> connected;
-    std::copy_if(m_data->edges.begin(), m_data->edges.end(), std::back_inserter(connected),
-                 [vertex = m_data->vertex, current = m_data->current](const RS_Entity *e) {
-        if (e == current)
-            return false;
-        double dist = RS_MAXDOUBLE;
-        e->getNearestEndpoint(vertex, &dist);
-        return dist < g_contourGapTolerance;
-    });
+    std::vector<RS_Entity *> connected = m_data->graph.getConnected(m_data->vertex, g_contourGapTolerance);
+    connected.erase(std::remove(connected.begin(), connected.end(), m_data->current), connected.end());
     return connected;
 }
 
@@ -288,6 +286,7 @@ RS_Entity* LoopExtractor::findFirst() const
     m_loop = std::make_unique<RS_EntityContainer>(nullptr, false);
     m_loop->addEntity(m_data->current);
     m_data->edges.removeEntity(first);
+    m_data->graph.remove(first);
     return first;
 }
 
@@ -353,6 +352,7 @@ bool LoopExtractor::findNext() const
     m_data->vertex = (m_data->vertex.squaredTo(m_data->current->getStartpoint()) > RS_TOLERANCE) ? m_data->current->getStartpoint() : m_data->current->getEndpoint();
     m_loop->addEntity(m_data->current);
     m_data->edges.removeEntity(m_data->current);
+    m_data->graph.remove(m_data->current);
     return true;
 }
 
@@ -24,27 +24,37 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <set>
+#include <unordered_set>
 
 #include <QtGlobal>
+#include "lc_endpointgraph.h"
+#include "lc_entityindex.h"
+#include "lc_intersectioncache.h"
 #include "lc_looputils.h"
+#include "lc_trace.h"
 
 #include "qg_dialogfactory.h"
 
+#include "rs_block.h"
 #include "rs_constructionline.h"
 #include "rs_debug.h"
 #include "rs_dimension.h"
 #include "rs_dialogfactory.h"
 #include "rs_ellipse.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_line.h"
 #include "rs_solid.h"
+#include "rs_spline.h"
 #include "rs_painter.h"
 
 namespace {
@@ -73,6 +83,43 @@ namespace {
         entity.getNearestEndpoint(point, &distance);
         return distance;
     }
+
+// containers with fewer entities are searched linearly, as the spatial index doesn't pay off
+    constexpr unsigned spatialIndexThreshold = 128;
+
+// the largest tolerance of end point connections found by the end point graph
+    constexpr double endpointGraphCellSize = 1e-4;
+
+// the window of intersection searches without a range starts at this part of the container size, and is doubled
+    constexpr double intersectionWindowStart = 1. / 1024.;
+
+// widening of the window stops at this count of entities, as each pair of them is tested
+    constexpr std::size_t maxIntersectionCandidates = 2048;
+
+// construction lines and lines on construction layers are infinite, their borders don't bound intersections
+    bool isUnbounded(const RS_Entity &entity) {
+        return entity.rtti() == RS2::EntityConstructionLine || entity.isConstruction(true);
+    }
+
+    bool bordersOverlap(const RS_Entity &first, const RS_Entity &second) {
+        return first.getMax().x + RS_TOLERANCE >= second.getMin().x
+               && second.getMax().x + RS_TOLERANCE >= first.getMin().x
+               && first.getMax().y + RS_TOLERANCE >= second.getMin().y
+               && second.getMax().y + RS_TOLERANCE >= first.getMin().y;
+    }
+
+    bool hasConstructionLayers(const RS_EntityContainer &container) {
+        RS_Graphic *graphic = container.getGraphic();
+        if (graphic == nullptr) {
+            return false;
+        }
+        for (const RS_Layer *layer: *graphic->getLayerList()) {
+            if (layer->isConstruction() && !layer->isFrozen()) {
+                return true;
+            }
+        }
+        return false;
+    }
 }
 
 /**
@@ -93,19 +140,40 @@ RS_EntityContainer::RS_EntityContainer(
     entIdx = -1;
 }
 /**
- * Copy constructor. Makes a deep copy of all entities.
+ * Copy constructor. Makes a shallow copy of the entity list, clone() calls detach()
+ * to create deep copies.
  */
-/*
-RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& ec)
- : RS_Entity(ec) {
-
+RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer &other)
+    : RS_Entity(other)
+    , entities{other.entities}
+    , entitiesDeferred{other.entitiesDeferred}
+    , subContainer{other.subContainer}
+    , autoUpdateBorders{other.autoUpdateBorders}
+    , entIdx{other.entIdx}
+    , autoDelete{other.autoDelete} {
+}
+
+RS_EntityContainer &RS_EntityContainer::operator=(const RS_EntityContainer &other) {
+    if (this != &other) {
+        RS_Entity::operator=(other);
+        entities = other.entities;
+        subContainer = other.subContainer;
+        entitiesDeferred = other.entitiesDeferred;
+        autoUpdateBorders = other.autoUpdateBorders;
+        entIdx = other.entIdx;
+        autoDelete = other.autoDelete;
+        m_spatialIndex.reset();
+        m_endpointGraph.reset();
+    }
+    return *this;
 }
-*/
 
 /**
  * Destructor.
  */
 RS_EntityContainer::~RS_EntityContainer() {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     if (autoDelete) {
         while (!entities.isEmpty())
             delete entities.takeFirst();
@@ -181,6 +249,8 @@ void RS_EntityContainer::detach() {
 
     // clear shared pointers:
     entities.clear();
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     setOwner(autoDel);
 
     // point to new deep copies:
@@ -444,8 +514,17 @@ void RS_EntityContainer::addEntity(RS_Entity *entity) {
     if (entity->rtti() == RS2::EntityImage ||
         entity->rtti() == RS2::EntityHatch) {
         entities.prepend(entity);
+        if (m_spatialIndex != nullptr) {
+            m_spatialIndex->prepend(entity);
+        }
     } else {
         entities.append(entity);
+        if (m_spatialIndex != nullptr) {
+            m_spatialIndex->append(entity);
+        }
+    }
+    if (m_endpointGraph != nullptr) {
+        m_endpointGraph->insert(entity);
     }
     if (autoUpdateBorders) {
         adjustBorders(entity);
@@ -460,6 +539,10 @@ void RS_EntityContainer::appendEntity(RS_Entity *entity) {
     if (!entity)
         return;
     entities.append(entity);
+    if (m_spatialIndex != nullptr)
+        m_spatialIndex->append(entity);
+    if (m_endpointGraph != nullptr)
+        m_endpointGraph->insert(entity);
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -471,6 +554,10 @@ void RS_EntityContainer::appendEntity(RS_Entity *entity) {
 void RS_EntityContainer::prependEntity(RS_Entity *entity) {
     if (!entity) return;
     entities.prepend(entity);
+    if (m_spatialIndex != nullptr)
+        m_spatialIndex->prepend(entity);
+    if (m_endpointGraph != nullptr)
+        m_endpointGraph->insert(entity);
     if (autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -481,33 +568,39 @@ void RS_EntityContainer::prependEntity(RS_Entity *entity) {
  */
 void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *> &entList) {
     if (entList.isEmpty()) return;
-    int ci = 0; //current index for insert without invert order
-    bool ret, into = false;
-    RS_Entity *mid = nullptr;
-    if (index < 1) {
-        ci = 0;
-    } else if (index >= entities.size()) {
-        ci = entities.size() - entList.size();
-    } else {
-        into = true;
-        mid = entities.at(index);
-    }
-
-    for (int i = 0; i < entList.size(); ++i) {
-        RS_Entity *e = entList.at(i);
-        ret = entities.removeOne(e);
-        //if e not exist in entities list remove from entList
-        if (!ret) {
-            entList.removeAt(i);
+    const bool toEnd = index >= entities.size();
+    RS_Entity *mid = (index >= 1 && !toEnd) ? entities.at(index) : nullptr;
+
+    // take the entities out of the list in one pass
+    const std::unordered_set<RS_Entity *> toMove{entList.cbegin(), entList.cend()};
+    std::unordered_set<RS_Entity *> found;
+    auto last = std::remove_if(entities.begin(), entities.end(), [&toMove, &found](RS_Entity *e) {
+        if (toMove.count(e) == 0) {
+            return false;
+        }
+        found.insert(e);
+        return true;
+    });
+    entities.erase(last, entities.end());
+
+    //if e not exist in entities list remove from entList
+    std::vector<RS_Entity *> moved;
+    for (RS_Entity *e: entList) {
+        if (found.erase(e) > 0) {
+            moved.push_back(e);
         }
     }
-    if (into) {
-        ci = entities.indexOf(mid);
-    }
+    entList = QList<RS_Entity *>(moved.cbegin(), moved.cend());
 
-    for (auto e: entList) {
-        entities.insert(ci++, e);
+    int ci = 0; //current index for insert without invert order
+    if (toEnd) {
+        ci = entities.size();
+    } else if (mid != nullptr) {
+        ci = std::max(0, static_cast<int>(entities.indexOf(mid)));
     }
+    insertEntities(ci, moved);
+    // the drawing order changed
+    m_spatialIndex.reset();
 }
 
 /**
@@ -518,6 +611,20 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity *entity) {
     if (!entity) return;
 
     entities.insert(index, entity);
+    if (m_spatialIndex != nullptr) {
+        const int position = index;
+        if (position == 0) {
+            m_spatialIndex->prepend(entity);
+        } else if (position == entities.size() - 1) {
+            m_spatialIndex->append(entity);
+        } else if (!m_spatialIndex->insertBetween(entity, entities.at(position - 1), entities.at(position + 1))) {
+            // no room left in the drawing order keys, rebuild on demand
+            m_spatialIndex.reset();
+        }
+    }
+    if (m_endpointGraph != nullptr) {
+        m_endpointGraph->insert(entity);
+    }
 
     if (autoUpdateBorders) {
         adjustBorders(entity);
@@ -555,6 +662,12 @@ bool RS_EntityContainer::removeEntity(RS_Entity *entity) {
     //    in LibreCAD is never called with nullptr
     bool ret = entities.removeOne(entity);
 
+    if (ret && m_spatialIndex != nullptr) {
+        m_spatialIndex->remove(entity);
+    }
+    if (ret && m_endpointGraph != nullptr) {
+        m_endpointGraph->remove(entity);
+    }
     if (autoDelete && ret) {
         delete entity;
     }
@@ -564,10 +677,99 @@ bool RS_EntityContainer::removeEntity(RS_Entity *entity) {
     return ret;
 }
 
+void RS_EntityContainer::insertEntities(int index, const std::vector<RS_Entity *> &toInsert) {
+    if (toInsert.empty()) {
+        return;
+    }
+    index = std::clamp(index, 0, static_cast<int>(entities.size()));
+    const bool appending = index == entities.size();
+
+    QList<RS_Entity *> inserted;
+    inserted.reserve(static_cast<int>(toInsert.size()));
+    for (RS_Entity *e: toInsert) {
+        if (e != nullptr) {
+            inserted.append(e);
+        }
+    }
+    if (appending) {
+        entities.append(inserted);
+    } else {
+        entities = entities.mid(0, index) + inserted + entities.mid(index);
+    }
+
+    if (m_spatialIndex != nullptr) {
+        if (appending) {
+            for (RS_Entity *e: inserted) {
+                m_spatialIndex->append(e);
+            }
+        } else {
+            // rebuild on demand
+            m_spatialIndex.reset();
+        }
+    }
+    if (m_endpointGraph != nullptr) {
+        for (RS_Entity *e: inserted) {
+            m_endpointGraph->insert(e);
+        }
+    }
+    if (autoUpdateBorders) {
+        for (RS_Entity *e: inserted) {
+            adjustBorders(e);
+        }
+    }
+}
+
+unsigned RS_EntityContainer::removeEntities(const std::vector<RS_Entity *> &toRemove) {
+    if (toRemove.empty()) {
+        return 0;
+    }
+    const std::unordered_set<RS_Entity *> removeSet{toRemove.cbegin(), toRemove.cend()};
+    std::vector<RS_Entity *> removed;
+    removed.reserve(removeSet.size());
+    auto last = std::remove_if(entities.begin(), entities.end(), [&removeSet, &removed](RS_Entity *e) {
+        if (removeSet.count(e) == 0) {
+            return false;
+        }
+        removed.push_back(e);
+        return true;
+    });
+    entities.erase(last, entities.end());
+    if (removed.empty()) {
+        return 0;
+    }
+
+    if (m_spatialIndex != nullptr) {
+        if (removed.size() * 2 > m_spatialIndex->size()) {
+            // cheaper to rebuild on demand
+            m_spatialIndex.reset();
+        } else {
+            for (RS_Entity *e: removed) {
+                m_spatialIndex->remove(e);
+            }
+        }
+    }
+    if (m_endpointGraph != nullptr) {
+        for (RS_Entity *e: removed) {
+            m_endpointGraph->remove(e);
+        }
+    }
+    if (autoDelete) {
+        for (RS_Entity *e: removed) {
+            delete e;
+        }
+    }
+    if (autoUpdateBorders) {
+        calculateBorders();
+    }
+    return static_cast<unsigned>(removed.size());
+}
+
 /**
  * Erases all entities in this container and resets the borders..
  */
 void RS_EntityContainer::clear() {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     if (autoDelete) {
         while (!entities.isEmpty()) {
             RS_Entity * en = entities.takeFirst();
@@ -688,6 +890,7 @@ void RS_EntityContainer::adjustBorders(RS_Entity *entity) {
         if (!entity->isContainer() || entity->count() > 0) {
             minV = RS_Vector::minimum(entity->getMin(), minV);
             maxV = RS_Vector::maximum(entity->getMax(), maxV);
+            updateParentIndex();
         }
 
         // Notify parents. The border for the parent might
@@ -735,6 +938,7 @@ void RS_EntityContainer::calculateBorders() {
         minV.y = 0.0;
         maxV.y = 0.0;
     }
+    updateParentIndex();
 
     RS_DEBUG->print("RS_EntityContainer::calculateBorders: size: %f,%f",
                     getSize().x, getSize().y);
@@ -762,6 +966,12 @@ void RS_EntityContainer::calculateBorders() {
 void RS_EntityContainer::forcedCalculateBorders() {
     //RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
+    if (entitiesDeferred) {
+        // borders of deferred entities are known without creating them
+        calculateBorders();
+        return;
+    }
+
     resetBorders();
     for (RS_Entity *e: entities) {
 
@@ -795,6 +1005,75 @@ void RS_EntityContainer::forcedCalculateBorders() {
     //RS_Entity::calculateBorders();
 }
 
+void RS_EntityContainer::updateEntityIndex(RS_Entity *entity) {
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->markDirty(entity);
+    }
+    // entities without valid end points are not in the graph, and entities not in the container are not added
+    if (m_endpointGraph != nullptr && m_endpointGraph->contains(entity)) {
+        m_endpointGraph->insert(entity);
+    }
+}
+
+void RS_EntityContainer::updateEntitySelection(RS_Entity *entity, bool selected) {
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->setSelected(entity, selected);
+    }
+}
+
+bool RS_EntityContainer::getEntitiesInWindow(const RS_Vector &corner1, const RS_Vector &corner2,
+                                             std::vector<RS_Entity *> &result) const {
+    LC_EntityIndex *index = spatialIndex();
+    if (index == nullptr) {
+        return false;
+    }
+    result = index->entitiesInBox(corner1, corner2);
+    return true;
+}
+
+bool RS_EntityContainer::getSelectedEntitiesInWindow(const RS_Vector &corner1, const RS_Vector &corner2,
+                                                     std::vector<RS_Entity *> &result) const {
+    LC_EntityIndex *index = spatialIndex();
+    if (index == nullptr) {
+        return false;
+    }
+    result = index->selectedInBox(corner1, corner2);
+    return true;
+}
+
+void RS_EntityContainer::invalidateSpatialIndex() {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
+}
+
+LC_EntityIndex *RS_EntityContainer::spatialIndex() const {
+    if (m_spatialIndex == nullptr && count() >= spatialIndexThreshold) {
+        m_spatialIndex = std::make_unique<LC_EntityIndex>();
+        for (RS_Entity *e: entities) {
+            m_spatialIndex->append(e);
+        }
+    }
+    return m_spatialIndex.get();
+}
+
+LC_EndpointGraph *RS_EntityContainer::getEndpointGraph() const {
+    resolveDeferredEntities();
+    if (m_endpointGraph == nullptr) {
+        m_endpointGraph = std::make_unique<LC_EndpointGraph>(endpointGraphCellSize);
+        for (RS_Entity *e: entities) {
+            m_endpointGraph->insert(e);
+        }
+    }
+    return m_endpointGraph.get();
+}
+
+void RS_EntityContainer::updateParentIndex() {
+    RS_EntityContainer *parentContainer = getParent();
+    if (parentContainer != nullptr) {
+        parentContainer->updateEntityIndex(this);
+    }
+}
+
 /**
  * Updates all Dimension entities in this container and / or
  * reposition their labels.
@@ -827,8 +1106,13 @@ void RS_EntityContainer::updateDimensions(bool autoText) {
  * Updates all Insert entities in this container.
  */
 void RS_EntityContainer::updateInserts() {
+    LC_TRACE_ZONE("regen", "updateInserts");
 
-    std::string idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
+    // called for each block and nested container, so the ids are only formatted for debugging
+    std::string idTypeId;
+    if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+        idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
+    }
     RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
 
     for (RS_Entity *e: entities) {
@@ -930,6 +1214,7 @@ void RS_EntityContainer::addRectangle(RS_Vector const& v0, RS_Vector const& v1,R
  * @param level
  */
 RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
+    resolveDeferredEntities();
     RS_Entity *e = nullptr;
     entIdx = -1;
     switch (level) {
@@ -1011,6 +1296,7 @@ RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
  *              \li \p 2 all Entity Containers are resolved
  */
 RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
+    resolveDeferredEntities();
     RS_Entity *e = nullptr;
     if (!entities.size()) return nullptr;
     entIdx = entities.size() - 1;
@@ -1266,6 +1552,7 @@ RS_Entity *RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
  * @return Entity at the given index or nullptr if the index is out of range.
  */
 RS_Entity *RS_EntityContainer::entityAt(int index) {
+    resolveDeferredEntities();
     if (entities.size() > index && index >= 0)
         return entities.at(index);
     else
@@ -1274,6 +1561,13 @@ RS_Entity *RS_EntityContainer::entityAt(int index) {
 
 
 void RS_EntityContainer::setEntityAt(int index, RS_Entity *en) {
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->replace(entities.at(index), en);
+    }
+    if (m_endpointGraph != nullptr) {
+        m_endpointGraph->remove(entities.at(index));
+        m_endpointGraph->insert(en);
+    }
     if (autoDelete && entities.at(index)) {
         delete entities.at(index);
     }
@@ -1293,6 +1587,7 @@ int RS_EntityContainer::entityAt() {
  * Finds the given entity and makes it the current entity if found.
  */
 int RS_EntityContainer::findEntity(RS_Entity const *const entity) {
+    resolveDeferredEntities();
     entIdx = entities.indexOf(const_cast<RS_Entity *>(entity));
     return entIdx;
 }
@@ -1304,13 +1599,14 @@ int RS_EntityContainer::findEntity(RS_Entity const *const entity) {
 RS_Vector RS_EntityContainer::getNearestEndpoint(
     const RS_Vector &coord,
     double *dist) const {
+    resolveDeferredEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    for (RS_Entity *en: entities) {
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->isVisible()){
             auto parent = en->getParent();
             bool checkForEndpoint = true;
@@ -1328,6 +1624,22 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
                 }
             }
         }
+    };
+
+    LC_EntityIndex *index = spatialIndex();
+    if (index != nullptr) {
+        // endpoints are never closer than the bounding box
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (RS_Entity *en: entities) {
+            checkEntity(en);
+        }
     }
 
     return closestPoint;
@@ -1341,23 +1653,29 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
 RS_Vector RS_EntityContainer::getNearestEndpoint(
     const RS_Vector &coord,
     double *dist, RS_Entity **pEntity) const {
+    resolveDeferredEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
+    RS_Entity *closestEntity = nullptr;
 
-    //QListIterator<RS_Entity> it = createIterator();
-    //RS_Entity* en;
-    //while ( (en = it.current())  ) {
-    //    ++it;
+    LC_EntityIndex *index = spatialIndex();
 
-    for (auto en: entities) {
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->getParent() == nullptr || !en->getParent()->ignoredOnModification()) {//no end point for Insert, text, Dim
-            //            std::cout<<"find nearest for entity "<<i0<<std::endl;
             point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist < minDist) {
+            if (!point.valid) {
+                return;
+            }
+            // with the index, entities are not visited in list order, so keep the first one of equally close entities
+            bool closer = curDist < minDist
+                          || (index != nullptr && curDist == minDist && closestEntity != nullptr
+                              && index->precedes(en, closestEntity));
+            if (closer) {
                 closestPoint = point;
+                closestEntity = en;
                 minDist = curDist;
                 if (dist) {
                     *dist = minDist;
@@ -1367,12 +1685,22 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
                 }
             }
         }
+    };
+
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (auto en: entities) {
+            checkEntity(en);
+        }
     }
 
-    //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
-    //    std::cout<<"count()="<<const_cast<RS_EntityContainer*>(this)->count()<<"\tminDist= "<<minDist<<"\tclosestPoint="<<closestPoint;
-    //    if(pEntity ) std::cout<<"\t*pEntity="<<*pEntity;
-    //    std::cout<<std::endl;
     return closestPoint;
 }
 
@@ -1396,13 +1724,13 @@ RS_Vector RS_EntityContainer::getNearestPointOnEntity(
 RS_Vector RS_EntityContainer::getNearestCenter(
     const RS_Vector &coord,
     double *dist) const {
+    resolveDeferredEntities();
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    for (auto en: entities) {
-
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->isVisible()
             && !en->getParent()->ignoredSnap()
             ) {//no center point for spline, text, Dim
@@ -1412,6 +1740,22 @@ RS_Vector RS_EntityContainer::getNearestCenter(
                 minDist = curDist;
             }
         }
+    };
+
+    LC_EntityIndex *index = spatialIndex();
+    if (index != nullptr) {
+        // indexed boxes cover reference points, including centers
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (auto en: entities) {
+            checkEntity(en);
+        }
     }
     if (dist) {
         *dist = minDist;
@@ -1427,13 +1771,13 @@ RS_Vector RS_EntityContainer::getNearestMiddle(
     double *dist,
     int middlePoints
 ) const {
+    resolveDeferredEntities();
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    for (auto en: entities) {
-
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->isVisible()
             && !en->getParent()->ignoredSnap()
             ) {//no midle point for spline, text, Dim
@@ -1443,6 +1787,21 @@ RS_Vector RS_EntityContainer::getNearestMiddle(
                 minDist = curDist;
             }
         }
+    };
+
+    LC_EntityIndex *index = spatialIndex();
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (auto en: entities) {
+            checkEntity(en);
+        }
     }
     if (dist) {
         *dist = minDist;
@@ -1473,38 +1832,79 @@ RS_Vector RS_EntityContainer::getNearestDist(
  */
 RS_Vector RS_EntityContainer::getNearestIntersection(
     const RS_Vector &coord,
-    double *dist) {
+    double *dist,
+    double range,
+    LC_IntersectionCache *cache) {
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist = RS_MAXDOUBLE;  // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
-    RS_VectorSolutions sol;
-    RS_Entity *closestEntity;
-
-    closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
 
-    if (closestEntity) {
-        for (RS_Entity *en = firstEntity(RS2::ResolveAllButTextImage);
-             en;
-             en = nextEntity(RS2::ResolveAllButTextImage)) {
-            if (
-                !en->isVisible()
-                || en->getParent()->ignoredSnap()
-                ) {
-                continue;
+    auto checkPair = [&](RS_Entity *first, RS_Entity *second) {
+        // temporary copies get new ids for each query, so they are not cached
+        const bool cached = cache != nullptr && !first->getFlag(RS2::FlagTemp) && !second->getFlag(RS2::FlagTemp);
+        const RS_VectorSolutions sol = cached
+                                       ? cache->getIntersection(first, second)
+                                       : RS_Information::getIntersection(first, second, true);
+        point = sol.getClosest(coord, &curDist, nullptr);
+        if (sol.getNumber() > 0 && curDist < minDist) {
+            closestPoint = point;
+            minDist = curDist;
+        }
+    };
+
+    // an intersection within the range lies on both entities, so only entities with borders in the
+    // window around the point are tested against each other. Returns the count of tested entities
+    auto searchWindow = [&](double windowRange) {
+        const RS_Vector windowMin = coord - RS_Vector(windowRange, windowRange);
+        const RS_Vector windowMax = coord + RS_Vector(windowRange, windowRange);
+        std::vector<RS_Entity *> candidates;
+        std::vector<std::unique_ptr<RS_Entity>> copies;
+        auto addCandidates = [&](RS_Entity *en) {
+            addIntersectionCandidates(en, windowMin, windowMax, candidates, copies);
+            return true;
+        };
+        LC_EntityIndex *index = spatialIndex();
+        // lines on construction layers are infinite, so they are not found by their indexed boxes
+        if (index != nullptr && !hasConstructionLayers(*this)) {
+            index->visitInBox(windowMin, windowMax, addCandidates);
+        } else {
+            for (RS_Entity *en: entities) {
+                addCandidates(en);
             }
+        }
 
-            sol = RS_Information::getIntersection(closestEntity,
-                                                  en,
-                                                  true);
-
-            point = sol.getClosest(coord, &curDist, nullptr);
-            if (sol.getNumber() > 0 && curDist < minDist) {
-                closestPoint = point;
-                minDist = curDist;
+        minDist = windowRange;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            RS_Entity *first = candidates[i];
+            const bool firstBounded = !isUnbounded(*first);
+            for (std::size_t j = i + 1; j < candidates.size(); ++j) {
+                RS_Entity *second = candidates[j];
+                if (firstBounded && !isUnbounded(*second) && !bordersOverlap(*first, *second)) {
+                    continue;
+                }
+                checkPair(first, second);
             }
-
+        }
+        return candidates.size();
+    };
+
+    if (range > 0. && range < RS_MAXDOUBLE) {
+        searchWindow(range);
+    } else if (getMin().valid && getMax().valid) {
+        // the window is widened until an intersection is found within it, or it covers the container. Entities
+        // are collected as for the range, so deferred entities of splines, hatches and inserts are not created
+        // the largest distance from the point to the borders of the container
+        const double reach = std::hypot(std::max(std::abs(coord.x - getMin().x), std::abs(coord.x - getMax().x)),
+                                        std::max(std::abs(coord.y - getMin().y), std::abs(coord.y - getMax().y)));
+        double windowRange = std::max(reach * intersectionWindowStart, RS_TOLERANCE);
+        while (true) {
+            const std::size_t count = searchWindow(std::min(windowRange, reach));
+            if (closestPoint.valid || windowRange >= reach || count > maxIntersectionCandidates) {
+                break;
+            }
+            windowRange *= 2.;
         }
     }
     if (dist && closestPoint.valid) {
@@ -1514,6 +1914,85 @@ RS_Vector RS_EntityContainer::getNearestIntersection(
     return closestPoint;
 }
 
+void RS_EntityContainer::addIntersectionCandidates(RS_Entity *entity, const RS_Vector &windowMin,
+                                                   const RS_Vector &windowMax,
+                                                   std::vector<RS_Entity *> &candidates,
+                                                   std::vector<std::unique_ptr<RS_Entity>> &copies) const {
+    if (!isUnbounded(*entity)
+        && (entity->getMax().x < windowMin.x || entity->getMin().x > windowMax.x
+            || entity->getMax().y < windowMin.y || entity->getMin().y > windowMax.y)) {
+        return;
+    }
+    if (entity->rtti() == RS2::EntityInsert && static_cast<RS_Insert *>(entity)->isInstanced()) {
+        // entities of the block are collected in the window mapped to the block, and transformed copies of them
+        // are intersected, so the insert keeps no entities
+        auto *insert = static_cast<RS_Insert *>(entity);
+        RS_Block *block = insert->getBlockForInsert();
+        if (block == nullptr || !insert->isVisible()) {
+            return;
+        }
+        const RS_Vector corners[] = {windowMin, {windowMax.x, windowMin.y}, windowMax, {windowMin.x, windowMax.y}};
+        for (int col = 0; col < insert->getCols(); ++col) {
+            for (int row = 0; row < insert->getRows(); ++row) {
+                RS_Vector blockMin = insert->mapToBlock(windowMin, col, row);
+                RS_Vector blockMax = blockMin;
+                for (const RS_Vector &corner: corners) {
+                    const RS_Vector blockCorner = insert->mapToBlock(corner, col, row);
+                    blockMin = RS_Vector::minimum(blockMin, blockCorner);
+                    blockMax = RS_Vector::maximum(blockMax, blockCorner);
+                }
+                std::vector<RS_Entity *> blockCandidates;
+                for (RS_Entity *sub: *block) {
+                    addIntersectionCandidates(sub, blockMin, blockMax, blockCandidates, copies);
+                }
+                for (RS_Entity *blockEntity: blockCandidates) {
+                    RS_Entity *copy = blockEntity->clone();
+                    copy->setFlag(RS2::FlagTemp);
+                    copy->setLayer(insert->getInstanceLayer(blockEntity, insert->getLayer()));
+                    copy->setParent(insert);
+                    insert->mapEntityToWorld(copy, col, row);
+                    copies.emplace_back(copy);
+                    candidates.push_back(copy);
+                }
+            }
+        }
+        return;
+    }
+    if (entity->rtti() == RS2::EntitySpline && static_cast<RS_Spline *>(entity)->hasDeferredEntities()) {
+        // the lines of splines are created on demand only, so the segments of the stroke polyline are intersected
+        auto *spline = static_cast<RS_Spline *>(entity);
+        if (!spline->isVisible() || spline->ignoredSnap()) {
+            return;
+        }
+        const std::vector<RS_Vector> &points = spline->getStrokePoints();
+        for (std::size_t i = 1; i < points.size(); ++i) {
+            const RS_Vector &start = points[i - 1];
+            const RS_Vector &end = points[i];
+            if (std::max(start.x, end.x) < windowMin.x || std::min(start.x, end.x) > windowMax.x
+                || std::max(start.y, end.y) < windowMin.y || std::min(start.y, end.y) > windowMax.y) {
+                continue;
+            }
+            auto *line = new RS_Line(spline, start, end);
+            line->setFlag(RS2::FlagTemp);
+            copies.emplace_back(line);
+            candidates.push_back(line);
+        }
+        return;
+    }
+    if (entity->isContainer()) {
+        auto *container = static_cast<RS_EntityContainer *>(entity);
+        // no intersections of texts, dimensions and hatches are snapped to
+        if (container->ignoredSnap()) {
+            return;
+        }
+        for (RS_Entity *sub: *container) {
+            addIntersectionCandidates(sub, windowMin, windowMax, candidates, copies);
+        }
+    } else if (entity->isVisible() && !entity->getParent()->ignoredSnap()) {
+        candidates.push_back(entity);
+    }
+}
+
 RS_Vector RS_EntityContainer::getNearestVirtualIntersection(
     const RS_Vector &coord,
     const double &angle,
@@ -1547,14 +2026,14 @@ RS_Vector RS_EntityContainer::getNearestVirtualIntersection(
 RS_Vector RS_EntityContainer::getNearestRef(
     const RS_Vector &coord,
     double *dist) const {
+    resolveDeferredEntities();
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    for (auto en: entities) {
-
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->isVisible()) {
             point = en->getNearestRef(coord, &curDist);
             if (point.valid && curDist < minDist) {
@@ -1565,6 +2044,21 @@ RS_Vector RS_EntityContainer::getNearestRef(
                 }
             }
         }
+    };
+
+    LC_EntityIndex *index = spatialIndex();
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (auto en: entities) {
+            checkEntity(en);
+        }
     }
 
     return closestPoint;
@@ -1581,6 +2075,7 @@ RS_Vector RS_EntityContainer::getNearestSelectedRef(
 RS_EntityContainer::RefInfo RS_EntityContainer::getNearestSelectedRefInfo(
     const RS_Vector &coord,
     double *dist) const {
+    resolveDeferredEntities();
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     double curDist;                 // currently measured distance
     RefInfo result;
@@ -1588,8 +2083,7 @@ RS_EntityContainer::RefInfo RS_EntityContainer::getNearestSelectedRefInfo(
     RS_Vector point;                // endpoint found
     RS_Entity *closestPointEntity = nullptr;
 
-    for (auto en: entities) { // fixme - sand - iteration of ver all entities
-
+    auto checkEntity = [&](RS_Entity *en) {
         if (en->isVisible() && en->isSelected() && !en->isParentSelected()) {
             point = en->getNearestSelectedRef(coord, &curDist);
             if (point.valid && curDist < minDist) {
@@ -1601,6 +2095,21 @@ RS_EntityContainer::RefInfo RS_EntityContainer::getNearestSelectedRefInfo(
                 }
             }
         }
+    };
+
+    LC_EntityIndex *index = spatialIndex();
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity *en, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(en);
+            return true;
+        });
+    } else {
+        for (auto en: entities) {
+            checkEntity(en);
+        }
     }
 
     result.ref = closestPoint;
@@ -1622,18 +2131,17 @@ double RS_EntityContainer::getDistanceToPoint(
     double minDist = RS_MAXDOUBLE;      // minimum measured distance
     double curDist;                     // currently measured distance
     RS_Entity *closestEntity = nullptr;    // closest entity found
+    RS_Entity *closestTopEntity = nullptr; // entity of this container, which contains the closest entity
     RS_Entity *subEntity = nullptr;
 
-    for (auto e: entities) {
+    LC_EntityIndex *index = spatialIndex();
+
+    auto checkEntity = [&](RS_Entity *e) {
         if (e->isVisible() && (e->getLayer() == nullptr || !e->getLayer()->isLocked())) {
-            RS_DEBUG->print("entity: getDistanceToPoint");
-            RS_DEBUG->print("entity: %d", e->rtti());
             // bug#426, need to ignore Images to find nearest intersections
-            if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) continue;
+            if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) return;
             curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
 
-            RS_DEBUG->print("entity: getDistanceToPoint: OK");
-
             /*
              * By using '<=', we will prefer the *last* item in the container if there are multiple
              * entities that are *exactly* the same distance away, which should tend to be the one
@@ -1642,8 +2150,13 @@ double RS_EntityContainer::getDistanceToPoint(
              * drawn directly over top of another, and it's reasonable to assume that humans will
              * tend to want to reference entities that they see or have recently drawn as opposed
              * to deeper more forgotten and invisible ones...
+             * With the spatial index, entities are not visited in the list order, so the list
+             * position decides for equal distances.
              */
-            if (curDist <= minDist) {
+            bool closer = curDist < minDist
+                          || (curDist == minDist && (index == nullptr || closestTopEntity == nullptr
+                                                     || index->precedes(closestTopEntity, e)));
+            if (closer) {
                 switch (level) {
                     case RS2::ResolveAll:
                     case RS2::ResolveAllButTextImage:
@@ -1652,9 +2165,24 @@ double RS_EntityContainer::getDistanceToPoint(
                     default:
                         closestEntity = e;
                 }
+                closestTopEntity = e;
                 minDist = curDist;
             }
         }
+    };
+
+    if (index != nullptr) {
+        index->visitNearest(coord, [&](RS_Entity *e, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            checkEntity(e);
+            return true;
+        });
+    } else {
+        for (auto e: entities) {
+            checkEntity(e);
+        }
     }
 
     if (entity) {
@@ -1743,44 +2271,81 @@ bool RS_EntityContainer::optimizeContours() {
     //    std::cout<<"RS_EntityContainer::optimizeContours: 1"<<std::endl;
 
     /** remove unsupported entities */
-    for (RS_Entity *it: enList)
-        removeEntity(it);
+    removeEntities(std::vector<RS_Entity *>(enList.cbegin(), enList.cend()));
 
     /** check and form a closed contour **/
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 2"<<std::endl;
+    // connected edges are found by an end point graph, so each step doesn't search all remaining edges
+    const std::vector<RS_Entity *> edges(entities.cbegin(), entities.cend());
+    std::unordered_set<RS_Entity *> remaining{edges.cbegin(), edges.cend()};
+    LC_EndpointGraph graph{endpointGraphCellSize};
+    for (RS_Entity *e: edges) {
+        graph.insert(e);
+    }
+    std::vector<RS_Entity *> consumed;
+    consumed.reserve(edges.size());
+    auto take = [&](RS_Entity *e) {
+        graph.remove(e);
+        remaining.erase(e);
+        consumed.push_back(e);
+    };
+    // the first remaining edge in the order of the entity list
+    std::size_t firstIndex = 0;
+    auto firstRemaining = [&]() -> RS_Entity * {
+        while (firstIndex < edges.size() && remaining.count(edges[firstIndex]) == 0) {
+            ++firstIndex;
+        }
+        return firstIndex < edges.size() ? edges[firstIndex] : nullptr;
+    };
+
     /** the first entity **/
     RS_Entity *current(nullptr);
-    if (count() > 0) {
-        current = entityAt(0)->clone();
+    if (!edges.empty()) {
+        current = edges.front()->clone();
         tmp.addEntity(current);
-        removeEntity(entityAt(0));
+        take(edges.front());
     } else {
         if (tmp.count() == 0) return false;
     }
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 3"<<std::endl;
     RS_Vector vpStart;
     RS_Vector vpEnd;
     if (current) {
         vpStart = current->getStartpoint();
         vpEnd = current->getEndpoint();
     }
-    RS_Entity *next = nullptr;
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 4"<<std::endl;
     /** connect entities **/
     const auto errMsg = QObject::tr("Hatch failed due to a gap=%1 between (%2, %3) and (%4, %5)");
 
-    while (count() > 0) {
-        double dist = 0.;
-        RS_Vector vpTmp = getNearestEndpoint(vpEnd, &dist, &next);
-        if (dist > contourTolerance) {
+    while (!remaining.empty()) {
+        // the connected edge with the closest end point
+        RS_Entity *next = nullptr;
+        double dist = RS_MAXDOUBLE;
+        for (RS_Entity *e: graph.getConnected(vpEnd, contourTolerance)) {
+            const double curDist = endPointDistance(vpEnd, *e);
+            if (curDist < dist) {
+                dist = curDist;
+                next = e;
+            }
+        }
+        if (next == nullptr) {
             if (vpEnd.squaredTo(vpStart) < contourTolerance) {
-                RS_Entity *e2 = entityAt(0);
+                RS_Entity *e2 = firstRemaining();
                 tmp.addEntity(e2->clone());
                 vpStart = e2->getStartpoint();
                 vpEnd = e2->getEndpoint();
-                removeEntity(e2);
+                take(e2);
                 continue;
             } else {
+                // report the gap to the closest end point
+                RS_Vector vpTmp(false);
+                for (RS_Entity *e: edges) {
+                    double curDist = RS_MAXDOUBLE;
+                    RS_Vector point = (remaining.count(e) == 1) ? e->getNearestEndpoint(vpEnd, &curDist)
+                                                                : RS_Vector(false);
+                    if (point.valid && curDist < dist) {
+                        dist = curDist;
+                        vpTmp = point;
+                    }
+                }
                 QG_DIALOGFACTORY->commandMessage(
                     errMsg.arg(dist).arg(vpTmp.x).arg(vpTmp.y).arg(vpEnd.x).arg(vpEnd.y)
                 );
@@ -1789,31 +2354,15 @@ bool RS_EntityContainer::optimizeContours() {
                 break;
             }
         }
-        if (!next) {      //workaround if next is nullptr
-            //      	    std::cout<<"RS_EntityContainer::optimizeContours: next is nullptr" <<std::endl;
-            RS_DEBUG->print("RS_EntityContainer::optimizeContours: next is nullptr");
-            //			closed=false;	//workaround if next is nullptr
-            break;   //workaround if next is nullptr
-        }      //workaround if next is nullptr
-        if (closed) {
-            next->setProcessed(true);
-            RS_Entity *eTmp = next->clone();
-            if (vpEnd.squaredTo(eTmp->getStartpoint()) > vpEnd.squaredTo(eTmp->getEndpoint()))
-                eTmp->revertDirection();
-            vpEnd = eTmp->getEndpoint();
-            tmp.addEntity(eTmp);
-            removeEntity(next);
-        }
+        next->setProcessed(true);
+        RS_Entity *eTmp = next->clone();
+        if (vpEnd.squaredTo(eTmp->getStartpoint()) > vpEnd.squaredTo(eTmp->getEndpoint()))
+            eTmp->revertDirection();
+        vpEnd = eTmp->getEndpoint();
+        tmp.addEntity(eTmp);
+        take(next);
     }
-    //    DEBUG_HEADER
-    //    if(vpEnd.valid && vpEnd.squaredTo(vpStart) > 1e-8) {
-    //		QG_DIALOGFACTORY->commandMessage(errMsg.arg(vpEnd.distanceTo(vpStart))
-    //											 .arg(vpStart.x).arg(vpStart.y).arg(vpEnd.x).arg(vpEnd.y));
-    //        RS_DEBUG->print("RS_EntityContainer::optimizeContours: hatch failed due to a gap");
-    //        closed=false;
-    //    }
-    //    std::cout<<"RS_EntityContainer::optimizeContours: 5"<<std::endl;
-
+    removeEntities(consumed);
 
     // add new sorted entities:
     for (auto en: tmp) {
@@ -1843,6 +2392,8 @@ bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector &v1, const RS_
 }
 
 void RS_EntityContainer::move(const RS_Vector &offset) {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     moveBorders(offset);
     for (auto *e: entities) {
         e->move(offset);
@@ -1857,6 +2408,8 @@ void RS_EntityContainer::rotate(const RS_Vector &center, double angle) {
 }
 
 void RS_EntityContainer::rotate(const RS_Vector &center, const RS_Vector &angleVector) {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     resetBorders();
 
     for (auto *e: entities) {
@@ -1868,6 +2421,8 @@ void RS_EntityContainer::rotate(const RS_Vector &center, const RS_Vector &angleV
 }
 
 void RS_EntityContainer::scale(const RS_Vector &center, const RS_Vector &factor) {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     if (std::abs(factor.x) > RS_TOLERANCE && std::abs(factor.y) > RS_TOLERANCE) {
         scaleBorders(center, factor);
         for (auto *e: entities) {
@@ -1880,6 +2435,8 @@ void RS_EntityContainer::scale(const RS_Vector &center, const RS_Vector &factor)
 }
 
 void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &axisPoint2) {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     if (axisPoint1.distanceTo(axisPoint2) > RS_TOLERANCE) {
 
         resetBorders();
@@ -1891,6 +2448,8 @@ void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &ax
 }
 
 RS_Entity &RS_EntityContainer::shear(double k) {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     for (auto *e: *this)
         e->shear(k);
     calculateBorders();
@@ -1903,6 +2462,8 @@ void RS_EntityContainer::stretch(
     const RS_Vector &secondCorner,
     const RS_Vector &offset) {
 
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     if (getMin().isInWindow(firstCorner, secondCorner) &&
         getMax().isInWindow(firstCorner, secondCorner)) {
 
@@ -1923,6 +2484,8 @@ void RS_EntityContainer::moveRef(
     const RS_Vector &ref,
     const RS_Vector &offset) {
 
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     resetBorders();
     for (auto *e: entities) {
         e->moveRef(ref, offset);
@@ -1937,6 +2500,8 @@ void RS_EntityContainer::moveSelectedRef(
     const RS_Vector &ref,
     const RS_Vector &offset) {
 
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     resetBorders();
     for (auto *e: entities) {
         e->moveSelectedRef(ref, offset);
@@ -1948,6 +2513,8 @@ void RS_EntityContainer::moveSelectedRef(
 }
 
 void RS_EntityContainer::revertDirection() {
+    m_spatialIndex.reset();
+    m_endpointGraph.reset();
     // revert entity order in the container
     for (int k = 0; k < entities.size() / 2; ++k) {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
@@ -2069,26 +2636,32 @@ bool RS_EntityContainer::ignoredSnap() const
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::begin() const{
+    resolveDeferredEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::end() const{
+    resolveDeferredEntities();
     return entities.end();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::cbegin() const{
+    resolveDeferredEntities();
     return entities.cbegin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::cend() const{
+    resolveDeferredEntities();
     return entities.cend();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::begin(){
+    resolveDeferredEntities();
     return entities.begin();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::end() {
+    resolveDeferredEntities();
     return entities.end();
 }
 
@@ -2107,7 +2680,7 @@ std::ostream &operator<<(std::ostream &os, RS_EntityContainer &ec) {
 
     os << tab << "EntityContainer[" << id << "]: \n";
     os << tab << "Borders[" << id << "]: "
-       << ec.minV << " - " << ec.maxV << "\n";
+       << ec.getMin() << " - " << ec.getMax() << "\n";
     //os << tab << "Unit[" << id << "]: "
     //<< RS_Units::unit2string (ec.unit) << "\n";
     if (ec.getLayer()) {
@@ -2149,14 +2722,17 @@ std::ostream &operator<<(std::ostream &os, RS_EntityContainer &ec) {
 }
 
 RS_Entity *RS_EntityContainer::first() const {
+    resolveDeferredEntities();
     return entities.first();
 }
 
 RS_Entity *RS_EntityContainer::last() const {
+    resolveDeferredEntities();
     return entities.last();
 }
 
 const QList<RS_Entity *> &RS_EntityContainer::getEntityList() {
+    resolveDeferredEntities();
     return entities;
 }
 
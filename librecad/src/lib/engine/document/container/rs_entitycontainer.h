@@ -33,6 +33,10 @@
 #include <QList>
 #include "rs_entity.h"
 
+class LC_EndpointGraph;
+class LC_EntityIndex;
+class LC_IntersectionCache;
+
 /**
  * Class representing a tree of entities.
  * Typical entity containers are graphics, polylines, groups, texts, ...)
@@ -55,7 +59,11 @@ public:
     };
 
     RS_EntityContainer(RS_EntityContainer* parent=nullptr, bool owner=true);
-    //RS_EntityContainer(const RS_EntityContainer& ec);
+    /**
+     * Shallow copy. The spatial index is not shared, but rebuilt on demand.
+     */
+    RS_EntityContainer(const RS_EntityContainer& other);
+    RS_EntityContainer& operator = (const RS_EntityContainer& other);
 
     ~RS_EntityContainer() override;
 
@@ -106,6 +114,15 @@ public:
     virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    /**
+     * @brief insertEntities inserts entities at the given index, keeping their order
+     */
+    void insertEntities(int index, const std::vector<RS_Entity*>& toInsert);
+    /**
+     * @brief removeEntities removes all given entities in one pass, borders are recalculated once
+     * @return number of removed entities
+     */
+    unsigned removeEntities(const std::vector<RS_Entity*>& toRemove);
 
 //!
 //! \brief addRectangle add four lines to form a rectangle by
@@ -152,6 +169,37 @@ public:
     virtual void adjustBorders(RS_Entity* entity);
     void calculateBorders() override;
     void forcedCalculateBorders();
+    /**
+     * @brief updateEntityIndex notify the container that the geometry of a direct child entity was
+     * changed in place, so the spatial index and the end point graph need to re-index the entity
+     */
+    void updateEntityIndex(RS_Entity* entity);
+    /**
+     * @brief invalidateSpatialIndex drop the spatial index and the end point graph, they're rebuilt on the next
+     * query, e.g. before the entities are updated concurrently
+     */
+    void invalidateSpatialIndex();
+    /**
+     * @brief getEndpointGraph the start and end points of the entities, to walk chains of connected entities;
+     * built on the first call and kept in sync with the entity list
+     */
+    LC_EndpointGraph* getEndpointGraph() const;
+    /**
+     * @brief updateEntitySelection notify the container that a direct child entity was selected or deselected
+     */
+    void updateEntitySelection(RS_Entity* entity, bool selected);
+    /**
+     * @brief getEntitiesInWindow collect entities, which may be visible within the window, in the drawing order
+     * @return false, if the container is not indexed, and all entities must be checked by the caller
+     */
+    bool getEntitiesInWindow(const RS_Vector& corner1, const RS_Vector& corner2, std::vector<RS_Entity*>& result) const;
+    /**
+     * @brief getSelectedEntitiesInWindow collect selected entities, which may be visible within the window,
+     *        in the drawing order
+     * @return false, if the container is not indexed, and all entities must be checked by the caller
+     */
+    bool getSelectedEntitiesInWindow(const RS_Vector& corner1, const RS_Vector& corner2,
+                                     std::vector<RS_Entity*>& result) const;
     void updateDimensions( bool autoText=true);
     virtual void updateInserts();
     virtual void updateSplines();
@@ -182,8 +230,17 @@ public:
     RS_Vector getNearestDist(double distance,
                              const RS_Vector& coord,
                              double* dist = nullptr) const override;
+    /**
+     * @brief getNearestIntersection the intersection closest to the point
+     * @param range - if positive, only intersections within this distance are searched, between entities with
+     *                borders in the range; otherwise, the range is widened step by step from a small part of the
+     *                container size, until an intersection is found or too many entities are in the range
+     * @param cache - intersections kept between calls, may be nullptr
+     */
     RS_Vector getNearestIntersection(const RS_Vector& coord,
-                                     double* dist = nullptr);
+                                     double* dist = nullptr,
+                                     double range = 0.,
+                                     LC_IntersectionCache* cache = nullptr);
     RS_Vector getNearestVirtualIntersection(const RS_Vector& coord,
                                             const double& angle,
                                             double* dist);
@@ -223,6 +280,8 @@ public:
     friend std::ostream& operator << (std::ostream& os, RS_EntityContainer& ec);
 
     bool isOwner() const {return autoDelete;}
+    //! whether the entities are not created yet, see createDeferredEntities()
+    bool hasDeferredEntities() const {return entitiesDeferred;}
     void setOwner(bool owner) {autoDelete=owner;}
     /**
      * @brief areaLineIntegral, line integral for contour area calculation by Green's Theorem
@@ -261,7 +320,10 @@ public:
 
     const QList<RS_Entity*>& getEntityList();
 
-    inline RS_Entity* unsafeEntityAt(int index) const {return entities.at(index);}
+    inline RS_Entity* unsafeEntityAt(int index) const {
+        resolveDeferredEntities();
+        return entities.at(index);
+    }
 
     void drawAsChild(RS_Painter *painter) override;
 
@@ -276,9 +338,25 @@ protected:
      */
     virtual std::vector<std::unique_ptr<RS_EntityContainer>> getLoops() const;
 
+    /**
+     * @brief createDeferredEntities create the entities of a container, which deferred creating them
+     * until the entity list is accessed. The implementation must reset entitiesDeferred.
+     */
+    virtual void createDeferredEntities() {}
+    void resolveDeferredEntities() const {
+        if (entitiesDeferred) {
+            const_cast<RS_EntityContainer*>(this)->createDeferredEntities();
+        }
+    }
+
     /** entities in the container */
     QList<RS_Entity *> entities;
 
+    /**
+     * The entity list is not created yet, it's created on the first access by createDeferredEntities()
+     */
+    bool entitiesDeferred = false;
+
     /** sub container used only temporarily for iteration. */
     mutable RS_EntityContainer* subContainer = nullptr;
 
@@ -288,7 +366,27 @@ protected:
      */
     bool autoUpdateBorders = true;
 
+    /**
+     * @brief spatialIndex the R-tree of the entities used by nearest queries
+     * @return nullptr, if the container is too small to benefit from the index
+     */
+    LC_EntityIndex* spatialIndex() const;
+    /**
+     * @brief updateParentIndex borders of this container changed, so the parent needs to re-index this container,
+     * see updateEntityIndex()
+     */
+    void updateParentIndex();
+
 private:
+    /**
+     * @brief addIntersectionCandidates collects snapped entities, which may intersect the window, descending
+     *        into sub-containers. Entities of instanced inserts and segments of splines, which are not created
+     *        yet, are collected as temporary copies
+     * @param copies - owns the temporary copies
+     */
+    void addIntersectionCandidates(RS_Entity* entity, const RS_Vector& windowMin, const RS_Vector& windowMax,
+                                   std::vector<RS_Entity*>& candidates,
+                                   std::vector<std::unique_ptr<RS_Entity>>& copies) const;
 /**
  * @brief ignoredSnap whether snapping is ignored
  * @return true when entity of this container won't be considered for snapping points
@@ -296,6 +394,10 @@ private:
     bool ignoredSnap() const;
     mutable int entIdx = 0;
     bool autoDelete = false;
+    /** lazily built spatial index of the entities in the container */
+    mutable std::unique_ptr<LC_EntityIndex> m_spatialIndex;
+    /** lazily built end point graph of the entities in the container */
+    mutable std::unique_ptr<LC_EndpointGraph> m_endpointGraph;
 
 
 };
@@ -0,0 +1,245 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "lc_hatchlines.h"
+#include "lc_rect.h"
+#include "rs_debug.h"
+#include "rs_line.h"
+#include "rs_painter.h"
+
+namespace {
+
+double segmentLength(const LC_HatchScanline::Segment& s)
+{
+    return std::hypot(s.x2 - s.x1, s.y2 - s.y1);
+}
+
+double distanceToSegment(const LC_HatchScanline::Segment& s, const RS_Vector& coord)
+{
+    const double dx = s.x2 - s.x1;
+    const double dy = s.y2 - s.y1;
+    const double length2 = dx * dx + dy * dy;
+    double t = 0.;
+    if (length2 > 0.) {
+        t = std::clamp(((coord.x - s.x1) * dx + (coord.y - s.y1) * dy) / length2, 0., 1.);
+    }
+    return std::hypot(s.x1 + t * dx - coord.x, s.y1 + t * dy - coord.y);
+}
+}
+
+LC_HatchLines::LC_HatchLines(RS_EntityContainer* parent, std::vector<LC_HatchScanline::Segment> segments):
+    RS_EntityContainer(parent)
+  , m_segments{std::move(segments)}
+{
+    entitiesDeferred = true;
+    calculateBorders();
+}
+
+RS_Entity* LC_HatchLines::clone() const
+{
+    auto* lines = new LC_HatchLines(*this);
+    lines->setOwner(isOwner());
+    lines->initId();
+    lines->detach();
+    return lines;
+}
+
+/**
+ * Creates the line entities of the segments, for users of the entity list.
+ */
+void LC_HatchLines::createDeferredEntities()
+{
+    entitiesDeferred = false;
+    RS_DEBUG->print("LC_HatchLines::createDeferredEntities: %zu lines", m_segments.size());
+    const RS_Pen pen = getPen(false);
+    RS_Layer* layer = getLayer(false);
+    for (const LC_HatchScanline::Segment& s: m_segments) {
+        auto* line = new RS_Line(this, RS_Vector{s.x1, s.y1}, RS_Vector{s.x2, s.y2});
+        line->setPen(pen);
+        line->setLayer(layer);
+        line->setFlag(RS2::FlagHatchChild);
+        appendEntity(line);
+    }
+    m_segments.clear();
+    m_segments.shrink_to_fit();
+    calculateBorders();
+}
+
+unsigned LC_HatchLines::count() const
+{
+    return isCompact() ? static_cast<unsigned>(m_segments.size()) : RS_EntityContainer::count();
+}
+
+unsigned LC_HatchLines::countDeep() const
+{
+    return count();
+}
+
+double LC_HatchLines::getLength() const
+{
+    if (!isCompact()) {
+        return RS_EntityContainer::getLength();
+    }
+    double length = 0.;
+    for (const LC_HatchScanline::Segment& s: m_segments) {
+        length += segmentLength(s);
+    }
+    return length;
+}
+
+void LC_HatchLines::calculateBorders()
+{
+    if (!isCompact()) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    for (const LC_HatchScanline::Segment& s: m_segments) {
+        minV = RS_Vector::minimum(minV, {std::min(s.x1, s.x2), std::min(s.y1, s.y2)});
+        maxV = RS_Vector::maximum(maxV, {std::max(s.x1, s.x2), std::max(s.y1, s.y2)});
+    }
+    if (m_segments.empty()) {
+        minV = maxV = RS_Vector{0., 0.};
+    }
+    updateParentIndex();
+}
+
+double LC_HatchLines::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                         RS2::ResolveLevel level, double solidDist) const
+{
+    if (!isCompact()) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+
+    double minDist = RS_MAXDOUBLE;
+    const LC_HatchScanline::Segment* nearest = nullptr;
+    if (isVisible()) {
+        for (const LC_HatchScanline::Segment& s: m_segments) {
+            const double d = distanceToSegment(s, coord);
+            if (d < minDist) {
+                minDist = d;
+                nearest = &s;
+            }
+        }
+    }
+    if (entity != nullptr) {
+        if (nearest == nullptr) {
+            *entity = nullptr;
+        } else if (level == RS2::ResolveAll || level == RS2::ResolveAllButTextImage) {
+            // the caller needs the individual line; it gets a temporary line of the segment, as creating the
+            // lines of all segments is what the compact storage avoids
+            m_nearestSegment.setParent(const_cast<LC_HatchLines*>(this));
+            m_nearestSegment.setPen(getPen(false));
+            m_nearestSegment.setLayer(getLayer(false));
+            m_nearestSegment.setFlag(RS2::FlagHatchChild);
+            m_nearestSegment.setFlag(RS2::FlagTemp);
+            m_nearestSegment.setStartpoint({nearest->x1, nearest->y1});
+            m_nearestSegment.setEndpoint({nearest->x2, nearest->y2});
+            *entity = &m_nearestSegment;
+        } else {
+            *entity = const_cast<LC_HatchLines*>(this);
+        }
+    }
+    return minDist;
+}
+
+template <typename Transform>
+bool LC_HatchLines::transformSegments(Transform transform)
+{
+    if (!isCompact()) {
+        return false;
+    }
+    for (LC_HatchScanline::Segment& s: m_segments) {
+        const RS_Vector p1 = transform(RS_Vector{s.x1, s.y1});
+        const RS_Vector p2 = transform(RS_Vector{s.x2, s.y2});
+        s = {p1.x, p1.y, p2.x, p2.y};
+    }
+    calculateBorders();
+    return true;
+}
+
+void LC_HatchLines::move(const RS_Vector& offset)
+{
+    if (!transformSegments([&offset](RS_Vector p) { return p.move(offset); })) {
+        RS_EntityContainer::move(offset);
+    }
+}
+
+void LC_HatchLines::rotate(const RS_Vector& center, double angle)
+{
+    rotate(center, RS_Vector{angle});
+}
+
+void LC_HatchLines::rotate(const RS_Vector& center, const RS_Vector& angleVector)
+{
+    if (!transformSegments([&center, &angleVector](RS_Vector p) { return p.rotate(center, angleVector); })) {
+        RS_EntityContainer::rotate(center, angleVector);
+    }
+}
+
+void LC_HatchLines::scale(const RS_Vector& center, const RS_Vector& factor)
+{
+    if (!transformSegments([&center, &factor](RS_Vector p) { return p.scale(center, factor); })) {
+        RS_EntityContainer::scale(center, factor);
+    }
+}
+
+void LC_HatchLines::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
+{
+    if (!transformSegments([&axisPoint1, &axisPoint2](RS_Vector p) { return p.mirror(axisPoint1, axisPoint2); })) {
+        RS_EntityContainer::mirror(axisPoint1, axisPoint2);
+    }
+}
+
+void LC_HatchLines::stretch(const RS_Vector& firstCorner, const RS_Vector& secondCorner, const RS_Vector& offset)
+{
+    // segments are stretched by their end points, as lines are
+    resolveDeferredEntities();
+    RS_EntityContainer::stretch(firstCorner, secondCorner, offset);
+}
+
+/**
+ * Draws the segments as lines, skipping segments outside of the painted area.
+ */
+void LC_HatchLines::draw(RS_Painter* painter)
+{
+    if (!isCompact()) {
+        RS_EntityContainer::draw(painter);
+        return;
+    }
+    const LC_Rect& rect = painter->getWcsBoundingRect();
+    const RS_Vector& rectMin = rect.minP();
+    const RS_Vector& rectMax = rect.maxP();
+    for (const LC_HatchScanline::Segment& s: m_segments) {
+        if (std::max(s.x1, s.x2) < rectMin.x || std::min(s.x1, s.x2) > rectMax.x
+            || std::max(s.y1, s.y2) < rectMin.y || std::min(s.y1, s.y2) > rectMax.y) {
+            continue;
+        }
+        painter->updateDashOffset(segmentLength(s));
+        painter->drawLineWCS({s.x1, s.y1}, {s.x2, s.y2});
+    }
+}
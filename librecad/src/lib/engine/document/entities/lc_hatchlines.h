@@ -0,0 +1,86 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_HATCHLINES_H
+#define LC_HATCHLINES_H
+
+#include <vector>
+
+#include "lc_hatchscanline.h"
+#include "rs_entitycontainer.h"
+#include "rs_line.h"
+
+/**
+ * @brief The LC_HatchLines class, the pattern lines of a hatch, stored as an array of segments.
+ *
+ * The segments are drawn directly, and distances are measured to them, without creating line entities.
+ * Line entities are created on the first access to the entity list only, e.g. for exploding the hatch.
+ */
+class LC_HatchLines : public RS_EntityContainer {
+public:
+    LC_HatchLines(RS_EntityContainer* parent, std::vector<LC_HatchScanline::Segment> segments);
+
+    RS_Entity* clone() const override;
+
+    /** @return true, if the line entities are not created yet */
+    bool isCompact() const {
+        return entitiesDeferred;
+    }
+
+    unsigned count() const override;
+    unsigned countDeep() const override;
+    double getLength() const override;
+    void calculateBorders() override;
+
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+
+    void move(const RS_Vector& offset) override;
+    void rotate(const RS_Vector& center, double angle) override;
+    void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
+    void scale(const RS_Vector& center, const RS_Vector& factor) override;
+    void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
+    void stretch(const RS_Vector& firstCorner,
+                 const RS_Vector& secondCorner,
+                 const RS_Vector& offset) override;
+
+    void draw(RS_Painter* painter) override;
+
+protected:
+    void createDeferredEntities() override;
+
+private:
+    /**
+     * @brief transform applies a point transformation to the segments, or to the line entities once created
+     */
+    template <typename Transform>
+    bool transformSegments(Transform transform);
+
+    std::vector<LC_HatchScanline::Segment> m_segments;
+    /** segment nearest to the last resolved distance query, while the line entities are not created */
+    mutable RS_Line m_nearestSegment;
+};
+
+#endif // LC_HATCHLINES_H
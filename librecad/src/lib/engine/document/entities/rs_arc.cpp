@@ -33,6 +33,7 @@
 #include "rs_math.h"
 #include "rs_graphicview.h"
 #include "rs_painter.h"
+#include "lc_objectpool.h"
 #include "lc_quadratic.h"
 #include "rs_debug.h"
 #include "lc_rect.h"
@@ -90,6 +91,24 @@ RS_Entity* RS_Arc::clone() const {
 	return a;
 }
 
+namespace {
+LC_ObjectPool& arcPool()
+{
+    static auto* pool = new LC_ObjectPool{sizeof(RS_Arc), "RS_Arc"};
+    return *pool;
+}
+}
+
+void* RS_Arc::operator new(std::size_t size)
+{
+    return arcPool().allocate(size);
+}
+
+void RS_Arc::operator delete(void* entity, std::size_t size)
+{
+    arcPool().deallocate(entity, size);
+}
+
 /**
  * Creates this arc from 3 given points which define the arc line.
  *
@@ -27,6 +27,7 @@
 #ifndef RS_ARC_H
 #define RS_ARC_H
 
+#include <cstddef>
 #include <iosfwd>
 #include <vector>
 
@@ -79,6 +80,10 @@ public:
 
     RS_Entity* clone() const override;
 
+    /** Allocated from a pool, see LC_ObjectPool */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* entity, std::size_t size);
+
     /**	@return RS2::EntityArc */
     RS2::EntityType rtti() const override
     {
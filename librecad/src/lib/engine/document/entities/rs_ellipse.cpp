@@ -481,7 +481,7 @@ RS_Vector RS_Ellipse::getNearestDist(double distance,
 
     if(getRatio()<RS_TOLERANCE) {
         //treat the ellipse as a line
-        RS_Line line{e.minV,e.maxV};
+        RS_Line line{e.getMin(),e.getMax()};
         return line.getNearestDist(distance, coord, dist);
     }
     double x1=e.getAngle1();
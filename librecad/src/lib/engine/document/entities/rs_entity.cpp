@@ -26,6 +26,7 @@
 **********************************************************************/
 
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <utility>
@@ -38,6 +39,7 @@
 #include "rs_circle.h"
 #include "rs_ellipse.h"
 #include "rs_entity.h"
+#include "rs_entitycontainer.h"
 #include "rs_graphic.h"
 #include "rs_information.h"
 #include "rs_insert.h"
@@ -49,6 +51,7 @@
 #include "rs_polyline.h"
 #include "rs_text.h"
 #include "rs_vector.h"
+#include "lc_objectpool.h"
 #include "lc_quadratic.h"
 
 namespace {
@@ -62,9 +65,47 @@ bool isHatchMember(const RS_Entity* entity) {
 }
 
 struct RS_Entity::Impl {
+    Impl() = default;
+
+    Impl(const Impl& other):
+        pen{other.pen}
+    {
+        if (other.varList != nullptr) {
+            varList = std::make_unique<std::map<QString, QString>>(*other.varList);
+        }
+    }
+
+    Impl& operator = (const Impl& other)
+    {
+        if (this != &other) {
+            pen = other.pen;
+            varList = other.varList != nullptr ? std::make_unique<std::map<QString, QString>>(*other.varList)
+                                               : nullptr;
+        }
+        return *this;
+    }
+
+    // pooled, as every entity allocates one
+    static void* operator new(std::size_t size)
+    {
+        return implPool().allocate(size);
+    }
+
+    static void operator delete(void* impl, std::size_t size)
+    {
+        implPool().deallocate(impl, size);
+    }
+
+    static LC_ObjectPool& implPool()
+    {
+        static auto* pool = new LC_ObjectPool{sizeof(Impl), "RS_Entity::Impl"};
+        return *pool;
+    }
+
     //! pen (attributes) for this entity
     RS_Pen pen{};
-    std::map<QString, QString> varList;
+    //! user defined variables, allocated with the first one, as hardly any entity has them
+    std::unique_ptr<std::map<QString, QString>> varList;
 };
 
 /**
@@ -142,7 +183,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique id.
  */
 void RS_Entity::initId() {
-    static unsigned long long idCounter=0;
+    // entities are created by concurrent updates, e.g. of texts after import
+    static std::atomic<unsigned long long> idCounter{0};
     id = idCounter++;
 }
 
@@ -164,13 +206,13 @@ void RS_Entity::resetBorders() {
 
 
 void RS_Entity::moveBorders(const RS_Vector& offset){
-    minV.move(offset);
-    maxV.move(offset);
+    minV = getMin().move(offset);
+    maxV = getMax().move(offset);
 }
 
 void RS_Entity::scaleBorders(const RS_Vector& center, const RS_Vector& factor){
-    minV.scale(center,factor);
-    maxV.scale(center,factor);
+    minV = getMin().scale(center,factor);
+    maxV = getMax().scale(center,factor);
 }
 
 /**
@@ -189,6 +231,10 @@ bool RS_Entity::setSelected(bool select) {
     } else {
         delFlag(RS2::FlagSelected);
     }
+    // keep the selection set of the parent container up to date
+    if (parent != nullptr) {
+        parent->updateEntitySelection(this, select);
+    }
 
     return true;
 }
@@ -464,7 +510,7 @@ bool RS_Entity::isHighlighted() const{
 }
 
 RS_Vector RS_Entity::getSize() const {
-	return maxV-minV;
+	return getMax() - getMin();
 }
 
 /**
@@ -939,8 +985,10 @@ void RS_Entity::stretch(const RS_Vector& firstCorner,
  * @return User defined variable connected to this entity or nullptr if not found.
  */
 QString RS_Entity::getUserDefVar(const QString& key) const {
-    auto it=m_pImpl->varList.find(key);
-    return (it == m_pImpl->varList.end()) ? QString{} : it->second;
+    if (m_pImpl->varList == nullptr)
+        return {};
+    auto it=m_pImpl->varList->find(key);
+    return (it == m_pImpl->varList->end()) ? QString{} : it->second;
 }
 
 /*
@@ -960,14 +1008,20 @@ RS_Vector RS_Entity::getNearestOrthTan(const RS_Vector& /*coord*/,
  * Add a user defined variable to this entity.
  */
 void RS_Entity::setUserDefVar(QString key, QString val) {
-    m_pImpl->varList.emplace(key, val);
+    if (m_pImpl->varList == nullptr)
+        m_pImpl->varList = std::make_unique<std::map<QString, QString>>();
+    m_pImpl->varList->emplace(key, val);
 }
 
 /**
  * Deletes the given user defined variable.
  */
 void RS_Entity::delUserDefVar(QString key) {
-    m_pImpl->varList.erase(key);
+    if (m_pImpl->varList == nullptr)
+        return;
+    m_pImpl->varList->erase(key);
+    if (m_pImpl->varList->empty())
+        m_pImpl->varList.reset();
 }
 
 /**
@@ -975,7 +1029,9 @@ void RS_Entity::delUserDefVar(QString key) {
  */
 std::vector<QString> RS_Entity::getAllKeys() const{
     std::vector<QString> ret(0);
-    for(auto const& [key, val]: m_pImpl->varList){
+    if (m_pImpl->varList == nullptr)
+        return ret;
+    for(auto const& [key, val]: *m_pImpl->varList){
         ret.push_back(key);
     }
     return ret;
@@ -1065,9 +1121,9 @@ std::ostream& operator << (std::ostream& os, RS_Entity& e) {
     os << e.m_pImpl->pen << "\n";
 
     os << "variable list:\n";
-    for(auto const& v: e.m_pImpl->varList){
-        os << v.first.toLatin1().data()<< ": "
-           << v.second.toLatin1().data()
+    for(auto const& key: e.getAllKeys()){
+        os << key.toLatin1().data()<< ": "
+           << e.getUserDefVar(key).toLatin1().data()
            << ", ";
     }
 
@@ -32,6 +32,7 @@
 #include <iosfwd>
 #include <memory>
 
+#include "lc_compactvector.h"
 #include "lc_drawable.h"
 #include "rs_undoable.h"
 #include "rs_vector.h"
@@ -602,10 +603,10 @@ m0 x + m1 y + m2 =0
 protected:
 //! Entity's parent entity or nullptr is this entity has no parent.
     RS_EntityContainer *parent = nullptr;
-    //! minimum coordinates
-    RS_Vector minV;
-    //! maximum coordinates
-    RS_Vector maxV;
+    //! minimum coordinates, 2D only
+    LC_CompactVector minV;
+    //! maximum coordinates, 2D only
+    LC_CompactVector maxV;
     //! Pointer to layer
     RS_Layer *layer = nullptr;
     //! Entity id
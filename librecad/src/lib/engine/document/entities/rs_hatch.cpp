@@ -26,13 +26,16 @@
 #include <cmath>
 #include <iostream>
 #include <memory>
-#include <set>
+#include <utility>
+#include <vector>
 
 #include <QPainterPath>
 #include <QBrush>
 #include <QString>
 
+#include "lc_hatchlines.h"
 #include "lc_looputils.h"
+#include "lc_trace.h"
 
 #include "rs_arc.h"
 #include "rs_circle.h"
@@ -49,6 +52,9 @@
 
 
 namespace{
+// maximum number of segments of a hatch filled by scanlines, to avoid huge memory consumption
+    constexpr std::size_t maxHatchSegments = 5000000;
+
 // angular distance corrected for direction and range [0, 2 pi]
     double angularDist(double a, double startAngle, bool reversed) {
         return reversed?
@@ -78,16 +84,15 @@ namespace{
 
 // Clean up zero length entities from a container
     void avoidZeroLength(RS_EntityContainer& container) {
-        std::set<RS_Entity*> toCleanUp;
+        std::vector<RS_Entity*> toCleanUp;
         for (RS_Entity* e: container) {
             if (e != nullptr && e->isContainer())
                 avoidZeroLength(*static_cast<RS_EntityContainer*>(e));
             else if (e != nullptr && RS_Math::equal(e->getLength(), 0.)) {
-                toCleanUp.insert(e);
+                toCleanUp.push_back(e);
             }
         }
-        for (RS_Entity* e: toCleanUp)
-            container.removeEntity(e);
+        container.removeEntities(toCleanUp);
     }
 }
 
@@ -113,7 +118,6 @@ RS_Hatch::RS_Hatch(RS_EntityContainer* parent,
 
     hatch = nullptr;
     updateRunning = false;
-    needOptimization = true;
     updateError = HATCH_UNDEFINED;
 }
 
@@ -192,6 +196,7 @@ void RS_Hatch::calculateBorders() {
  * Refill hatch with pattern. Move, scale, rotate, trim, etc.
  */
 void RS_Hatch::update() {
+    LC_TRACE_ZONE("regen", "hatchUpdate");
 
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update");
 
@@ -266,10 +271,6 @@ void RS_Hatch::update() {
     forcedCalculateBorders();
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: scaling pattern: OK");
 
-    std::unique_ptr<RS_Hatch> copy {(RS_Hatch*)this->clone()};
-    copy->rotate(RS_Vector(0.0,0.0), -data.angle);
-    copy->forcedCalculateBorders();
-
     // create a pattern over the whole contour.
     RS_Vector pSize = pat->getSize();
     RS_Vector rot_center=pat->getMin();
@@ -289,13 +290,44 @@ void RS_Hatch::update() {
         updateError = HATCH_TOO_SMALL;
         return;
     }
-        // avoid huge memory consumption:
-    else if ( cSize.x* cSize.y/(pSize.x*pSize.y)>1e4) {
+
+    // line patterns are filled by scanlines into an array of segments, without a pattern carpet
+    LC_HatchScanline scanline{*this};
+    if (scanline.isValid() && LC_HatchScanline::isSupported(*pat)) {
+        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: filling pattern by scanlines");
+        std::vector<LC_HatchScanline::Segment> segments;
+        if (!scanline.fill(*pat, data.angle, maxHatchSegments, segments)) {
+            updateRunning = false;
+            RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
+            updateError = HATCH_AREA_TOO_BIG;
+            return;
+        }
+
+        hatch = new LC_HatchLines(this, std::move(segments));
+        hatch->setPen(hatch_pen);
+        hatch->setLayer(hatch_layer);
+        hatch->setFlag(RS2::FlagTemp);
+        addEntity(hatch);
+
+        forcedCalculateBorders();
+        activateContour(false);
+        updateRunning = false;
+        m_updated = true;
+        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
+        return;
+    }
+
+    // avoid huge memory consumption:
+    if ( cSize.x* cSize.y/(pSize.x*pSize.y)>1e4) {
         RS_DEBUG->print(RS_Debug::D_ERROR, "RS_Hatch::update: contour size too large or pattern size too small");
         updateError = HATCH_AREA_TOO_BIG;
         return;
     }
 
+    std::unique_ptr<RS_Hatch> copy {(RS_Hatch*)this->clone()};
+    copy->rotate(RS_Vector(0.0,0.0), -data.angle);
+    copy->forcedCalculateBorders();
+
     // calculate pattern pieces quantity
     // find out how many pattern-instances we need in x/y:
     int px1 = (int)floor(copy->getMin().x/pSize.x);
@@ -584,19 +616,24 @@ void RS_Hatch::draw(RS_Painter* painter) {
 
 void RS_Hatch::drawSolidFill(RS_Painter *painter) {//area of solid fill. Use polygon approximation, except trivial cases
 
-    if (needOptimization == true) {
+    // the tiles of a view are drawn concurrently, so the loops optimized on the first drawing are set as a whole;
+    // tiles optimizing them at the same time build equal loops, and only one of them is kept
+    std::shared_ptr<RS_EntityContainer> orderedLoops = std::atomic_load(&m_orderedLoops);
+    if (orderedLoops == nullptr) {
         LC_LoopUtils::LoopOptimizer optimizer{*this};
-        m_orderedLoops = optimizer.GetResults();
-        needOptimization = false;
+        orderedLoops = optimizer.GetResults();
+        if (orderedLoops == nullptr)
+            return;
+        std::shared_ptr<RS_EntityContainer> expected;
+        if (!std::atomic_compare_exchange_strong(&m_orderedLoops, &expected, orderedLoops)) {
+            orderedLoops = expected;
+        }
     }
 
-    if (m_orderedLoops == nullptr)
-        return;
-
     const QBrush brush(painter->brush());
     const RS_Pen pen=painter->getPen();
     try {
-        QPainterPath path = createSolidFillPath(painter);
+        QPainterPath path = createSolidFillPath(painter, *orderedLoops);
         QBrush fillBrush = brush;
         fillBrush.setColor(pen.getColor());
         fillBrush.setStyle(Qt::SolidPattern);
@@ -609,9 +646,9 @@ void RS_Hatch::drawSolidFill(RS_Painter *painter) {//area of solid fill. Use pol
     painter->setPen(pen);
 }
 
-QPainterPath RS_Hatch::createSolidFillPath(RS_Painter *painter) const
+QPainterPath RS_Hatch::createSolidFillPath(RS_Painter *painter, const RS_EntityContainer &orderedLoops) const
 {
-    return painter->createSolidFillPath(*m_orderedLoops);
+    return painter->createSolidFillPath(orderedLoops);
 }
 
 void RS_Hatch::debugOutPath(const QPainterPath &tmpPath) const {
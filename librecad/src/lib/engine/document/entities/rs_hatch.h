@@ -166,15 +166,15 @@ private:
     double m_area = RS_MAXDOUBLE;
     int  updateError = 0;
     bool updateRunning = false;
-    bool needOptimization = false;
     bool m_updated=false;
+    /** loops of a solid fill, optimized on the first drawing and set as a whole */
     std::shared_ptr<RS_EntityContainer> m_orderedLoops;
 
     void drawSolidFill(RS_Painter *painter);
 
     void debugOutPath(const QPainterPath &tmpPath) const;
 
-    QPainterPath createSolidFillPath( RS_Painter *painter) const;
+    QPainterPath createSolidFillPath(RS_Painter *painter, const RS_EntityContainer &orderedLoops) const;
 };
 
 #endif
@@ -23,11 +23,13 @@
 ** This copyright notice MUST APPEAR in all copies of the script!
 **
 **********************************************************************/
+#include <algorithm>
 #include<iostream>
 #include <QDir>
 #include <QFileInfo>
 #include <QImage>
 
+#include "lc_imagecache.h"
 #include "rs_debug.h"
 #include "rs_document.h"
 #include "rs_graphicview.h"
@@ -98,10 +100,10 @@ RS_Image::RS_Image(RS_EntityContainer* parent,
 }
 
 RS_Entity* RS_Image::clone() const {
+    // the decoded image is shared with the clone
     auto* i = new RS_Image(*this);
     i->setHandle(getHandle());
     i->initId();
-    i->update();
     return i;
 }
 
@@ -119,8 +121,8 @@ void RS_Image::update() {
     // the whole image:
     QString filePathName = imageRelativePathName(data.file);
 
-    //QImage image = QImage(data.file);
-    img = std::make_shared<QImage>(filePathName);
+    // decoded once for all entities of the file
+    img = LC_ImageCache::instance().getImage(filePathName);
     if (!img->isNull()) {
         data.size = RS_Vector(img->width(), img->height());
         calculateBorders(); // image update need this.
@@ -363,7 +365,13 @@ void RS_Image::draw(RS_Painter* painter) {
     if (!img.get() || img->isNull()) {
         return;
     }
-    painter->drawImgWCS(*img, data.insertionPoint, data.uVector, data.vVector);
+    // the level of detail matching the zoom; pixel vectors are scaled to the size of the level
+    const double screenPixels = std::min(data.uVector.magnitude(), data.vVector.magnitude())
+                                / painter->toWcsLength(1.);
+    const QImage level = img->getLevel(screenPixels);
+    const double scaleU = static_cast<double>(img->width()) / level.width();
+    const double scaleV = static_cast<double>(img->height()) / level.height();
+    painter->drawImgWCS(level, data.insertionPoint, data.uVector * scaleU, data.vVector * scaleV);
 
     if (isSelected() && !(painter->isPrinting() || painter->isPrintPreview())) {
         RS_VectorSolutions sol = getCorners();
@@ -30,7 +30,7 @@
 #include "rs_atomicentity.h"
 #include "lc_rectregion.h"
 
-class QImage;
+class LC_ImagePyramid;
 
 /**
  * Holds the data that defines a line.
@@ -218,7 +218,8 @@ protected:
     bool containsPoint(const RS_Vector& coord) const;
     RS_ImageData data;
     LC_RectRegion rectRegion;
-    std::shared_ptr<QImage> img;
+    /** the decoded image, shared with other entities of the same file */
+    std::shared_ptr<const LC_ImagePyramid> img;
 };
 
 #endif
@@ -26,17 +26,20 @@
 
 #include "rs_insert.h"
 
+#include<algorithm>
 #include<cmath>
 #include<iostream>
 
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
+#include "lc_trace.h"
 #include "rs_debug.h"
 #include "rs_ellipse.h"
 #include "rs_graphic.h"
 #include "rs_layer.h"
 #include "rs_math.h"
+#include "rs_painter.h"
 
 namespace {
 
@@ -107,21 +110,33 @@ RS_Insert::RS_Insert(RS_EntityContainer* parent,
 
 RS_Entity* RS_Insert::clone() const{
 	RS_Insert* i = new RS_Insert(*this);
+	i->m_instanceEntities.clear();
 	i->setOwner(isOwner());
 	i->initId();
 	i->detach();
 	return i;
 }
 
+RS_Entity* RS_Insert::cloneProxy() const{
+    // an instanced insert has no entities to proxy, and its clone is cheap
+    if (isInstanced()) {
+        return clone();
+    }
+    return RS_EntityContainer::cloneProxy();
+}
+
 
 /**
  * Updates the entity buffer of this insert entity. This method
  * needs to be called whenever the block this insert is based on changes.
  */
 void RS_Insert::update() {
+        LC_TRACE_ZONE("regen", "insertUpdate");
 
         RS_DEBUG->print("RS_Insert::update");
-        RS_DEBUG->print("RS_Insert::update: name: %s", data.name.toLatin1().data());
+        if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+            RS_DEBUG->print("RS_Insert::update: name: %s", data.name.toLatin1().data());
+        }
 //        RS_DEBUG->print("RS_Insert::update: insertionPoint: %f/%f",
 //                data.insertionPoint.x, data.insertionPoint.y);
 
@@ -130,6 +145,8 @@ void RS_Insert::update() {
         }
 
     clear();
+    m_instanceEntities.clear();
+    entitiesDeferred = false;
 
     RS_Block* blk = getBlockForInsert();
     if (blk == nullptr) {
@@ -151,6 +168,61 @@ void RS_Insert::update() {
                     data.cols, data.rows);
     RS_DEBUG->print("RS_Insert::update: block has %d entities",
                     blk->count());
+    if (canBeInstanced(blk)) {
+        // nested inserts are entities of the block shared by all instances, so they are updated by the first
+        // instance only, once per update of the inserts of the graphic
+        if (data.updateMode != RS2::PreviewUpdate && !blk->hasUpdatedInserts()) {
+            // set before, as a block may insert itself
+            blk->setInsertsUpdated(true);
+            for (auto* e: *blk) {
+                if (e->rtti() == RS2::EntityInsert) {
+                    e->update();
+                }
+            }
+        }
+        entitiesDeferred = true;
+        calculateBorders();
+        RS_DEBUG->print("RS_Insert::update: instanced OK");
+        return;
+    }
+
+    createEntities(blk);
+    calculateBorders();
+
+    RS_DEBUG->print("RS_Insert::update: OK");
+}
+
+/**
+ * Inserts are instanced if the scaling is uniform, so the block entities drawn with the transformation
+ * of the insert look the same as their transformed copies. Letters of texts are instanced inserts of
+ * the font blocks, which are shared by all texts.
+ */
+bool RS_Insert::canBeInstanced([[maybe_unused]] RS_Block* blk) const {
+    // previews are modified by actions
+    if (data.updateMode == RS2::PreviewUpdate) {
+        return false;
+    }
+    const double scaleX = std::abs(data.scaleFactor.x);
+    const double scaleY = std::abs(data.scaleFactor.y);
+    return std::abs(scaleX - scaleY) <= RS_TOLERANCE * std::max(scaleX, scaleY);
+}
+
+/**
+ * Creates the entities of an instanced insert, when they are accessed.
+ */
+void RS_Insert::createDeferredEntities() {
+    entitiesDeferred = false;
+    RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+            RS_DEBUG->print("RS_Insert::createDeferredEntities: name: %s", data.name.toLatin1().data());
+        }
+        createEntities(blk);
+        calculateBorders();
+    }
+}
+
+void RS_Insert::createEntities(RS_Block* blk) {
         for(auto* e: *blk){
             for (int c=0; c<data.cols; ++c) {
 //            RS_DEBUG->print("RS_Insert::update: col %d", c);
@@ -247,13 +319,8 @@ void RS_Insert::update() {
                 }
             }
         }
-        calculateBorders();
-
-        RS_DEBUG->print("RS_Insert::update: OK");
 }
 
-
-
 /**
  * @return Pointer to the block associated with this Insert or
  *   nullptr if the block couldn't be found. Blocks are requested
@@ -391,6 +458,385 @@ void RS_Insert::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 }
 
 
+RS_Vector RS_Insert::mapToWorld(const RS_Vector& blockPoint, int col, int row) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Vector v = blockPoint;
+    if (blk != nullptr) {
+        v -= blk->getBasePoint();
+    }
+    v.scale(data.scaleFactor);
+    v += RS_Vector(data.spacing.x * col, data.spacing.y * row);
+    v.rotate(data.angle);
+    return v + data.insertionPoint;
+}
+
+RS_Vector RS_Insert::mapToBlock(const RS_Vector& worldPoint, int col, int row) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Vector v = worldPoint - data.insertionPoint;
+    v.rotate(-data.angle);
+    v -= RS_Vector(data.spacing.x * col, data.spacing.y * row);
+    v.scale(RS_Vector(1. / data.scaleFactor.x, 1. / data.scaleFactor.y));
+    if (blk != nullptr) {
+        v += blk->getBasePoint();
+    }
+    return v;
+}
+
+void RS_Insert::mapEntityToWorld(RS_Entity* blockEntity, int col, int row) const {
+    RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        blockEntity->move(blk->getBasePoint() * -1.);
+    }
+    const RS_Vector origin{0., 0.};
+    blockEntity->scale(origin, data.scaleFactor);
+    blockEntity->move(RS_Vector(data.spacing.x * col, data.spacing.y * row));
+    blockEntity->rotate(origin, data.angle);
+    blockEntity->move(data.insertionPoint);
+}
+
+double RS_Insert::getInstanceScale() const {
+    return std::abs(data.scaleFactor.x);
+}
+
+RS_Layer* RS_Insert::getInstanceLayer(const RS_Entity* blockEntity, RS_Layer* insertLayer) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Layer* layer = nullptr;
+    // entities of sub-containers (e.g. dimensions) of the block may be on the layer of their container
+    for (const RS_Entity* e = blockEntity; e != nullptr && e != blk && layer == nullptr; e = e->getParent()) {
+        layer = e->getLayer(false);
+    }
+    // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
+    if (layer == nullptr || layer->getName() == "0") {
+        return insertLayer;
+    }
+    return layer;
+}
+
+RS_Pen RS_Insert::getInstancePen(const RS_Entity* blockEntity, const RS_Pen& insertPen, RS_Layer* insertLayer) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Pen pen = blockEntity->getPen(false);
+    // attributes by block are inherited from the parent containers up to the insert, as cloned entities do
+    for (const RS_Entity* e = blockEntity->getParent(); ; e = e->getParent()) {
+        const bool blockLevel = e == nullptr || e == blk;
+        const RS_Pen parentPen = blockLevel ? insertPen : e->getPen(false);
+        pen = pen.isValid() ? updatePen(std::move(pen), parentPen) : parentPen;
+        if (blockLevel) {
+            break;
+        }
+    }
+
+    RS_Layer* layer = getInstanceLayer(blockEntity, insertLayer);
+    if (layer == nullptr) {
+        return pen;
+    }
+    // use layer's attributes, as RS_Entity::getPenResolved() does
+    const RS_Pen& layerPen = layer->getPen();
+    const bool colorByLayer = pen.isColorByLayer();
+    const bool widthByLayer = pen.isWidthByLayer();
+    const bool lineByLayer = pen.isLineTypeByLayer();
+    if (colorByLayer) {
+        pen.setColorFromPen(layerPen);
+    }
+    if (widthByLayer) {
+        pen.setWidthFromPen(layerPen);
+    }
+    if (lineByLayer) {
+        pen.setLineTypeFromPen(layerPen);
+    }
+    return pen;
+}
+
+unsigned RS_Insert::count() const {
+    if (isInstanced()) {
+        RS_Block* blk = getBlockForInsert();
+        return blk == nullptr ? 0 : blk->count() * data.cols * data.rows;
+    }
+    return RS_EntityContainer::count();
+}
+
+unsigned RS_Insert::countDeep() const {
+    if (isInstanced()) {
+        RS_Block* blk = getBlockForInsert();
+        return blk == nullptr ? 0 : blk->countDeep() * data.cols * data.rows;
+    }
+    return RS_EntityContainer::countDeep();
+}
+
+double RS_Insert::getLength() const {
+    if (isInstanced()) {
+        RS_Block* blk = getBlockForInsert();
+        if (blk == nullptr) {
+            return 0.;
+        }
+        const double length = blk->getLength();
+        // negative length: the block has entities of unknown length
+        return length < 0. ? length : length * getInstanceScale() * data.cols * data.rows;
+    }
+    return RS_EntityContainer::getLength();
+}
+
+/**
+ * Borders of instanced inserts are the transformed borders of the block entities.
+ */
+void RS_Insert::calculateBorders() {
+    if (!isInstanced()) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+
+    resetBorders();
+    RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        RS_Layer* insertLayer = getLayer();
+        for (RS_Entity* e: *blk) {
+            // as for copies of the block entities, the layer of the insert replaces layer "0"
+            RS_Layer* layer = getInstanceLayer(e, insertLayer);
+            if (!e->getFlag(RS2::FlagVisible) || e->isUndone() || (layer != nullptr && layer->isFrozen())
+                || (e->isContainer() && e->count() == 0)) {
+                continue;
+            }
+            const RS_Vector eMin = e->getMin();
+            const RS_Vector eMax = e->getMax();
+            const RS_Vector corners[] = {eMin, {eMax.x, eMin.y}, eMax, {eMin.x, eMax.y}};
+            for (int c = 0; c < data.cols; ++c) {
+                for (int r = 0; r < data.rows; ++r) {
+                    for (const RS_Vector& corner: corners) {
+                        const RS_Vector v = mapToWorld(corner, c, r);
+                        minV = RS_Vector::minimum(minV, v);
+                        maxV = RS_Vector::maximum(maxV, v);
+                    }
+                }
+            }
+        }
+    }
+
+    // needed for correcting corrupt data (PLANS.dxf)
+    if (minV.x > maxV.x || minV.x > RS_MAXDOUBLE || maxV.x > RS_MAXDOUBLE
+        || minV.x < RS_MINDOUBLE || maxV.x < RS_MINDOUBLE) {
+        minV.x = 0.0;
+        maxV.x = 0.0;
+    }
+    if (minV.y > maxV.y || minV.y > RS_MAXDOUBLE || maxV.y > RS_MAXDOUBLE
+        || minV.y < RS_MINDOUBLE || maxV.y < RS_MINDOUBLE) {
+        minV.y = 0.0;
+        maxV.y = 0.0;
+    }
+    updateParentIndex();
+}
+
+RS_Vector RS_Insert::getNearestInInstances(const RS_Vector& coord, double* dist, const InstanceQuery& query) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Vector closest(false);
+    double minDist = RS_MAXDOUBLE;
+    if (blk != nullptr) {
+        const double scale = getInstanceScale();
+        for (int c = 0; c < data.cols; ++c) {
+            for (int r = 0; r < data.rows; ++r) {
+                double curDist = RS_MAXDOUBLE;
+                const RS_Vector point = query(blk, mapToBlock(coord, c, r), &curDist);
+                if (point.valid && curDist * scale < minDist) {
+                    minDist = curDist * scale;
+                    closest = mapToWorld(point, c, r);
+                }
+            }
+        }
+    }
+    if (dist != nullptr) {
+        *dist = minDist;
+    }
+    return closest;
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord, double* dist) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    }
+    return getNearestInInstances(coord, dist, [](RS_Block* blk, const RS_Vector& blockCoord, double* d) {
+        return blk->getNearestEndpoint(blockCoord, d);
+    });
+}
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                             double* dist, RS_Entity** entity) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    // block entities are shared by all instances, so the insert itself is reported as the entity
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return getNearestInInstances(coord, dist, [onEntity](RS_Block* blk, const RS_Vector& blockCoord, double* d) {
+        return blk->getNearestPointOnEntity(blockCoord, onEntity, d, nullptr);
+    });
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    }
+    return getNearestInInstances(coord, dist, [](RS_Block* blk, const RS_Vector& blockCoord, double* d) {
+        return blk->getNearestCenter(blockCoord, d);
+    });
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord, double* dist, int middlePoints) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    }
+    return getNearestInInstances(coord, dist, [middlePoints](RS_Block* blk, const RS_Vector& blockCoord, double* d) {
+        return blk->getNearestMiddle(blockCoord, d, middlePoints);
+    });
+}
+
+RS_Vector RS_Insert::getNearestDist(double distance, const RS_Vector& coord, double* dist) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    }
+    // the distance along entities is scaled to the block
+    const double blockDistance = distance / getInstanceScale();
+    return getNearestInInstances(coord, dist, [blockDistance](RS_Block* blk, const RS_Vector& blockCoord, double* d) {
+        return blk->getNearestDist(blockDistance, blockCoord, d);
+    });
+}
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const {
+    if (!isInstanced()) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    // the caller needs the individual entity, which is given by a transformed copy of the nearest block entity
+    const bool resolved = entity != nullptr && (level == RS2::ResolveAll || level == RS2::ResolveAllButTextImage);
+
+    RS_Block* blk = getBlockForInsert();
+    double minDist = RS_MAXDOUBLE;
+    RS_Entity* nearest = nullptr;
+    int nearestCol = 0;
+    int nearestRow = 0;
+    if (blk != nullptr) {
+        const double scale = getInstanceScale();
+        for (int c = 0; c < data.cols; ++c) {
+            for (int r = 0; r < data.rows; ++r) {
+                RS_Entity* blockEntity = nullptr;
+                const double d = blk->getDistanceToPoint(mapToBlock(coord, c, r), resolved ? &blockEntity : nullptr,
+                                                         level, solidDist / scale);
+                if (d < RS_MAXDOUBLE && d * scale < minDist) {
+                    minDist = d * scale;
+                    nearest = blockEntity;
+                    nearestCol = c;
+                    nearestRow = r;
+                }
+            }
+        }
+    }
+    if (entity != nullptr) {
+        if (minDist == RS_MAXDOUBLE) {
+            *entity = nullptr;
+        } else if (resolved && nearest != nullptr) {
+            *entity = getInstanceEntity(nearest, nearestCol, nearestRow);
+        } else {
+            *entity = const_cast<RS_Insert*>(this);
+        }
+    }
+    return minDist;
+}
+
+RS_Entity* RS_Insert::getInstanceEntity(const RS_Entity* blockEntity, int col, int row) const {
+    const RS_Vector blockMin = blockEntity->getMin();
+    const RS_Vector blockMax = blockEntity->getMax();
+    const auto key = std::make_tuple(blockEntity, col, row);
+    const auto range = m_instanceEntities.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.blockMin == blockMin && it->second.blockMax == blockMax) {
+            return it->second.copy.get();
+        }
+    }
+    RS_Entity* copy = blockEntity->clone();
+    copy->setFlag(RS2::FlagTemp);
+    copy->setLayer(getInstanceLayer(blockEntity, getLayer()));
+    copy->setPen(getInstancePen(blockEntity, getPen(false), getLayer()));
+    copy->setParent(const_cast<RS_Insert*>(this));
+    mapEntityToWorld(copy, col, row);
+    m_instanceEntities.emplace(key, InstanceEntity{blockMin, blockMax, std::shared_ptr<RS_Entity>(copy)});
+    return copy;
+}
+
+bool RS_Insert::setSelected(bool select) {
+    if (!isInstanced()) {
+        return RS_EntityContainer::setSelected(select);
+    }
+    // instances are drawn as selected by the selection of the insert, and copies created later take it over
+    return RS_Entity::setSelected(select);
+}
+
+bool RS_Insert::hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) {
+    if (!isInstanced()) {
+        return RS_EntityContainer::hasEndpointsWithinWindow(v1, v2);
+    }
+    RS_Block* blk = getBlockForInsert();
+    const RS_Vector windowMin = RS_Vector::minimum(v1, v2);
+    const RS_Vector windowMax = RS_Vector::maximum(v1, v2);
+    if (blk == nullptr || getMax().x < windowMin.x || getMin().x > windowMax.x
+        || getMax().y < windowMin.y || getMin().y > windowMax.y) {
+        return false;
+    }
+    // end points of the instances are found on temporary copies of the block entities
+    for (RS_Entity* e: *blk) {
+        for (int c = 0; c < data.cols; ++c) {
+            for (int r = 0; r < data.rows; ++r) {
+                std::unique_ptr<RS_Entity> copy{e->clone()};
+                mapEntityToWorld(copy.get(), c, r);
+                if (copy->hasEndpointsWithinWindow(v1, v2)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Editing by points changes the copies of the block entities, as for inserts which are not instanced,
+ * so the copies are created first.
+ */
+void RS_Insert::stretch(const RS_Vector& firstCorner, const RS_Vector& secondCorner, const RS_Vector& offset) {
+    resolveDeferredEntities();
+    RS_EntityContainer::stretch(firstCorner, secondCorner, offset);
+}
+
+void RS_Insert::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
+    resolveDeferredEntities();
+    RS_EntityContainer::moveRef(ref, offset);
+}
+
+void RS_Insert::moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) {
+    resolveDeferredEntities();
+    RS_EntityContainer::moveSelectedRef(ref, offset);
+}
+
+void RS_Insert::draw(RS_Painter* painter) {
+    if (!isInstanced()) {
+        RS_EntityContainer::draw(painter);
+        return;
+    }
+    RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return;
+    }
+    for (int c = 0; c < data.cols; ++c) {
+        for (int r = 0; r < data.rows; ++r) {
+            painter->drawInsertInstance(this, blk, c, r);
+        }
+    }
+}
+
+void RS_Insert::drawAsChild(RS_Painter* painter) {
+    if (!isInstanced()) {
+        RS_EntityContainer::drawAsChild(painter);
+        return;
+    }
+    draw(painter);
+}
+
 std::ostream& operator << (std::ostream& os, const RS_Insert& i) {
     os << " Insert: " << i.getData() << std::endl;
     return os;
@@ -28,9 +28,15 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+
 #include "rs_entitycontainer.h"
 
 class RS_BlockList;
+class RS_Layer;
 
 /**
  * Holds the data that defines an insert.
@@ -86,6 +92,11 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  * refer to a block. However, to the outside world they act exactly
  * like EntityContainer.
  *
+ * Inserts with uniform scaling, including the letters of texts, are instanced: they keep
+ * only the transformation, are drawn and snapped to using the shared entities
+ * of the block, and create transformed copies of the block entities only when
+ * the entity list is accessed (e.g. on explode).
+ *
  * @author Andrew Mustun
  */
 class RS_Insert : public RS_EntityContainer {
@@ -94,6 +105,7 @@ public:
               const RS_InsertData& d);
 
     RS_Entity* clone() const override;
+    RS_Entity* cloneProxy() const override;
 
     /** @return RS2::EntityInsert */
     RS2::EntityType rtti() const  override{
@@ -106,14 +118,25 @@ public:
     }
 
         /**
-         * Reimplementation of reparent. Invalidates block cache pointer.
+         * Reimplementation of reparent. Invalidates block cache pointer,
+         * unless the block comes from a block source, e.g. a font, which
+         * doesn't depend on the parent.
          */
     void reparent(RS_EntityContainer* parent)  override{
                 RS_Entity::reparent(parent);
-                block = nullptr;
+                if (data.blockSource == nullptr) {
+                    block = nullptr;
+                }
     }
 
 	RS_Block* getBlockForInsert() const;
+    /**
+     * @brief setBlockForInsert sets the block in advance, instead of finding it by name on the first use,
+     * e.g. a letter of a font shared by concurrent text updates
+     */
+    void setBlockForInsert(RS_Block* blk) {
+        block = blk;
+    }
 
     void update() override;
 
@@ -174,24 +197,125 @@ public:
 
     bool isVisible() const override;
 
+    /**
+     * @return true, if the insert has no entities, and draws the entities of the block instead
+     */
+    bool isInstanced() const {
+        return entitiesDeferred;
+    }
+    /**
+     * @brief mapToWorld maps a point of the block to the drawing, for the given column and row of the insert
+     */
+    RS_Vector mapToWorld(const RS_Vector& blockPoint, int col = 0, int row = 0) const;
+    /**
+     * @brief mapToBlock maps a point of the drawing to the block, for the given column and row of the insert
+     */
+    RS_Vector mapToBlock(const RS_Vector& worldPoint, int col = 0, int row = 0) const;
+    /**
+     * @brief mapEntityToWorld transforms a copy of an entity of the block to the drawing, for the given column
+     * and row of the insert, as mapToWorld() maps points
+     */
+    void mapEntityToWorld(RS_Entity* blockEntity, int col = 0, int row = 0) const;
+    /**
+     * @return scaling of distances from the block to the drawing, for instanced inserts
+     */
+    double getInstanceScale() const;
+    /**
+     * @brief getInstanceLayer the layer of an entity of the block, as if it was an entity of this insert:
+     * entities on layer "0" are on the layer of the insert
+     */
+    RS_Layer* getInstanceLayer(const RS_Entity* blockEntity, RS_Layer* insertLayer) const;
+    /**
+     * @brief getInstancePen the resolved pen of an entity of the block, as if it was an entity of this insert:
+     * attributes by block are taken from the insert pen, and attributes by layer from the instance layer
+     */
+    RS_Pen getInstancePen(const RS_Entity* blockEntity, const RS_Pen& insertPen, RS_Layer* insertLayer) const;
+
+    unsigned count() const override;
+    unsigned countDeep() const override;
+    double getLength() const override;
+    void calculateBorders() override;
+
     RS_VectorSolutions getRefPoints() const override;
     RS_Vector getMiddlePoint(void) const  override{
         return {};
     }
     RS_Vector getNearestRef(const RS_Vector& coord,
                             double* dist = nullptr) const override;
+    using RS_EntityContainer::getNearestEndpoint;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+
+    bool setSelected(bool select = true) override;
+    bool hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2) override;
 
     void move(const RS_Vector& offset) override;
     void rotate(const RS_Vector& center, double angle) override;
     void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
     void scale(const RS_Vector& center, const RS_Vector& factor) override;
     void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
+    void stretch(const RS_Vector& firstCorner,
+                 const RS_Vector& secondCorner,
+                 const RS_Vector& offset) override;
+    void moveRef(const RS_Vector& ref, const RS_Vector& offset) override;
+    void moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) override;
+
+    void draw(RS_Painter* painter) override;
+    void drawAsChild(RS_Painter* painter) override;
 
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
+    void createDeferredEntities() override;
+
     RS_InsertData data{};
     mutable RS_Block* block = nullptr;
+
+private:
+    using InstanceQuery = std::function<RS_Vector(RS_Block* block, const RS_Vector& blockCoord, double* dist)>;
+
+    /**
+     * Transformed copy of an entity of the block, given to resolved queries of an instanced insert
+     */
+    struct InstanceEntity {
+        // borders of the block entity, which may be a temporary entity reused for other geometry
+        RS_Vector blockMin;
+        RS_Vector blockMax;
+        std::shared_ptr<RS_Entity> copy;
+    };
+
+    bool canBeInstanced(RS_Block* blk) const;
+    /**
+     * @brief createEntities create the transformed copies of the block entities
+     */
+    void createEntities(RS_Block* blk);
+    /**
+     * @brief getNearestInInstances run a nearest point query on the block for each column and row of the insert
+     */
+    RS_Vector getNearestInInstances(const RS_Vector& coord, double* dist, const InstanceQuery& query) const;
+    /**
+     * @brief getInstanceEntity the transformed copy of an entity of the block for the column and row; copies are
+     * kept until the insert is updated, so callers may keep them as entities of the insert
+     */
+    RS_Entity* getInstanceEntity(const RS_Entity* blockEntity, int col, int row) const;
+
+    mutable std::multimap<std::tuple<const RS_Entity*, int, int>, InstanceEntity> m_instanceEntities;
 };
 
 
@@ -29,6 +29,7 @@
 #include "rs_line.h"
 
 #include "lc_rect.h"
+#include "lc_objectpool.h"
 #include "qc_applicationwindow.h"
 
 #include "rs_circle.h"
@@ -80,6 +81,24 @@ RS_Entity* RS_Line::clone() const {
 	return l;
 }
 
+namespace {
+LC_ObjectPool& linePool()
+{
+    static auto* pool = new LC_ObjectPool{sizeof(RS_Line), "RS_Line"};
+    return *pool;
+}
+}
+
+void* RS_Line::operator new(std::size_t size)
+{
+    return linePool().allocate(size);
+}
+
+void RS_Line::operator delete(void* entity, std::size_t size)
+{
+    linePool().deallocate(entity, size);
+}
+
 void RS_Line::calculateBorders() {
     minV = RS_Vector::minimum(data.startpoint, data.endpoint);
     maxV = RS_Vector::maximum(data.startpoint, data.endpoint);
@@ -25,6 +25,7 @@
 **********************************************************************/
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include "rs_atomicentity.h"
@@ -59,6 +60,10 @@ public:
     RS_Line(const RS_Vector& pStart, const RS_Vector& pEnd);
     RS_Entity* clone() const override;
 
+    /** Allocated from a pool, see LC_ObjectPool */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* entity, std::size_t size);
+
     /** @return RS2::EntityLine */
     RS2::EntityType rtti() const override{
         return RS2::EntityLine;
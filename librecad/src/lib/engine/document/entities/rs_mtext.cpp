@@ -297,13 +297,16 @@ void RS_MText::update() {
   // Rotation, scaling and centering is done later
 
   // For every letter:
+  const QStringView text{data.text};
   for (decltype(data.text.length()) i = 0; i < data.text.length(); ++i) {
+    // the rest of the text is viewed, not copied, so the layout is linear in the text length
+    const QStringView rest = text.sliced(i);
     // Handle \F not followed by {<codePage>}
-    if (data.text.mid(i).startsWith(R"(\F)") &&
-        data.text.mid(i).indexOf(R"(^\\[Ff]\{[\d\w]*\})") != 0) {
+    if (rest.startsWith(QLatin1String(R"(\F)")) &&
+        rest.indexOf(QLatin1String(R"(^\\[Ff]\{[\d\w]*\})")) != 0) {
       addLetter(*oneLine, data.text.at(i), *font, letterSpace, letterPos);
       continue;
-    } else if (data.text.mid(i).startsWith(R"(\\)")) {
+    } else if (rest.startsWith(QLatin1String(R"(\\)"))) {
       // Allow escape '\', needed to support "\S" and "\P" in string
       // "\S" is used for super/subscripts
       // "\P" is used to start a new line
@@ -333,7 +336,7 @@ void RS_MText::update() {
       if (static_cast<int>(data.text.length()) <= i) {
         continue;
       }
-      std::uint32_t ch{data.text.toUcs4().at(i)};
+      std::uint32_t ch{data.text.at(i).unicode()};
       switch (ch) {
       case 'P':
         updateAddLine(oneLine, lineCounter++);
@@ -522,12 +525,9 @@ void RS_MText::rotateLinesRefs() const {
 void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
                          RS_Font &font, const RS_Vector &letterSpace,
                          RS_Vector &letterPosition) {
-    QString letterText{QString(letter)};
-    if (nullptr == font.findLetter(letterText)) {
-        RS_DEBUG->print("RS_MText::update: missing font for letter( %s ), replaced "
-                        "it with QChar(0xfffd)",
-                        qPrintable(letterText));
-        letterText = QChar(0xfffd);
+    const RS_Font::Glyph *glyph = font.findGlyph(letter);
+    if (nullptr == glyph) {
+        return;
     }
 
     LC_LOG << "RS_MText::update: insert a letter at pos:(" << letterPosition.x
@@ -536,17 +536,17 @@ void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
     // adjust for right-to-left text: letter position start from the right
     bool righToLeft = std::signbit(letterSpace.x);
 
-    RS_InsertData d(letterText, letterPosition, RS_Vector(1.0, 1.0), 0.0, 1, 1,
+    RS_InsertData d(glyph->name, letterPosition, RS_Vector(1.0, 1.0), 0.0, 1, 1,
                     RS_Vector(0.0, 0.0), font.getLetterList(), RS2::NoUpdate);
 
     RS_Insert *letterEntity{new RS_Insert(this, d)};
+    letterEntity->setBlockForInsert(glyph->block);
     letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
     letterEntity->setLayer(nullptr);
     letterEntity->update();
-    letterEntity->forcedCalculateBorders();
 
     // Add spacing, if the font is actually wider than word spacing
-    double actualWidth = letterEntity->getMax().x - letterEntity->getMin().x;
+    double actualWidth = glyph->max.x - glyph->min.x;
     if (actualWidth >= font.getWordSpacing() + RS_TOLERANCE) {
         actualWidth = font.getWordSpacing() + std::ceil((actualWidth - font.getWordSpacing())/std::abs(letterSpace.x)) * std::abs(letterSpace.x);
     }
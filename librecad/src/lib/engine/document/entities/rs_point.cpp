@@ -30,6 +30,7 @@
 #include "rs_graphic.h"
 #include "rs_graphicview.h"
 #include "rs_painter.h"
+#include "lc_objectpool.h"
 #include "lc_defaults.h"
 
 RS_Point::RS_Point(RS_EntityContainer* parent,
@@ -44,6 +45,24 @@ RS_Entity* RS_Point::clone() const {
 	return p;
 }
 
+namespace {
+LC_ObjectPool& pointPool()
+{
+    static auto* pool = new LC_ObjectPool{sizeof(RS_Point), "RS_Point"};
+    return *pool;
+}
+}
+
+void* RS_Point::operator new(std::size_t size)
+{
+    return pointPool().allocate(size);
+}
+
+void RS_Point::operator delete(void* entity, std::size_t size)
+{
+    pointPool().deallocate(entity, size);
+}
+
 RS2::EntityType RS_Point::rtti() const{
     return RS2::EntityPoint;
 }
@@ -28,6 +28,8 @@
 #ifndef RS_POINT_H
 #define RS_POINT_H
 
+#include <cstddef>
+
 #include "rs_atomicentity.h"
 
 /**
@@ -53,6 +55,10 @@ public:
         RS_EntityContainer *parent,
         const RS_PointData &d);
     RS_Entity *clone() const override;
+
+    /** Allocated from a pool, see LC_ObjectPool */
+    static void* operator new(std::size_t size);
+    static void operator delete(void* entity, std::size_t size);
     /**	@return RS_ENTITY_POINT */
     RS2::EntityType rtti() const override;
     /**
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <memory>
 #include <numeric>
 
 #include "rs_spline.h"
@@ -36,6 +37,47 @@
 #include "rs_graphicview.h"
 #include "rs_painter.h"
 
+namespace {
+// tolerance of the polyline created on update(), relative to the size of the control polygon
+constexpr double initialStrokeTolerance = 1e-3;
+// the polyline is re-created for coarser zoom levels, once it's finer than needed by this ratio
+constexpr double maxStrokeToleranceRatio = 16.;
+// maximum deviation of the drawn polyline from the curve, in pixels
+constexpr double strokeTolerancePixels = 0.5;
+// limit of the subdivision depth of the initial intervals
+constexpr int maxStrokeSubdivision = 12;
+
+// round down to a power of 2, so small zoom steps keep the polyline
+double roundStrokeTolerance(double tolerance)
+{
+    if (!(tolerance > RS_TOLERANCE)) {
+        tolerance = RS_TOLERANCE;
+    }
+    return std::exp2(std::floor(std::log2(tolerance)));
+}
+
+// whether a polyline of the stroke tolerance is fine enough for the tolerance, but not much finer
+bool fitsStrokeTolerance(double strokeTolerance, double tolerance)
+{
+    return strokeTolerance > 0. && strokeTolerance <= tolerance && strokeTolerance * maxStrokeToleranceRatio >= tolerance;
+}
+
+double distanceToSegment(const RS_Vector& coord, const RS_Vector& p1, const RS_Vector& p2, RS_Vector* nearest = nullptr)
+{
+    const RS_Vector direction = p2 - p1;
+    const double length2 = direction.squared();
+    double t = 0.;
+    if (length2 > 0.) {
+        t = std::clamp(RS_Vector::dotP(coord - p1, direction) / length2, 0., 1.);
+    }
+    const RS_Vector point = p1 + direction * t;
+    if (nearest != nullptr) {
+        *nearest = point;
+    }
+    return point.distanceTo(coord);
+}
+}
+
 
 RS_SplineData::RS_SplineData(int _degree, bool _closed):
 	degree(_degree)
@@ -68,6 +110,7 @@ std::ostream& operator << (std::ostream& os, const RS_SplineData& ld) {
 RS_Spline::RS_Spline(RS_EntityContainer* parent,
                      const RS_SplineData& d)
         :RS_EntityContainer(parent), data(d) {
+    entitiesDeferred = true;
     calculateBorders();
 }
 
@@ -80,17 +123,52 @@ RS_Entity* RS_Spline::clone() const{
 }
 
 void RS_Spline::calculateBorders() {
-    /*minV = RS_Vector::minimum(data.startpoint, data.endpoint);
-    maxV = RS_Vector::maximum(data.startpoint, data.endpoint);
+    if (!entitiesDeferred) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    for (const RS_Vector& vp: m_strokePoints) {
+        minV = RS_Vector::minimum(vp, minV);
+        maxV = RS_Vector::maximum(vp, maxV);
+    }
+    updateParentIndex();
+}
 
-    QList<RS_Vector>::iterator it;
-    for (it = data.controlPoints.begin();
-    it!=data.controlPoints.end(); ++it) {
+/**
+ * Creates the line entities of the polyline, for users of the entity list.
+ */
+void RS_Spline::createDeferredEntities() {
+    entitiesDeferred = false;
+    RS_Vector prev{};
+    for (auto const& vp: m_strokePoints) {
+        if (prev.valid) {
+            auto* line = new RS_Line{this, prev, vp};
+            line->setLayer(nullptr);
+            line->setPen(RS2::FlagInvalid);
+            appendEntity(line);
+        }
+        prev = vp;
+    }
+}
 
-    minV = RS_Vector::minimum(*it, minV);
-    maxV = RS_Vector::maximum(*it, maxV);
+unsigned RS_Spline::count() const {
+    if (!entitiesDeferred) {
+        return RS_EntityContainer::count();
+    }
+    return m_strokePoints.empty() ? 0 : static_cast<unsigned>(m_strokePoints.size() - 1);
+}
+
+unsigned RS_Spline::countDeep() const {
+    return count();
 }
-    */
+
+double RS_Spline::getLength() const {
+    double length = 0.;
+    for (size_t i = 1; i < m_strokePoints.size(); ++i) {
+        length += m_strokePoints[i - 1].distanceTo(m_strokePoints[i]);
+    }
+    return length;
 }
 
 void RS_Spline::setDegree(int degree) {
@@ -160,6 +238,10 @@ void RS_Spline::update() {
     RS_DEBUG->print("RS_Spline::update");
 
     clear();
+    m_strokePoints.clear();
+    m_strokeTolerance = 0.;
+    m_drawnStroke.reset();
+    entitiesDeferred = true;
 
     if (isUndone()) {
         return;
@@ -178,33 +260,50 @@ void RS_Spline::update() {
         return;
     }
 
-    resetBorders();
-
-    int splineSegments = getGraphicVariableInt("$SPLINESEGS", 8);
-    std::vector<RS_Vector> p;
-    fillStrokePoints(splineSegments, p);
+    wrapControlPoints();
 
-    RS_Vector prev{};
-    for (auto const& vp: p) {
-        if (prev.valid) {
-            auto* line = new RS_Line{this, prev, vp};
-            line->setLayer(nullptr);
-            line->setPen(RS2::FlagInvalid);
-            addEntity(line);
-        }
-        prev = vp;
-        minV = RS_Vector::minimum(prev, minV);
-        maxV = RS_Vector::maximum(prev, maxV);
+    // the polyline is refined to the zoom level on drawing, start with a fraction of the spline size
+    RS_Vector minP = data.controlPoints.front();
+    RS_Vector maxP = minP;
+    for (const RS_Vector& vp: data.controlPoints) {
+        minP = RS_Vector::minimum(minP, vp);
+        maxP = RS_Vector::maximum(maxP, vp);
     }
+    m_strokeTolerance = 0.;
+    updateStrokePoints((maxP - minP).magnitude() * initialStrokeTolerance);
 }
 
-void RS_Spline::fillStrokePoints(int splineSegments, std::vector<RS_Vector>& points) {// wrap control points, if it's not wrapped yet
+/**
+ * Appends the first control points to the control points of a closed spline, if not wrapped yet.
+ */
+void RS_Spline::wrapControlPoints() {
     std::vector<RS_Vector>& tControlPoints = data.controlPoints;
     if (data.closed && (data.degree == 2 || !hasWrappedControlPoints())) {
         std::vector<RS_Vector> wrappedPoints{data.controlPoints.cbegin(), data.controlPoints.cbegin() + data.degree};
         tControlPoints.insert(tControlPoints.end(), wrappedPoints.cbegin(), wrappedPoints.cend());
         RS_DEBUG->print(RS_Debug::D_NOTICE, "%s: controlPoints: size=%llu\n", __func__, data.controlPoints.size());
     }
+}
+
+void RS_Spline::updateStrokePoints(double tolerance) {
+    tolerance = roundStrokeTolerance(tolerance);
+    if (fitsStrokeTolerance(m_strokeTolerance, tolerance)) {
+        return;
+    }
+    if ((!data.closed && data.controlPoints.size() < size_t(data.degree)+1) || (data.closed && data.controlPoints.size() < 3)
+        || data.degree < 1 || data.degree > 3) {
+        return;
+    }
+    fillAdaptiveStrokePoints(tolerance, m_strokePoints);
+    m_strokeTolerance = tolerance;
+    m_drawnStroke.reset();
+    calculateBorders();
+}
+
+void RS_Spline::fillStrokePoints(int splineSegments, std::vector<RS_Vector>& points) {
+    // wrap control points, if it's not wrapped yet
+    wrapControlPoints();
+    const std::vector<RS_Vector>& tControlPoints = data.controlPoints;
 
     const size_t npts = tControlPoints.size();
 
@@ -225,13 +324,13 @@ void RS_Spline::fillStrokePoints(int splineSegments, std::vector<RS_Vector>& poi
 }
 
 RS_Vector RS_Spline::getStartpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->firstEntity())->getStartpoint();
+   if (data.closed || m_strokePoints.empty()) return RS_Vector(false);
+   return m_strokePoints.front();
 }
 
 RS_Vector RS_Spline::getEndpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->lastEntity())->getEndpoint();
+   if (data.closed || m_strokePoints.empty()) return RS_Vector(false);
+   return m_strokePoints.back();
 }
 
 RS_Vector RS_Spline::getNearestEndpoint(const RS_Vector& coord,
@@ -302,6 +401,10 @@ RS_Vector RS_Spline::getNearestDist(double /*distance*/,
 }
 
 void RS_Spline::move(const RS_Vector& offset) {
+    for (RS_Vector& vp: m_strokePoints) {
+        vp.move(offset);
+    }
+    m_drawnStroke.reset();
     RS_EntityContainer::move(offset);
     for (RS_Vector& vp: data.controlPoints) {
         vp.move(offset);
@@ -313,6 +416,10 @@ void RS_Spline::rotate(const RS_Vector& center, double angle) {
 }
 
 void RS_Spline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    for (RS_Vector& vp: m_strokePoints) {
+        vp.rotate(center, angleVector);
+    }
+    m_drawnStroke.reset();
     RS_EntityContainer::rotate(center, angleVector);
     for (RS_Vector& vp: data.controlPoints) {
         vp.rotate(center, angleVector);
@@ -354,10 +461,30 @@ void RS_Spline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 
 void RS_Spline::revertDirection() {
     std::reverse(data.controlPoints.begin(), data.controlPoints.end());
+    std::reverse(m_strokePoints.begin(), m_strokePoints.end());
 }
 
+/**
+ * Draws the polyline of the spline as a single path, refining it first if it's too coarse for the zoom level.
+ */
 void RS_Spline::draw(RS_Painter* painter) {
-    painter->drawSplineWCS(*this);
+    // line entities, if created, keep the polyline they are created from
+    const double tolerance = roundStrokeTolerance(painter->toWcsLength(strokeTolerancePixels));
+    if (!entitiesDeferred || !(m_strokeTolerance > 0.) || fitsStrokeTolerance(m_strokeTolerance, tolerance)) {
+        painter->drawSplineWCS(m_strokePoints);
+        return;
+    }
+    // the tiles of a view are drawn concurrently, so the refined polyline is replaced as a whole, and tiles
+    // drawing the previous one keep it until they're done
+    std::shared_ptr<const DrawnStroke> drawn = std::atomic_load(&m_drawnStroke);
+    if (drawn == nullptr || !fitsStrokeTolerance(drawn->tolerance, tolerance)) {
+        auto refined = std::make_shared<DrawnStroke>();
+        refined->tolerance = tolerance;
+        fillAdaptiveStrokePoints(tolerance, refined->points);
+        drawn = refined;
+        std::atomic_store(&m_drawnStroke, drawn);
+    }
+    painter->drawSplineWCS(drawn->points);
 }
 
 
@@ -539,6 +666,65 @@ void RS_Spline::rbsplinu(size_t npts, size_t k, size_t p1,
     }
 }
 
+void RS_Spline::fillAdaptiveStrokePoints(double tolerance, std::vector<RS_Vector>& points) const {
+    points.clear();
+    const std::vector<RS_Vector>& controlPoints = data.controlPoints;
+    const size_t npts = controlPoints.size();
+    const size_t k = data.degree + 1;
+    const size_t nplusc = npts + k;
+    const std::vector<double> h(npts + 1, 1.);
+    const std::vector<double> x = data.closed ? knotu(npts, k) : knot(npts, k);
+
+    // the same parameter range as rbspline() and rbsplinu()
+    const double tStart = data.closed ? double(k - 1) : x[0];
+    const double tEnd = data.closed ? double(npts) : x[nplusc - 1];
+
+    auto curvePoint = [&](double t) {
+        if (x[nplusc - 1] - t < 5e-6) t = x[nplusc - 1];
+        auto const nbasis = rbasis(k, t, npts, x, h);
+        RS_Vector vp{0., 0.};
+        for (size_t i = 0; i < npts; i++)
+            vp += controlPoints[i] * nbasis[i];
+        return vp;
+    };
+
+    // the interval ends are on the curve already, only the end point of each interval is added
+    auto subdivide = [&](auto& self, double t1, const RS_Vector& p1, double t2, const RS_Vector& p2, int depth) -> void {
+        const double t = 0.5 * (t1 + t2);
+        const RS_Vector p = curvePoint(t);
+        if (depth < maxStrokeSubdivision && distanceToSegment(p, p1, p2) > tolerance) {
+            self(self, t1, p1, t, p, depth + 1);
+            self(self, t, p, t2, p2, depth + 1);
+        } else {
+            points.push_back(p2);
+        }
+    };
+
+    // knot spans are the polynomial pieces, each is split for the flatness test to see inflections
+    std::vector<double> breaks{tStart};
+    for (double knotValue: x) {
+        if (knotValue > breaks.back() && knotValue < tEnd) {
+            breaks.push_back(knotValue);
+        }
+    }
+    breaks.push_back(tEnd);
+    const int spanIntervals = data.degree == 1 ? 1 : 4;
+
+    double t1 = tStart;
+    RS_Vector p1 = curvePoint(t1);
+    points.push_back(p1);
+    for (size_t i = 1; i < breaks.size(); ++i) {
+        const double span = breaks[i] - breaks[i - 1];
+        for (int j = 1; j <= spanIntervals; ++j) {
+            const double t2 = j == spanIntervals ? breaks[i] : breaks[i - 1] + span * j / spanIntervals;
+            const RS_Vector p2 = curvePoint(t2);
+            subdivide(subdivide, t1, p1, t2, p2, 0);
+            t1 = t2;
+            p1 = p2;
+        }
+    }
+}
+
 /**
  * Dumps the spline's data to stdout.
  */
@@ -547,17 +733,63 @@ std::ostream& operator << (std::ostream& os, const RS_Spline& l) {
     return os;
 }
 
-RS_Vector RS_Spline::getNearestPointOnEntity(const RS_Vector &coord, bool onEntity, double *dist, RS_Entity **entity) const {
-    return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
-/*    RS_Vector point(false);
-
-    RS_Entity *en = getNearestEntity(coord, dist, RS2::ResolveNone);
+RS_Vector RS_Spline::getNearestPointOnEntity(const RS_Vector &coord, bool /*onEntity*/, double *dist, RS_Entity **entity) const {
+    // points on the entity are taken from the drawn polyline, if it's finer
+    const std::shared_ptr<const DrawnStroke> drawn = std::atomic_load(&m_drawnStroke);
+    const std::vector<RS_Vector>& points = (entitiesDeferred && drawn != nullptr && drawn->tolerance < m_strokeTolerance)
+                                           ? drawn->points : m_strokePoints;
+    RS_Vector point(false);
+    double minDist = RS_MAXDOUBLE;
+    for (size_t i = 1; i < points.size(); ++i) {
+        RS_Vector nearest;
+        const double d = distanceToSegment(coord, points[i - 1], points[i], &nearest);
+        if (d < minDist) {
+            minDist = d;
+            point = nearest;
+        }
+    }
+    if (dist) {
+        *dist = minDist;
+    }
+    if (entity) {
+        *entity = point.valid ? const_cast<RS_Spline*>(this) : nullptr;
+    }
+    return point;
+}
 
-    if (en && en->isVisible()
-        && !en->getParent()->ignoredSnap()
-        ) {
-        point = en->getNearestPointOnEntity(coord, onEntity, dist, entity);
+double RS_Spline::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const {
+    if (!entitiesDeferred) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
     }
 
-    return point;*/
+    double minDist = RS_MAXDOUBLE;
+    std::size_t nearest = 0;
+    if (isVisible()) {
+        for (size_t i = 1; i < m_strokePoints.size(); ++i) {
+            const double d = distanceToSegment(coord, m_strokePoints[i - 1], m_strokePoints[i]);
+            if (d < minDist) {
+                minDist = d;
+                nearest = i;
+            }
+        }
+    }
+    if (entity != nullptr) {
+        if (minDist == RS_MAXDOUBLE) {
+            *entity = nullptr;
+        } else if (level == RS2::ResolveAll || level == RS2::ResolveAllButTextImage) {
+            // the caller needs the individual line, e.g. for trimming or intersections. It gets a temporary
+            // segment, so the lines are not created, and the spline is still drawn by the zoom dependent polyline
+            m_nearestSegment.setParent(const_cast<RS_Spline*>(this));
+            m_nearestSegment.setLayer(nullptr);
+            m_nearestSegment.setPen(RS2::FlagInvalid);
+            m_nearestSegment.setFlag(RS2::FlagTemp);
+            m_nearestSegment.setStartpoint(m_strokePoints[nearest - 1]);
+            m_nearestSegment.setEndpoint(m_strokePoints[nearest]);
+            *entity = &m_nearestSegment;
+        } else {
+            *entity = const_cast<RS_Spline*>(this);
+        }
+    }
+    return minDist;
 }
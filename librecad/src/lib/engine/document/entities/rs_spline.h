@@ -28,8 +28,10 @@
 #ifndef RS_SPLINE_H
 #define RS_SPLINE_H
 
+#include <memory>
 #include <vector>
 #include "rs_entitycontainer.h"
+#include "rs_line.h"
 
 /**
  * Holds the data that defines a line.
@@ -111,6 +113,10 @@ public:
     RS_Vector getNearestSelectedRef( const RS_Vector& coord, double* dist = nullptr) const override;
 
     RS_Vector getNearestPointOnEntity(const RS_Vector &coord, bool onEntity, double *dist, RS_Entity **entity) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
 
     /** @return Start point of the entity */
     RS_Vector getStartpoint() const override;
@@ -150,9 +156,31 @@ public:
     const std::vector<RS_Vector>& getControlPoints() const;
     friend std::ostream& operator << (std::ostream& os, const RS_Spline& l);
     void calculateBorders() override;
+    unsigned count() const override;
+    unsigned countDeep() const override;
+    double getLength() const override;
     void fillStrokePoints(int splineSegments, std::vector<RS_Vector>& points);
+    /**
+     * @brief fillAdaptiveStrokePoints approximates the spline by a polyline, subdividing the knot spans
+     * until each segment deviates less than the tolerance from the curve
+     * @param tolerance - maximum distance of the curve from the polyline
+     * @param points - the resulting polyline
+     */
+    void fillAdaptiveStrokePoints(double tolerance, std::vector<RS_Vector>& points) const;
+    /** @return the cached polyline of the spline, used for drawing and snapping */
+    const std::vector<RS_Vector>& getStrokePoints() const {
+        return m_strokePoints;
+    }
     friend class RS_FilterDXFRW;
+protected:
+    void createDeferredEntities() override;
 private:
+    void wrapControlPoints();
+    /**
+     * @brief updateStrokePoints re-creates the cached polyline, if its tolerance is too coarse for the
+     * requested one, or much finer than needed
+     */
+    void updateStrokePoints(double tolerance);
     std::vector<double> knot(size_t num, size_t order) const;
     void rbspline(size_t npts, size_t k, size_t p1,
                   const std::vector<RS_Vector>& b,
@@ -175,6 +203,21 @@ private:
 
 protected:
     RS_SplineData data;
+
+private:
+    /** polyline approximating the spline, line entities are created from it on demand only */
+    std::vector<RS_Vector> m_strokePoints;
+    /** tolerance of the polyline, a power of 2 */
+    double m_strokeTolerance = 0.;
+    /** polyline refined for the zoom level of drawing, if the polyline is too coarse */
+    struct DrawnStroke {
+        double tolerance = 0.;
+        std::vector<RS_Vector> points;
+    };
+    /** replaced as a whole, as the tiles of a view are drawn concurrently */
+    std::shared_ptr<const DrawnStroke> m_drawnStroke;
+    /** segment of the polyline nearest to the last resolved distance query, while the lines are not created */
+    mutable RS_Line m_nearestSegment;
 };
 
 #endif
@@ -296,15 +296,14 @@ void RS_Text::update() {
             letterPos+=space;
         } else {
             // One Letter:
-            QString letterText = QString(data.text.at(i));
-            if (font->findLetter(letterText) == nullptr) {
-                RS_DEBUG->print("RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",qPrintable(letterText));
-                letterText = QChar(0xfffd);
+            const RS_Font::Glyph* glyph = font->findGlyph(data.text.at(i));
+            if (glyph == nullptr) {
+                continue;
             }
             RS_DEBUG->print("RS_Text::update: insert a "
                             "letter at pos: %f/%f", letterPos.x, letterPos.y);
 
-            RS_InsertData d(letterText,
+            RS_InsertData d(glyph->name,
                             letterPos,
                             RS_Vector(1.0, 1.0),
                             0.0,
@@ -312,13 +311,13 @@ void RS_Text::update() {
                             font->getLetterList(), RS2::NoUpdate);
 
             auto* letter = new RS_Insert(this, d);
-            RS_Vector letterWidth;
+            letter->setBlockForInsert(glyph->block);
             letter->setPen(RS_Pen(RS2::FlagInvalid));
             letter->setLayer(nullptr);
             letter->update();
-            letter->forcedCalculateBorders();
 
-            letterWidth = RS_Vector(letter->getMax().x-letterPos.x, 0.0);
+            // the letter is inserted unscaled, so its width is known from the glyph
+            RS_Vector letterWidth = RS_Vector(glyph->max.x, 0.0);
             if (letterWidth.x < 0) {
                 letterWidth.x = -letterSpace.x;
             }
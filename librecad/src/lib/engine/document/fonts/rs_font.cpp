@@ -25,6 +25,7 @@
 **********************************************************************/
 
 #include <iostream>
+#include <mutex>
 
 #include <QRegularExpression>
 #include <QStringConverter>
@@ -482,11 +483,36 @@ RS_Block* RS_Font::generateLffFont(const QString& key)
 }
 
 RS_Block* RS_Font::findLetter(const QString& name) {
+    // letters are generated by concurrent text updates
+    std::lock_guard<std::mutex> lock{letterMutex};
     RS_Block* ret= letterList.find(name);
     return (ret != nullptr) ? ret : generateLffFont(name);
 
 }
 
+const RS_Font::Glyph* RS_Font::findGlyph(QChar ch) {
+    std::lock_guard<std::mutex> lock{glyphMutex};
+    auto it = glyphs.find(ch.unicode());
+    if (it != glyphs.end()) {
+        return &it->second;
+    }
+
+    QString name{ch};
+    RS_Block* block = findLetter(name);
+    if (block == nullptr) {
+        RS_DEBUG->print("RS_Font::findGlyph: missing font for letter( %s ), replaced it with QChar(0xfffd)",
+                        qPrintable(name));
+        name = QChar(0xfffd);
+        block = findLetter(name);
+    }
+    if (block == nullptr) {
+        return nullptr;
+    }
+    const RS_Vector base = block->getBasePoint();
+    Glyph glyph{name, block, block->getMin() - base, block->getMax() - base};
+    return &glyphs.emplace(ch.unicode(), std::move(glyph)).first->second;
+}
+
 /**
  * Dumps the fonts data to stdout.
  */
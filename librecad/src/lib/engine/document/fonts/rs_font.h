@@ -28,9 +28,13 @@
 #ifndef RS_FONT_H
 #define RS_FONT_H
 
+#include <mutex>
+#include <unordered_map>
+
 #include <QStringList>
 #include <QMap>
 #include "rs_blocklist.h"
+#include "rs_vector.h"
 
 /**
  * Class for representing a font. This is implemented as a RS_Graphic
@@ -41,6 +45,17 @@
  */
 class RS_Font {
 public:
+    /**
+     * A letter of the font: the name and block of the letter, and its
+     * borders relative to the base point of the block.
+     */
+    struct Glyph {
+        QString name;
+        RS_Block* block = nullptr;
+        RS_Vector min;
+        RS_Vector max;
+    };
+
     RS_Font(const QString& name, bool owner=true);
     //RS_Font(const char* name);
 
@@ -97,7 +112,19 @@ public:
     RS_BlockList* getLetterList() {
         return &letterList;
     }
+    /**
+     * @brief findLetter the block of a letter, which is generated on the first use for LFF fonts.
+     * It's safe to call from concurrent text updates; the returned block is to be handed to the
+     * letter inserts, as the letter list itself isn't guarded.
+     */
     RS_Block* findLetter(const QString& name);
+    /**
+     * @brief findGlyph the letter of a char, or the replacement letter QChar(0xfffd), if the font has
+     * no such letter. Letters are resolved once, which may generate them; like findLetter(), it's
+     * safe to call from concurrent text updates.
+     * @return the glyph, which stays valid with the font, or nullptr
+     */
+    const Glyph* findGlyph(QChar ch);
     //    RS_Block* findLetter(const QString& name) {
     //		return letterList.find(name);
     //	}
@@ -123,6 +150,12 @@ private:
 
     //! block list (letters)
     RS_BlockList letterList;
+    //! guards finding and generating letters
+    std::mutex letterMutex;
+
+    //! letters resolved by findGlyph()
+    std::unordered_map<char16_t, Glyph> glyphs;
+    std::mutex glyphMutex;
 
     //! Font file name
     QString m_fileName;
@@ -25,6 +25,7 @@
 **********************************************************************/
 
 #include <iostream>
+
 #include <QHash>
 #include "rs_fontlist.h"
 #include "rs_debug.h"
@@ -51,6 +52,7 @@ void RS_FontList::init() {
     QStringList list = RS_SYSTEM->getNewFontList();
     list.append(RS_SYSTEM->getFontList());
     QHash<QString, int> added; //used to remember added fonts (avoid duplication)
+    requestedFonts.clear();
 
     for (int i = 0; i < list.size(); ++i) {
         RS_DEBUG->print(RS_Debug::D_ERROR, "font: %s:", list.at(i).toLatin1().data());
@@ -83,6 +85,8 @@ std::vector<std::unique_ptr<RS_Font> >::const_iterator RS_FontList::end() const
  * Removes all fonts in the fontlist.
  */
 void RS_FontList::clearFonts() {
+    std::lock_guard<std::mutex> lock{fontsMutex};
+    requestedFonts.clear();
 	fonts.clear();
 }
 
@@ -92,13 +96,35 @@ void RS_FontList::clearFonts() {
  * memory if it's not already.
  */
 RS_Font* RS_FontList::requestFont(const QString& name) {
-    RS_DEBUG->print("RS_FontList::requestFont %s",  name.toLatin1().data());
+    // requested for each text update, so the name is only converted for debugging
+    if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+        RS_DEBUG->print("RS_FontList::requestFont %s", name.toLatin1().data());
+    }
 
-    QString name2 = name.toLower();
-    RS_Font* foundFont = nullptr;
     if (name.isEmpty())
-        return foundFont;
+        return nullptr;
+
+    // fonts are requested by concurrent text updates, which must not load the same font twice
+    std::lock_guard<std::mutex> lock{fontsMutex};
+    RS_Font* foundFont = findFont(name);
+	if (!foundFont && name!="standard") {
+        foundFont = findFont("standard");
+    }
+
+    return foundFont;
+}
 
+/**
+ * @return the font with the given name, loaded into memory, or
+ * \p NULL if no such font was found. Names are resolved once.
+ */
+RS_Font* RS_FontList::findFont(const QString& name) {
+    auto it = requestedFonts.constFind(name);
+    if (it != requestedFonts.cend()) {
+        return it.value();
+    }
+
+    QString name2 = name.toLower();
     // QCAD 1 compatibility:
     if (name2.contains('#') && name2.contains('_')) {
         name2 = name2.left(name2.indexOf('_'));
@@ -108,6 +134,7 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
 
     RS_DEBUG->print("name2: %s", name2.toLatin1().data());
 
+    RS_Font* foundFont = nullptr;
 	// Search our list of available fonts:
 	for( auto const& f: fonts){
 
@@ -119,10 +146,7 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
         }
     }
 
-	if (!foundFont && name!="standard") {
-        foundFont = requestFont("standard");
-    }
-
+    requestedFonts.insert(name, foundFont);
     return foundFont;
 }
 
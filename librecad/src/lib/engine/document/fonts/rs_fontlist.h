@@ -26,9 +26,12 @@
 #ifndef RS_FONTLIST_H
 #define RS_FONTLIST_H
 #include <memory>
+#include <mutex>
 #include <vector>
 
-class QString;
+#include <QHash>
+#include <QString>
+
 class RS_Font;
 
 #define RS_FONTLIST RS_FontList::instance()
@@ -63,9 +66,13 @@ private:
     RS_FontList()=default;
     RS_FontList(RS_FontList const&)=delete;
     RS_FontList& operator = (RS_FontList const&)=delete;
+    RS_Font* findFont(const QString& name);
     static RS_FontList* uniqueInstance;
     //! fonts in the graphic
     std::vector<std::unique_ptr<RS_Font>> fonts;
+    //! fonts found by the requested names, including the names without a font
+    QHash<QString, RS_Font*> requestedFonts;
+    std::mutex fontsMutex;
 };
 
 #endif
@@ -49,9 +49,18 @@ RS_Layer* RS_Layer::clone() const{
 	return new RS_Layer(*this);
 }
 
+std::atomic<unsigned long> RS_Layer::renameCount{0};
+
 /** sets a new name for this layer. */
 void RS_Layer::setName(const QString& name) {
-	data.name = name;
+	if (data.name != name) {
+		data.name = name;
+		++renameCount;
+	}
+}
+
+unsigned long RS_Layer::getRenameCount() {
+	return renameCount;
 }
 
 /** @return the name of this layer. */
@@ -33,6 +33,7 @@
 #include <sys/_size_t.h>
 #endif
 
+#include <atomic>
 #include <iosfwd>
 
 #include "rs_pen.h"
@@ -195,11 +196,19 @@ public:
      */
 	bool setConstruction( const bool construction);
 
+    /**
+     * @return number of layer renames so far. Layer lists index layers by name, and rebuild
+     * the index when a layer was renamed outside of the list.
+     */
+    static unsigned long getRenameCount();
+
     friend std::ostream& operator << (std::ostream& os, const RS_Layer& l);
 
 private:
     //! Layer data
     RS_LayerData data;
+    //! number of layer renames
+    static std::atomic<unsigned long> renameCount;
 
 };
 
@@ -47,6 +47,7 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     layers.clear();
+    layersByName.clear();
     setModified(true);
 }
 
@@ -155,6 +156,7 @@ void RS_LayerList::add(RS_Layer* layer) {
     RS_Layer* l = find(layer->getName());
     if (l==nullptr) {
         layers.append(layer);
+        layersByName.insert(layer->getName(), layer);
         this->sort();
         // notify listeners
         for (int i=0; i<layerListListeners.size(); ++i) {
@@ -201,6 +203,7 @@ void RS_LayerList::remove(RS_Layer* layer) {
 
     // here the layer is removed from the list but not deleted
     layers.removeOne(layer);
+    rebuildIndex();
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
@@ -231,6 +234,7 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
     }
 
     *layer = source;
+    rebuildIndex();
 
     fireEdit(layer);
 }
@@ -252,21 +256,11 @@ void RS_LayerList::fireEdit(RS_Layer* layer) {
  * \p nullptr if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    RS_Layer* ret = nullptr;
-
-    for (int i=0; i<layers.size(); ++i) {
-        RS_Layer* l = layers.at(i);
-        if (l->getName()==name) {
-            ret = l;
-            break;
-        }
+    // layers may be renamed directly, bypassing the list
+    if (indexedRenameCount != RS_Layer::getRenameCount()) {
+        rebuildIndex();
     }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    return layersByName.value(name, nullptr);
 }
 
 
@@ -276,22 +270,21 @@ RS_Layer* RS_LayerList::find(const QString& name) {
  * was not found.
  */
 int RS_LayerList::getIndex(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
+    RS_Layer* layer = find(name);
+    return (layer != nullptr) ? layers.indexOf(layer) : -1;
+}
 
-    int ret = -1;
 
-    for (int i=0; i<layers.size(); i++) {
-        RS_Layer* l = layers.at(i);
 
-        if (l->getName()==name) {
-            ret = i;
-            break;
+void RS_LayerList::rebuildIndex() {
+    indexedRenameCount = RS_Layer::getRenameCount();
+    layersByName.clear();
+    layersByName.reserve(layers.size());
+    for (RS_Layer* l: layers) {
+        if (!layersByName.contains(l->getName())) {
+            layersByName.insert(l->getName(), l);
         }
     }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
 }
 
 
@@ -29,7 +29,9 @@
 #ifndef RS_LAYERLIST_H
 #define RS_LAYERLIST_H
 
+#include <QHash>
 #include <QList>
+#include <QString>
 
 class RS_Layer;
 class RS_LayerListListener;
@@ -142,8 +144,16 @@ public:
 private:
 
     void fireLayerToggled();
+    /**
+     * @brief rebuildIndex recreates the name index, in list order: for equal names, the first layer is found
+     */
+    void rebuildIndex();
 	//! layers in the graphic
     QList<RS_Layer*> layers;
+    //! layers by name
+    QHash<QString, RS_Layer*> layersByName;
+    //! layer renames included in the name index
+    unsigned long indexedRenameCount = 0;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> layerListListeners;
     QG_LayerWidget *layerWidget = nullptr;
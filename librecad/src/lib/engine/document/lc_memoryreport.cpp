@@ -0,0 +1,176 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <map>
+
+#include <QString>
+
+#include "lc_memoryreport.h"
+#include "lc_objectpool.h"
+#include "lc_splinepoints.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_circle.h"
+#include "rs_constructionline.h"
+#include "rs_ellipse.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_image.h"
+#include "rs_insert.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+struct TypeUsage {
+    const char* name = nullptr;
+    std::size_t objectSize = 0;
+    std::size_t count = 0;
+};
+
+struct Usage {
+    std::map<RS2::EntityType, TypeUsage> types;
+    std::size_t entities = 0;
+    std::size_t deferredContainers = 0;
+    std::size_t userVariables = 0;
+};
+
+// the class and the object size of the types frequent in large drawings
+TypeUsage typeUsage(RS2::EntityType type)
+{
+    switch (type) {
+        case RS2::EntityPoint:
+            return {"RS_Point", sizeof(RS_Point)};
+        case RS2::EntityLine:
+            return {"RS_Line", sizeof(RS_Line)};
+        case RS2::EntityArc:
+            return {"RS_Arc", sizeof(RS_Arc)};
+        case RS2::EntityCircle:
+            return {"RS_Circle", sizeof(RS_Circle)};
+        case RS2::EntityEllipse:
+            return {"RS_Ellipse", sizeof(RS_Ellipse)};
+        case RS2::EntityConstructionLine:
+            return {"RS_ConstructionLine", sizeof(RS_ConstructionLine)};
+        case RS2::EntitySolid:
+            return {"RS_Solid", sizeof(RS_Solid)};
+        case RS2::EntityPolyline:
+            return {"RS_Polyline", sizeof(RS_Polyline)};
+        case RS2::EntityInsert:
+            return {"RS_Insert", sizeof(RS_Insert)};
+        case RS2::EntityBlock:
+            return {"RS_Block", sizeof(RS_Block)};
+        case RS2::EntityContainer:
+            return {"RS_EntityContainer", sizeof(RS_EntityContainer)};
+        case RS2::EntityHatch:
+            return {"RS_Hatch", sizeof(RS_Hatch)};
+        case RS2::EntityText:
+            return {"RS_Text", sizeof(RS_Text)};
+        case RS2::EntityMText:
+            return {"RS_MText", sizeof(RS_MText)};
+        case RS2::EntitySpline:
+            return {"RS_Spline", sizeof(RS_Spline)};
+        case RS2::EntitySplinePoints:
+            return {"LC_SplinePoints", sizeof(LC_SplinePoints)};
+        case RS2::EntityImage:
+            return {"RS_Image", sizeof(RS_Image)};
+        default:
+            return {nullptr, 0};
+    }
+}
+
+void collect(const RS_Entity& entity, Usage& usage)
+{
+    auto it = usage.types.find(entity.rtti());
+    if (it == usage.types.end()) {
+        it = usage.types.emplace(entity.rtti(), typeUsage(entity.rtti())).first;
+    }
+    ++it->second.count;
+    ++usage.entities;
+    if (!entity.getAllKeys().empty()) {
+        ++usage.userVariables;
+    }
+    if (!entity.isContainer()) {
+        return;
+    }
+    const auto& container = static_cast<const RS_EntityContainer&>(entity);
+    if (container.hasDeferredEntities()) {
+        ++usage.deferredContainers;
+        return;
+    }
+    for (const RS_Entity* child: container) {
+        collect(*child, usage);
+    }
+}
+}
+
+namespace LC_MemoryReport {
+QString create(RS_Graphic& graphic)
+{
+    Usage usage;
+    for (const RS_Entity* entity: graphic) {
+        collect(*entity, usage);
+    }
+    for (const RS_Block* block: *graphic.getBlockList()) {
+        collect(*block, usage);
+    }
+
+    QString report = QString{"Memory report: %1 entities, %2 containers with deferred entities, "
+                             "%3 entities with user variables\n"}
+                         .arg(usage.entities).arg(usage.deferredContainers).arg(usage.userVariables);
+    std::size_t knownBytes = 0;
+    for (const auto& [type, typeUsage]: usage.types) {
+        const QString name = typeUsage.name != nullptr ? QString{typeUsage.name}
+                                                       : QString{"entity type %1"}.arg(static_cast<unsigned>(type));
+        const QString size = typeUsage.name != nullptr ? QString::number(typeUsage.objectSize) : QString{"?"};
+        report += QString{"  %1: %2 x %3 bytes\n"}.arg(name).arg(typeUsage.count).arg(size);
+        knownBytes += typeUsage.count * typeUsage.objectSize;
+    }
+    report += QString{"  entity objects of known size: %1 KiB\n"}.arg(knownBytes / 1024);
+    for (const LC_ObjectPool::Statistics& pool: LC_ObjectPool::getAllStatistics()) {
+        report += QString{"  pool %1: %2 objects of %3 bytes, %4 KiB reserved\n"}
+                      .arg(pool.name).arg(pool.liveObjects).arg(pool.objectSize).arg(pool.reservedBytes / 1024);
+    }
+    return report;
+}
+
+std::size_t estimateSize(const RS_Entity& entity)
+{
+    // types missing in the report are estimated as large as a container
+    const std::size_t objectSize = typeUsage(entity.rtti()).objectSize;
+    std::size_t size = objectSize != 0 ? objectSize : sizeof(RS_EntityContainer);
+    if (entity.isContainer()) {
+        const auto& container = static_cast<const RS_EntityContainer&>(entity);
+        if (!container.hasDeferredEntities()) {
+            for (const RS_Entity* child: container) {
+                size += estimateSize(*child);
+            }
+        }
+    }
+    return size;
+}
+}
@@ -0,0 +1,51 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_MEMORYREPORT_H
+#define LC_MEMORYREPORT_H
+
+#include <cstddef>
+
+class QString;
+class RS_Entity;
+class RS_Graphic;
+
+/**
+ * Memory accounting of a drawing: entity counts and sizes by type, and the usage of the entity pools.
+ * Printed after opening a file with the informational debug level, so drawings may be compared between versions.
+ */
+namespace LC_MemoryReport {
+    /**
+     * @brief create the report of the entities of the graphic and its blocks. Children of containers, which
+     *        defer creating them, are not created for the report.
+     */
+    QString create(RS_Graphic& graphic);
+
+    /**
+     * @brief estimateSize the object sizes of the entity and its children; children of containers, which defer
+     *        creating them, aren't created for the estimate
+     */
+    std::size_t estimateSize(const RS_Entity& entity);
+}
+
+#endif // LC_MEMORYREPORT_H
@@ -0,0 +1,125 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <atomic>
+
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "lc_regenscheduler.h"
+#include "lc_trace.h"
+#include "rs_debug.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+
+namespace {
+bool isIndependent(const RS_Entity* entity)
+{
+    switch (entity->rtti()) {
+        case RS2::EntityText:
+        case RS2::EntityMText:
+        case RS2::EntityHatch:
+            return true;
+        default:
+            return false;
+    }
+}
+}
+
+void LC_RegenScheduler::add(RS_Entity* entity)
+{
+    if (entity == nullptr) {
+        return;
+    }
+    if (isIndependent(entity)) {
+        m_concurrent.push_back(entity);
+    } else {
+        m_sequential.push_back(entity);
+    }
+}
+
+void LC_RegenScheduler::clear()
+{
+    m_concurrent.clear();
+    m_sequential.clear();
+}
+
+std::size_t LC_RegenScheduler::size() const
+{
+    return m_concurrent.size() + m_sequential.size();
+}
+
+void LC_RegenScheduler::run()
+{
+    LC_TRACE_ZONE("regen", "regenScheduler");
+    RS_DEBUG->print("LC_RegenScheduler::run: %zu concurrent, %zu sequential updates", m_concurrent.size(),
+                    m_sequential.size());
+
+    // updated entities re-index themselves in the spatial index of the parent, which is rebuilt instead
+    std::vector<RS_EntityContainer*> parents;
+    for (const std::vector<RS_Entity*>* entities: {&m_concurrent, &m_sequential}) {
+        for (RS_Entity* entity: *entities) {
+            RS_EntityContainer* parent = entity->getParent();
+            if (parent != nullptr && std::find(parents.cbegin(), parents.cend(), parent) == parents.cend()) {
+                parents.push_back(parent);
+                parent->invalidateSpatialIndex();
+            }
+        }
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto updateEntities = [this, &next]() {
+        for (std::size_t i = next++; i < m_concurrent.size(); i = next++) {
+            m_concurrent[i]->update();
+        }
+    };
+    QThreadPool* pool = QThreadPool::globalInstance();
+    const int workers = std::min(pool->maxThreadCount(), static_cast<int>(m_concurrent.size())) - 1;
+    QSemaphore finished;
+    int started = 0;
+    for (; started < workers; ++started) {
+        if (!pool->tryStart([&updateEntities, &finished]() {
+            updateEntities();
+            finished.release();
+        })) {
+            break;
+        }
+    }
+    updateEntities();
+    finished.acquire(started);
+
+    for (RS_Entity* entity: m_sequential) {
+        entity->update();
+    }
+
+    // the borders of the parents only grow, as the entities were added before they were updated
+    for (const std::vector<RS_Entity*>* entities: {&m_concurrent, &m_sequential}) {
+        for (RS_Entity* entity: *entities) {
+            if (entity->getParent() != nullptr) {
+                entity->getParent()->adjustBorders(entity);
+            }
+        }
+    }
+    clear();
+}
@@ -0,0 +1,64 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_REGENSCHEDULER_H
+#define LC_REGENSCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+
+class RS_Entity;
+
+/**
+ * @brief The LC_RegenScheduler class, collects entities, which need an update() after they are read, and updates
+ * them at once.
+ *
+ * Texts and hatches depend only on their own data, the fonts and the patterns, so they are updated concurrently by
+ * the global thread pool. Dimensions and leaders read, and may add, the dimension variables of the document, so they
+ * are updated by the calling thread afterwards. Inserts are updated after the scheduler ran, so they see the updated
+ * entities of their blocks.
+ */
+class LC_RegenScheduler {
+public:
+    /**
+     * @brief add an entity to update; the entity should already be added to its parent container
+     */
+    void add(RS_Entity* entity);
+
+    /**
+     * @brief run update the collected entities, then the borders of their parent containers
+     */
+    void run();
+
+    /**
+     * @brief clear drop the collected entities without updating them
+     */
+    void clear();
+    std::size_t size() const;
+
+private:
+    std::vector<RS_Entity*> m_concurrent;
+    std::vector<RS_Entity*> m_sequential;
+};
+
+#endif // LC_REGENSCHEDULER_H
@@ -25,6 +25,7 @@
 **********************************************************************/
 
 #include<iostream>
+#include<mutex>
 #include<QString>
 
 #include "rs_debug.h"
@@ -72,10 +73,19 @@ void RS_PatternList::init() {
  * memory if it's not already.
  */
 std::unique_ptr<RS_Pattern> RS_PatternList::requestPattern(const QString& name) {
-    RS_DEBUG->print("RS_PatternList::requestPattern %s", name.toLatin1().data());
+    // requested for each hatch update, so the names are only converted for debugging
+    const bool debugging = RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING;
+    if (debugging) {
+        RS_DEBUG->print("RS_PatternList::requestPattern %s", name.toLatin1().data());
+    }
 
     QString name2 = name.toLower();
-    RS_DEBUG->print("Pattern: name2: %s", name2.toLatin1().data());
+    if (debugging) {
+        RS_DEBUG->print("Pattern: name2: %s", name2.toLatin1().data());
+    }
+    // patterns are requested by concurrent hatch updates
+    static std::mutex patternsMutex;
+    std::lock_guard<std::mutex> lock{patternsMutex};
     if (patterns.count(name2) == 0 || patterns.at(name2) == nullptr) {
         auto p = std::make_unique<RS_Pattern>(name2);
         if (p!=nullptr) {
@@ -95,8 +105,10 @@ std::unique_ptr<RS_Pattern> RS_PatternList::requestPattern(const QString& name)
     }
 
     if (patterns.count(name2) == 1) {
-        RS_DEBUG->print("name2: %s, size= %d", name2.toLatin1().data(),
-                        patterns[name2]->countDeep());
+        if (debugging) {
+            RS_DEBUG->print("name2: %s, size= %d", name2.toLatin1().data(),
+                            patterns[name2]->countDeep());
+        }
         return std::unique_ptr<RS_Pattern>{static_cast<RS_Pattern*>(patterns[name2]->clone())};
 	}
 
@@ -79,6 +79,20 @@ public:
         }
     }
 
+    /**
+     * Removes entities from the entity container in one pass. Implementation
+     * from RS_Undo.
+     */
+    void removeUndoables(const std::vector<RS_Undoable*>& undoables) override {
+        std::vector<RS_Entity*> toRemove;
+        for (RS_Undoable* u: undoables) {
+            if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
+                toRemove.push_back(static_cast<RS_Entity*>(u));
+            }
+        }
+        removeEntities(toRemove);
+    }
+
     /**
      * @return Currently active drawing pen.
      */
@@ -100,6 +114,11 @@ public:
      */
     QString getAutoSaveFilename() const {return autosaveFilename;}
 
+    /**
+     * @return Format of the file of the document, or RS2::FormatUnknown for a new document.
+     */
+    RS2::FormatType getFormatType() const {return formatType;}
+
     /**
      * Sets file name for the document currently loaded.
      */
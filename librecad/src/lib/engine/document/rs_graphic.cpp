@@ -45,6 +45,7 @@
 #include "rs_settings.h"
 #include "rs_units.h"
 #include "lc_graphicviewport.h"
+#include "lc_memoryreport.h"
 
 /**
  * Default constructor.
@@ -139,6 +140,7 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
     if (layer != nullptr) {
         const QString &layerName = layer->getName();
         if (layerName != "0") {
+            RS_Layer* layer0 = findLayer("0");
             std::vector<RS_Entity *> toRemove;
 //find entities on layer
             for (RS_Entity *e: entities) {
@@ -152,7 +154,7 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
                 startUndoCycle();
                 for (RS_Entity *e: toRemove) {
                     e->setUndoState(true);
-                    e->setLayer("0");
+                    e->setLayer(layer0);
                     addUndoable(e);
                 }
                 endUndoCycle();
@@ -172,7 +174,7 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 
             for (RS_Entity *e: toRemove) {
                 e->setUndoState(true);
-                e->setLayer("0");
+                e->setLayer(layer0);
             }
 
             layerList.remove(layer);
@@ -540,6 +542,10 @@ bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
         //calculateBorders();
 
         RS_DEBUG->print("RS_Graphic::open(%s): OK", filename.toLatin1().data());
+        if (RS_DEBUG->getLevel() >= RS_Debug::D_INFORMATIONAL) {
+            RS_DEBUG->print(RS_Debug::D_INFORMATIONAL, "%s",
+                            LC_MemoryReport::create(*this).toLatin1().data());
+        }
     }
     return ret;
 }
@@ -1011,6 +1017,13 @@ void RS_Graphic::addEntity(RS_Entity *entity) {
     }
 }
 
+void RS_Graphic::updateInserts() {
+    for (RS_Block* blk: blockList) {
+        blk->setInsertsUpdated(false);
+    }
+    RS_EntityContainer::updateInserts();
+}
+
 /**
  * Dumps the entities to stdout.
  */
@@ -1030,7 +1043,7 @@ std::ostream& operator << (std::ostream& os, RS_Graphic& g) {
 int RS_Graphic::clean() {
     // author: ravas
 
-    int how_many = 0;
+    std::vector<RS_Entity *> toRemove;
 
         foreach (RS_Entity *e, entities) {
             const RS_Vector &min = e->getMin();
@@ -1045,11 +1058,10 @@ int RS_Graphic::clean() {
                 || max.y > RS_MAXDOUBLE
                 || min.y < RS_MINDOUBLE
                 || max.y < RS_MINDOUBLE) {
-                removeEntity(e);
-                how_many += 1;
+                toRemove.push_back(e);
             }
         }
-    return how_many;
+    return static_cast<int>(removeEntities(toRemove));
 }
 
 /**
@@ -70,6 +70,10 @@ public:
     RS_Layer* getActiveLayer() {return layerList.getActive();}
     virtual void addLayer(RS_Layer* layer) {layerList.add(layer);}
     void addEntity(RS_Entity* entity) override;
+    /**
+     * Updates the inserts of the drawing; the inserts of the blocks are updated again, once per block.
+     */
+    void updateInserts() override;
     virtual void removeLayer(RS_Layer* layer);
     virtual void editLayer(RS_Layer* layer, const RS_Layer& source) {layerList.edit(layer, source);}
     RS_Layer* findLayer(const QString& name) {return layerList.find(name);}
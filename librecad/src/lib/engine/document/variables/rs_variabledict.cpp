@@ -173,7 +173,9 @@ QString RS_VariableDict::getString(const QString& key, const QString& def) const
 {
     QString ret;
 
-    RS_DEBUG->print("RS_VariableDict::getString: key: '%s'", key.toLatin1().data());
+    if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+        RS_DEBUG->print("RS_VariableDict::getString: key: '%s'", key.toLatin1().data());
+    }
 
 	auto i = variables.find(key);
     if (variables.end() != i && RS2::VariableString == i.value().getType()) {
@@ -0,0 +1,67 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_COMPACTVECTOR_H
+#define LC_COMPACTVECTOR_H
+
+#include <cmath>
+#include <limits>
+
+#include "rs_vector.h"
+
+/**
+ * @brief The LC_CompactVector class, a 2D point stored in 16 bytes, used for the borders of entities.
+ *
+ * RS_Vector keeps a z coordinate and a validity flag, which doubles the size. Here an invalid point is stored
+ * as NaN coordinates, so the point converts to and from RS_Vector without loss for 2D values.
+ */
+class LC_CompactVector {
+public:
+    LC_CompactVector() = default;
+
+    LC_CompactVector(const RS_Vector& v):
+        x{v.valid ? v.x : std::numeric_limits<double>::quiet_NaN()}
+      , y{v.valid ? v.y : std::numeric_limits<double>::quiet_NaN()}
+    {}
+
+    operator RS_Vector() const
+    {
+        return isValid() ? RS_Vector{x, y} : RS_Vector{false};
+    }
+
+    bool isValid() const
+    {
+        return !std::isnan(x) && !std::isnan(y);
+    }
+
+    void set(double vx, double vy)
+    {
+        x = vx;
+        y = vy;
+    }
+
+    double x = std::numeric_limits<double>::quiet_NaN();
+    double y = std::numeric_limits<double>::quiet_NaN();
+};
+
+#endif // LC_COMPACTVECTOR_H
@@ -0,0 +1,99 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <cmath>
+
+#include "lc_previewtransform.h"
+#include "rs.h"
+
+LC_PreviewTransform::LC_PreviewTransform(const RS_Vector& origin, const RS_Vector& unitX, const RS_Vector& unitY,
+                                         double scale):
+    m_origin{origin}
+    , m_unitX{unitX}
+    , m_unitY{unitY}
+    , m_scale{scale}
+{
+}
+
+LC_PreviewTransform LC_PreviewTransform::move(const RS_Vector& offset)
+{
+    return {RS_Vector{0., 0.} + offset, RS_Vector{1., 0.} + offset, RS_Vector{0., 1.} + offset, 1.};
+}
+
+LC_PreviewTransform LC_PreviewTransform::rotate(const RS_Vector& center, double angle)
+{
+    return {RS_Vector{0., 0.}.rotate(center, angle), RS_Vector{1., 0.}.rotate(center, angle),
+            RS_Vector{0., 1.}.rotate(center, angle), 1.};
+}
+
+LC_PreviewTransform LC_PreviewTransform::scale(const RS_Vector& center, double factor)
+{
+    const RS_Vector factors{factor, factor};
+    return {RS_Vector{0., 0.}.scale(center, factors), RS_Vector{1., 0.}.scale(center, factors),
+            RS_Vector{0., 1.}.scale(center, factors), std::abs(factor)};
+}
+
+LC_PreviewTransform LC_PreviewTransform::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
+{
+    return {RS_Vector{0., 0.}.mirror(axisPoint1, axisPoint2), RS_Vector{1., 0.}.mirror(axisPoint1, axisPoint2),
+            RS_Vector{0., 1.}.mirror(axisPoint1, axisPoint2), 1.};
+}
+
+LC_PreviewTransform LC_PreviewTransform::then(const LC_PreviewTransform& other) const
+{
+    return {other.map(m_origin), other.map(m_unitX), other.map(m_unitY), m_scale * other.m_scale};
+}
+
+LC_PreviewTransform LC_PreviewTransform::inverted() const
+{
+    const RS_Vector u = m_unitX - m_origin;
+    const RS_Vector v = m_unitY - m_origin;
+    const double det = u.x * v.y - u.y * v.x;
+    if (std::abs(det) < RS_TOLERANCE2) {
+        return {};
+    }
+    // rows of the inverse of the matrix with the columns u and v
+    const RS_Vector invX{v.y / det, -v.x / det};
+    const RS_Vector invY{-u.y / det, u.x / det};
+    auto inverse = [&](const RS_Vector& point) {
+        const RS_Vector d = point - m_origin;
+        return RS_Vector{invX.x * d.x + invX.y * d.y, invY.x * d.x + invY.y * d.y};
+    };
+    return {inverse({0., 0.}), inverse({1., 0.}), inverse({0., 1.}), m_scale > RS_TOLERANCE ? 1. / m_scale : 1.};
+}
+
+RS_Vector LC_PreviewTransform::map(const RS_Vector& point) const
+{
+    return m_origin + (m_unitX - m_origin) * point.x + (m_unitY - m_origin) * point.y;
+}
+
+bool LC_PreviewTransform::isMirroring() const
+{
+    return RS_Vector::crossP(m_unitX - m_origin, m_unitY - m_origin).z < 0.;
+}
+
+bool LC_PreviewTransform::isTranslation() const
+{
+    return (m_unitX - m_origin - RS_Vector{1., 0.}).squared() < RS_TOLERANCE2
+           && (m_unitY - m_origin - RS_Vector{0., 1.}).squared() < RS_TOLERANCE2;
+}
@@ -0,0 +1,69 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_PREVIEWTRANSFORM_H
+#define LC_PREVIEWTRANSFORM_H
+
+#include "rs_vector.h"
+
+/**
+ * @brief The LC_PreviewTransform class, a similarity transform of the world, previewed by drawing entities through
+ *        a transform of the painter instead of cloning them.
+ *
+ * The transform is given by the images of the origin and of the points (1, 0) and (0, 1), as the instance transforms
+ * of RS_Painter. It's built from the same modifications of points, which the actions apply to the entities.
+ */
+class LC_PreviewTransform {
+public:
+    LC_PreviewTransform() = default;
+
+    static LC_PreviewTransform move(const RS_Vector& offset);
+    static LC_PreviewTransform rotate(const RS_Vector& center, double angle);
+    static LC_PreviewTransform scale(const RS_Vector& center, double factor);
+    static LC_PreviewTransform mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
+
+    /** @return the transform, which applies this transform and then the other one */
+    LC_PreviewTransform then(const LC_PreviewTransform& other) const;
+    /** @return the inverse transform */
+    LC_PreviewTransform inverted() const;
+
+    RS_Vector map(const RS_Vector& point) const;
+
+    const RS_Vector& getOrigin() const {return m_origin;}
+    const RS_Vector& getUnitX() const {return m_unitX;}
+    const RS_Vector& getUnitY() const {return m_unitY;}
+    double getScale() const {return m_scale;}
+    bool isMirroring() const;
+    // true, if the transform only moves points
+    bool isTranslation() const;
+
+private:
+    LC_PreviewTransform(const RS_Vector& origin, const RS_Vector& unitX, const RS_Vector& unitY, double scale);
+
+    RS_Vector m_origin{0., 0.};
+    RS_Vector m_unitX{1., 0.};
+    RS_Vector m_unitY{0., 1.};
+    double m_scale = 1.;
+};
+
+#endif // LC_PREVIEWTRANSFORM_H
@@ -28,6 +28,7 @@
 #include "rs_graphicview.h"
 #include "rs_information.h"
 #include "rs_line.h"
+#include "rs_painter.h"
 #include "rs_preview.h"
 #include "settings/rs_settings.h"
 
@@ -131,6 +132,8 @@ void RS_Preview::clear() {
     } else {
         referenceEntities.clear();
     }
+    transformedEntities.clear();
+    transforms.clear();
     RS_EntityContainer::clear();
 }
 
@@ -205,6 +208,36 @@ void RS_Preview::addStretchablesFrom(RS_EntityContainer& container, [[maybe_unus
     }
 }
 
+std::vector<RS_Entity*> RS_Preview::addTransformedEntities(const std::vector<RS_Entity*>& entities,
+                                                           const std::vector<LC_PreviewTransform>& transforms) {
+    std::vector<RS_Entity*> cloned;
+    if (transforms.empty()) {
+        return cloned;
+    }
+    bool mirroring = false;
+    bool translation = true;
+    for (const LC_PreviewTransform& transform: transforms) {
+        mirroring = mirroring || transform.isMirroring();
+        translation = translation && transform.isTranslation();
+    }
+
+    transformedEntities.clear();
+    for (RS_Entity* e: entities) {
+        if (e == nullptr || e->isUndone()) {
+            continue;
+        }
+        const RS2::EntityType rtti = e->rtti();
+        const bool isText = rtti == RS2::EntityText || rtti == RS2::EntityMText;
+        if ((isText && mirroring) || (RS_Information::isDimension(rtti) && !translation)) {
+            cloned.push_back(e);
+        } else {
+            transformedEntities.push_back(e);
+        }
+    }
+    this->transforms = transforms;
+    return cloned;
+}
+
 void RS_Preview::draw(RS_Painter* painter) {
 //    bool drawTextsAsDraftsForPreview = view->isDrawTextsAsDraftForPreview();
 // fixme - ucs - achieve view - store as field? This temporary for compilation...
@@ -231,6 +264,12 @@ void RS_Preview::draw(RS_Painter* painter) {
                 e->draw(painter);
         }
     }
+
+    if (!transformedEntities.empty()) {
+        for (const LC_PreviewTransform& transform: transforms) {
+            painter->drawTransformed(transformedEntities, transform);
+        }
+    }
 }
 
 void RS_Preview::addReferenceEntitiesToContainer(RS_EntityContainer *container){
@@ -28,6 +28,9 @@
 #ifndef RS_PREVIEW_H
 #define RS_PREVIEW_H
 
+#include <vector>
+
+#include "lc_previewtransform.h"
 #include "rs_entitycontainer.h"
 
 /**
@@ -49,6 +52,18 @@ public:
     void addAllFrom(RS_EntityContainer& container, LC_GraphicViewport* view);
     void addStretchablesFrom(RS_EntityContainer& container, LC_GraphicViewport* view,
                                      const RS_Vector& v1, const RS_Vector& v2);
+    /**
+     * Previews the entities mapped by each of the transforms, one transform per copy, without cloning them: the
+     * entities are drawn through the transform of the painter, with all details and without the limit of entities.
+     * The entities must not change while they are previewed.
+     *
+     * @return entities, which can't be drawn through the transforms, as their modified clones differ from the
+     *         transformed entities (texts stay readable when mirrored, dimensions are measured again and keep
+     *         their texts readable, unless they are only moved).
+     *         These are left to the caller, to be previewed by clones.
+     */
+    std::vector<RS_Entity*> addTransformedEntities(const std::vector<RS_Entity*>& entities,
+                                                   const std::vector<LC_PreviewTransform>& transforms);
     void draw(RS_Painter* painter) override;
     void addReferenceEntitiesToContainer(RS_EntityContainer* container);
     void clear() override;
@@ -56,5 +71,8 @@ public:
 private:
     unsigned int maxEntities = 0;
     QList<RS_Entity*> referenceEntities;
+    // entities of the document previewed through the transforms, not owned
+    std::vector<RS_Entity*> transformedEntities;
+    std::vector<LC_PreviewTransform> transforms;
 };
 #endif
@@ -1023,6 +1023,7 @@ namespace RS2 {
                 RedrawGrid = 1,
                 RedrawOverlay = 2,
                 RedrawDrawing = 4,
+                RedrawViewport = 8, // only the viewport changed, a panned drawing may be scrolled
                 RedrawAll = 0xffff
         };
 
@@ -67,7 +67,6 @@ void RS_Settings::init(const QString &companyKey,const QString &appKey) {
 
 RS_Settings::RS_Settings(QSettings *qsettings) {
     settings = qsettings;
-    m_group = "";
 }
 
 RS_Settings::~RS_Settings() {
@@ -153,19 +152,23 @@ QString RS_Settings::readStr(const QString &key,const QString &def) {
 
 bool RS_Settings::writeEntrySingle(const QString& group, const QString &key, const QVariant &value) {
     QString fullName = getFullName(group, key);
+    QVariant ret;
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
 
-    // Skip writing operations if the key is found in the cache and
-    // its value is the same as the new one (it was already written).
+        // Skip writing operations if the key is found in the cache and
+        // its value is the same as the new one (it was already written).
 
-    QVariant ret = readEntryCache(fullName);
-    if (ret.isValid() && ret == value) {
-        return true;
-    }
+        ret = readEntryCache(fullName);
+        if (ret.isValid() && ret == value) {
+            return true;
+        }
 
-    // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
+        // RVT_PORT not supported anymore s.insertSearchPath(QSettings::Windows, companyKey);
 
-    settings->setValue(fullName, value);
-    cache[fullName] = value;
+        settings->setValue(fullName, value);
+        cache[fullName] = value;
+    }
 
     // basically, that's a shortcut that we put value from cache as old value (instead of actual reading of it).
     // however, in most cases, properties will be read before modification, so that's fine
@@ -176,6 +179,7 @@ bool RS_Settings::writeEntrySingle(const QString& group, const QString &key, con
 
 QString RS_Settings::readStrSingle(const QString& group, const QString &key,const QString &def) {
     QString fullName = getFullName(group, key);
+    std::lock_guard<std::mutex> lock{m_mutex};
     QVariant value = readEntryCache(fullName);
     if (!value.isValid()) {
         value = settings->value(fullName, QVariant(def)).toString();
@@ -191,6 +195,7 @@ int RS_Settings::readColor(const QString &key, int def) {
 
 int RS_Settings::readColorSingle(const QString& group, const QString &key, int def) {
     QString fullName = getFullName(group, key);
+    std::lock_guard<std::mutex> lock{m_mutex};
     QVariant value = readEntryCache(fullName);
     if (!value.isValid()) {
         value = settings->value(fullName, QVariant(def));
@@ -208,6 +213,7 @@ int RS_Settings::readInt(const QString &key, int def) {
 
 int RS_Settings::readIntSingle(const QString& group, const QString &key, int def) {
     QString fullName = getFullName(group, key);
+    std::lock_guard<std::mutex> lock{m_mutex};
     QVariant value = readEntryCache(fullName);
     if (!value.isValid()) {
         value = settings->value(fullName, QVariant(def));
@@ -223,9 +229,11 @@ QByteArray RS_Settings::readByteArray(const QString &key) {
 
 QByteArray RS_Settings::readByteArraySingle(const QString& group, const QString &key) {
     QString fullName = getFullName(group, key);
+    std::lock_guard<std::mutex> lock{m_mutex};
     return settings->value(fullName, "").toByteArray();
 }
 
+// the caller holds m_mutex
 QVariant RS_Settings::readEntryCache(const QString &key) {
     if (cache.count(key) == 0) {
         return QVariant();
@@ -234,12 +242,14 @@ QVariant RS_Settings::readEntryCache(const QString &key) {
 }
 
 void RS_Settings::clear_all() {
+    std::lock_guard<std::mutex> lock{m_mutex};
     settings->clear();
     cache.clear();
     save_is_allowed = false;
 }
 
 void RS_Settings::clear_geometry() {
+    std::lock_guard<std::mutex> lock{m_mutex};
     settings->remove("/Geometry");
     cache.clear();
     save_is_allowed = false;
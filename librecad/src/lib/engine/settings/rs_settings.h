@@ -30,6 +30,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include <QString>
 #include <QObject>
@@ -176,8 +177,11 @@ private:
 
 protected:
     std::map<QString, QVariant> cache;
-    QString m_group;
+    // the current group is per thread, so threads reading settings concurrently don't switch groups of each other
+    static inline thread_local QString m_group;
     QSettings *settings;
+    // guards the cache and the settings
+    std::mutex m_mutex;
     static inline RS_Settings* INSTANCE;
 
     bool writeEntrySingle(const QString &group, const QString &key, const QVariant &value);
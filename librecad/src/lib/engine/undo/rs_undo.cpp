@@ -25,8 +25,12 @@
 **
 **********************************************************************/
 
+#include<algorithm>
 #include<iostream>
+#include<vector>
+#include "lc_trace.h"
 #include "qc_applicationwindow.h"
+#include "rs_settings.h"
 #include "rs_undocycle.h"
 #include "rs_undo.h"
 #include "rs_debug.h"
@@ -78,6 +82,9 @@ void RS_Undo::addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i) {
 
 //    undoList.insert(++undoPointer, i);
 	undoList.insert(undoList.begin() + (++undoPointer), i);
+    for (auto u: i->getUndoables()) {
+        ++cycleCounts[u];
+    }
 
     RS_DEBUG->print("RS_Undo::addUndoCycle: ok");
 }
@@ -99,41 +106,77 @@ void RS_Undo::startUndoCycle()
     // if there are undo cycles behind undoPointer
     // remove obsolete entities and undoCycles
     if (undoList.size() > removePointer) {
-        // collect remaining undoables
-        std::list<RS_Undoable*> keep;
-        for (auto it = undoList.begin(); it != undoList.begin() + removePointer; ++it) {
-            for (auto u: (*it)->getUndoables()){
-                keep.push_back( u);
-            }
-        }
-        keep.unique();
+        removeUndoCycles(removePointer, undoList.size());
+    }
 
-        // collect obsolete undoables
-        std::list<RS_Undoable*> obsolete;
-        for (auto it = undoList.begin() + removePointer; it != undoList.end(); ++it) {
-            for (auto u: (*it)->getUndoables()){
-                obsolete.push_back( u);
-            }
-        }
-        // unique() only works correct on sorted list!
-        obsolete.sort();
-        obsolete.unique();
-
-        // delete obsolete undoables which are not in keep list
-        for (auto it = obsolete.begin(); it != obsolete.end(); ++it) {
-            if (keep.end() == std::find( keep.begin(), keep.end(), *it)) {
-                removeUndoable( *it);
+    // alloc new undoCycle
+    currentCycle = std::make_shared<RS_UndoCycle>();
+}
+
+
+void RS_Undo::removeUndoCycles(size_t first, size_t last)
+{
+    // collect obsolete undoables, which are in no remaining cycle;
+    // undoables, which aren't undone, stay in the document
+    std::vector<RS_Undoable*> obsolete;
+    for (size_t i = first; i < last; ++i) {
+        for (auto u: undoList[i]->getUndoables()){
+            auto it = cycleCounts.find(u);
+            if (it != cycleCounts.end() && --it->second == 0) {
+                cycleCounts.erase(it);
+                if (u->isUndone()) {
+                    obsolete.push_back( u);
+                }
             }
         }
+        estimatedSize -= std::min(estimatedSize, undoList[i]->getEstimatedSize());
+    }
+
+    // delete obsolete undoables at once
+    removeUndoables(obsolete);
 
-        // clean up obsolete undoCycles
-        while (undoList.size() > removePointer) {
-            undoList.pop_back();
+    // clean up obsolete undoCycles
+    undoList.erase(undoList.begin() + first, undoList.begin() + last);
+    if (undoPointer >= static_cast<int>(first)) {
+        undoPointer = std::max(static_cast<int>(first) - 1, undoPointer - static_cast<int>(last - first));
+    }
+}
+
+
+void RS_Undo::trimUndoList()
+{
+    const int cycleLimit = LC_GET_ONE_INT("Defaults", "UndoCycleLimit", 0);
+    // in MiB
+    const int memoryLimit = LC_GET_ONE_INT("Defaults", "UndoMemoryLimit", 512);
+
+    size_t remainingSize = estimatedSize;
+    size_t count = 0;
+    while (count + 1 < undoList.size() && static_cast<int>(count) < undoPointer) {
+        const size_t cycles = undoList.size() - count;
+        const bool overCycles = cycleLimit > 0 && cycles > static_cast<size_t>(cycleLimit);
+        const bool overMemory = memoryLimit > 0 && remainingSize > static_cast<size_t>(memoryLimit) << 20;
+        if (!overCycles && !overMemory) {
+            break;
         }
+        remainingSize -= std::min(remainingSize, undoList[count]->getEstimatedSize());
+        ++count;
     }
 
-    // alloc new undoCycle
-    currentCycle = std::make_shared<RS_UndoCycle>();
+    if (count > 0) {
+        RS_DEBUG->print("RS_Undo::%s(): removing %zu oldest undo cycles", __func__, count);
+        removeUndoCycles(0, count);
+    }
+}
+
+
+/**
+ * Deletes the given undoables, which are no longer in the undo buffer.
+ */
+void RS_Undo::removeUndoables(const std::vector<RS_Undoable*>& undoables)
+{
+    for (RS_Undoable* u: undoables) {
+        removeUndoable(u);
+    }
 }
 
 
@@ -159,6 +202,7 @@ void RS_Undo::addUndoable(RS_Undoable* u) {
  */
 void RS_Undo::endUndoCycle() 
 {
+    LC_TRACE_ZONE("undo", "endUndoCycle");
     if (0 < refCount) {
         // compensate nested calls of start-/endUndoCycle()
         if( 0 < --refCount) {
@@ -173,7 +217,11 @@ void RS_Undo::endUndoCycle()
 
     if (hasUndoable()) {
         // only keep the undoCycle, when it contains undoables
+        currentCycle->estimateSize();
+        estimatedSize += currentCycle->getEstimatedSize();
         addUndoCycle(currentCycle);
+        trimUndoList();
+        LC_TRACE_COUNTER("undo", "estimatedSize", estimatedSize);
     }
 
     setGUIButtons();
@@ -186,6 +234,7 @@ void RS_Undo::endUndoCycle()
  * Undoes the last undo cycle.
  */
 bool RS_Undo::undo() {
+    LC_TRACE_ZONE("undo", "undo");
     RS_DEBUG->print("RS_Undo::undo");
 
 	if (undoPointer < 0) return false;
@@ -202,6 +251,7 @@ bool RS_Undo::undo() {
  * Redoes the undo cycle which was at last undone.
  */
 bool RS_Undo::redo() {
+    LC_TRACE_ZONE("undo", "redo");
     RS_DEBUG->print("RS_Undo::redo");
 
 	if (undoPointer+1 < int(undoList.size())) {
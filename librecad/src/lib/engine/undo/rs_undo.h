@@ -30,6 +30,7 @@
 #define RS_UNDO_H
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 class RS_UndoCycle;
@@ -67,6 +68,12 @@ public:
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
 
+    /**
+     * Deletes all given Undoables, which are no longer in the undo buffer.
+     * The default implementation calls removeUndoable() for each of them.
+     */
+    virtual void removeUndoables(const std::vector<RS_Undoable*>& undoables);
+
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
 	  *\author: Dongxu Li
@@ -80,6 +87,16 @@ public:
 private:
 
 	void addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i);
+    /**
+     * Removes the undo cycles in [first, last) and deletes their undone
+     * undoables, which aren't in any remaining cycle.
+     */
+    void removeUndoCycles(size_t first, size_t last);
+    /**
+     * Removes the oldest undo cycles beyond the cycle and memory limits
+     * of the settings. The newest cycle is always kept.
+     */
+    void trimUndoList();
     //! List of undo list items. every item is something that can be undone.
 	std::vector<std::shared_ptr<RS_UndoCycle>> undoList;
 
@@ -91,6 +108,16 @@ private:
      */
 	int undoPointer = -1;
 
+    /**
+     * Estimated memory of the entities removed by all undo cycles, in bytes.
+     */
+    size_t estimatedSize = 0;
+
+    /**
+     * Number of undo cycles each undoable is in.
+     */
+    std::unordered_map<RS_Undoable*, unsigned> cycleCounts;
+
     /**
      * Current undo cycle.
      */
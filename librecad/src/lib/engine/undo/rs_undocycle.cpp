@@ -27,6 +27,7 @@
 
 
 #include <ostream>
+#include "lc_memoryreport.h"
 #include"rs_undocycle.h"
 
 /**
@@ -64,6 +65,22 @@ void RS_UndoCycle::changeUndoState()
 		u->changeUndoState();
 }
 
+void RS_UndoCycle::estimateSize()
+{
+    estimatedSize = 0;
+    // entities added by the cycle stay in the document, only removed ones are released with the cycle
+    for (RS_Undoable* u: undoables) {
+        if (u->undoRtti() == RS2::UndoableEntity && u->isUndone()) {
+            estimatedSize += LC_MemoryReport::estimateSize(*static_cast<RS_Entity*>(u));
+        }
+    }
+}
+
+size_t RS_UndoCycle::getEstimatedSize() const
+{
+    return estimatedSize;
+}
+
 std::set<RS_Undoable*> const& RS_UndoCycle::getUndoables() const
 {
     return undoables;
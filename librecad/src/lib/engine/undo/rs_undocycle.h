@@ -29,6 +29,7 @@
 #ifndef RS_UNDOLISTITEM_H
 #define RS_UNDOLISTITEM_H
 
+#include <cstddef>
 #include <iosfwd>
 #include <set>
 
@@ -75,6 +76,17 @@ public:
     //! change undo state of all undoable in the current cycle
     void changeUndoState();
 
+    /**
+     * Estimates the memory of the entities removed by this cycle, which is released when the cycle is removed
+     * from the undo list. Called when the cycle is complete, the result is kept.
+     */
+    void estimateSize();
+
+    /**
+     * @return estimated memory of the undoables in bytes
+     */
+    size_t getEstimatedSize() const;
+
     friend std::ostream& operator << (std::ostream& os, RS_UndoCycle& uc);
 
     friend class RS_Undo;
@@ -86,6 +98,7 @@ private:
     //RS2::UndoType type;
     //! List of entity id's that were affected by this action
     std::set<RS_Undoable*> undoables;
+    size_t estimatedSize = 0;
 };
 
 #endif
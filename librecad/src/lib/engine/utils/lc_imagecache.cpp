@@ -0,0 +1,114 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <QFileInfo>
+
+#include "lc_imagecache.h"
+#include "rs_debug.h"
+
+LC_ImagePyramid::LC_ImagePyramid(QImage image):
+    m_image{std::move(image)}
+{
+}
+
+bool LC_ImagePyramid::isNull() const
+{
+    return m_image.isNull();
+}
+
+int LC_ImagePyramid::width() const
+{
+    return m_image.width();
+}
+
+int LC_ImagePyramid::height() const
+{
+    return m_image.height();
+}
+
+QImage LC_ImagePyramid::getImage() const
+{
+    return m_image;
+}
+
+QImage LC_ImagePyramid::getLevel(double screenPixels) const
+{
+    if (isNull() || !(screenPixels > 0.) || screenPixels > 0.5) {
+        return m_image;
+    }
+    // pixels of level n are 2^n times larger than the ones of the full image
+    const auto level = static_cast<std::size_t>(std::floor(std::log2(1. / screenPixels)));
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    while (m_levels.size() < level) {
+        const QImage& previous = m_levels.empty() ? m_image : m_levels.back();
+        if (previous.width() == 1 && previous.height() == 1) {
+            break;
+        }
+        m_levels.push_back(previous.scaled(std::max(1, previous.width() / 2), std::max(1, previous.height() / 2),
+                                           Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+    }
+    return m_levels.empty() ? m_image : m_levels.at(std::min(level, m_levels.size()) - 1);
+}
+
+LC_ImageCache& LC_ImageCache::instance()
+{
+    static LC_ImageCache cache;
+    return cache;
+}
+
+std::shared_ptr<const LC_ImagePyramid> LC_ImageCache::getImage(const QString& filePath)
+{
+    const QFileInfo fileInfo{filePath};
+    if (!fileInfo.exists()) {
+        return std::make_shared<LC_ImagePyramid>(QImage{});
+    }
+    const QString key = fileInfo.canonicalFilePath();
+    const QDateTime modified = fileInfo.lastModified();
+    const qint64 size = fileInfo.size();
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->modified == modified && it->size == size) {
+        if (std::shared_ptr<const LC_ImagePyramid> image = it->image.lock()) {
+            return image;
+        }
+    }
+
+    RS_DEBUG->print("LC_ImageCache::getImage: decoding %s", key.toLatin1().data());
+    auto image = std::make_shared<const LC_ImagePyramid>(QImage{key});
+    if (image->isNull()) {
+        m_entries.remove(key);
+        return image;
+    }
+    // drop the entries of released images
+    for (auto entry = m_entries.begin(); entry != m_entries.end();) {
+        entry = entry->image.expired() ? m_entries.erase(entry) : std::next(entry);
+    }
+    m_entries.insert(key, {modified, size, image});
+    return image;
+}
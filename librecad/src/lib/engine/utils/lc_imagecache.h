@@ -0,0 +1,96 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_IMAGECACHE_H
+#define LC_IMAGECACHE_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QString>
+
+/**
+ * @brief The LC_ImagePyramid class, a decoded raster image with its levels of detail.
+ *
+ * Each level halves the size of the previous one, down to a single pixel. Levels are built on the first use,
+ * so an image drawn at a close zoom only keeps the full resolution.
+ */
+class LC_ImagePyramid {
+public:
+    explicit LC_ImagePyramid(QImage image);
+
+    bool isNull() const;
+    int width() const;
+    int height() const;
+
+    /** @return the image in full resolution */
+    QImage getImage() const;
+
+    /**
+     * @brief getLevel the smallest level, which still has at least one pixel per screen pixel
+     * @param screenPixels - number of screen pixels covered by one pixel of the full resolution image
+     */
+    QImage getLevel(double screenPixels) const;
+
+private:
+    QImage m_image;
+    mutable std::mutex m_mutex;
+    // the reduced levels, starting with level 1
+    mutable std::vector<QImage> m_levels;
+};
+
+/**
+ * @brief The LC_ImageCache class, the process wide cache of decoded raster images.
+ *
+ * Images are keyed by the canonical file path, and are shared by all users of the same file: cloning an image
+ * entity, e.g. for previews, doesn't decode the file again. A file modified since it was decoded is decoded again.
+ * The cache doesn't own the images, so an image is released with its last user.
+ */
+class LC_ImageCache {
+public:
+    static LC_ImageCache& instance();
+
+    /**
+     * @brief getImage the decoded image of the file
+     * @return the shared image, which is null, if the file can't be read
+     */
+    std::shared_ptr<const LC_ImagePyramid> getImage(const QString& filePath);
+
+private:
+    LC_ImageCache() = default;
+
+    struct Entry {
+        QDateTime modified;
+        qint64 size = 0;
+        std::weak_ptr<const LC_ImagePyramid> image;
+    };
+
+    std::mutex m_mutex;
+    QHash<QString, Entry> m_entries;
+};
+
+#endif // LC_IMAGECACHE_H
@@ -0,0 +1,144 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cassert>
+
+#include "lc_objectpool.h"
+
+namespace {
+constexpr std::size_t firstChunkSlots = 64;
+constexpr std::size_t maxChunkSlots = 8192;
+
+std::mutex& registryMutex()
+{
+    static auto* mutex = new std::mutex;
+    return *mutex;
+}
+
+std::vector<const LC_ObjectPool*>& registry()
+{
+    static auto* pools = new std::vector<const LC_ObjectPool*>;
+    return *pools;
+}
+
+// a free slot holds the link to the next free slot
+void*& nextFree(void* slot)
+{
+    return *static_cast<void**>(slot);
+}
+
+// pushes all slots of a chunk to the free list, so they are handed out in the order of addresses
+void linkSlots(char* chunk, std::size_t slots, std::size_t slotSize, void*& freeList)
+{
+    for (std::size_t i = slots; i > 0; --i) {
+        void* slot = chunk + (i - 1) * slotSize;
+        nextFree(slot) = freeList;
+        freeList = slot;
+    }
+}
+}
+
+LC_ObjectPool::LC_ObjectPool(std::size_t objectSize, const char* name):
+    m_name{name}
+  , m_objectSize{objectSize}
+{
+    constexpr std::size_t alignment = alignof(std::max_align_t);
+    m_slotSize = (std::max(objectSize, sizeof(void*)) + alignment - 1) / alignment * alignment;
+    std::lock_guard<std::mutex> lock{registryMutex()};
+    registry().push_back(this);
+}
+
+void* LC_ObjectPool::allocate(std::size_t size)
+{
+    if (size != m_objectSize) {
+        return ::operator new(size);
+    }
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_freeList == nullptr) {
+        addChunk();
+    }
+    void* object = m_freeList;
+    m_freeList = nextFree(object);
+    ++m_liveObjects;
+    return object;
+}
+
+void LC_ObjectPool::deallocate(void* object, std::size_t size)
+{
+    if (object == nullptr) {
+        return;
+    }
+    if (size != m_objectSize) {
+        ::operator delete(object);
+        return;
+    }
+    std::lock_guard<std::mutex> lock{m_mutex};
+    assert(m_liveObjects > 0);
+    nextFree(object) = m_freeList;
+    m_freeList = object;
+    if (--m_liveObjects == 0) {
+        releaseChunks();
+    }
+}
+
+LC_ObjectPool::Statistics LC_ObjectPool::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    Statistics statistics{m_name, m_objectSize, m_liveObjects, 0};
+    for (const auto& [chunk, slots]: m_chunks) {
+        statistics.reservedBytes += slots * m_slotSize;
+    }
+    return statistics;
+}
+
+std::vector<LC_ObjectPool::Statistics> LC_ObjectPool::getAllStatistics()
+{
+    std::vector<Statistics> statistics;
+    std::lock_guard<std::mutex> lock{registryMutex()};
+    for (const LC_ObjectPool* pool: registry()) {
+        statistics.push_back(pool->getStatistics());
+    }
+    return statistics;
+}
+
+void LC_ObjectPool::addChunk()
+{
+    const std::size_t slots = m_chunks.empty() ? firstChunkSlots
+                                               : std::min(m_chunks.back().second * 2, maxChunkSlots);
+    // new[] of char aligns to the default new alignment; the slots are left uninitialized
+    std::unique_ptr<char[]> chunk{new char[slots * m_slotSize]};
+    linkSlots(chunk.get(), slots, m_slotSize, m_freeList);
+    m_chunks.emplace_back(std::move(chunk), slots);
+}
+
+// called with all objects freed: keeps the first chunk only, so a drawing closed returns its memory
+void LC_ObjectPool::releaseChunks()
+{
+    if (m_chunks.size() <= 1) {
+        return;
+    }
+    m_chunks.resize(1);
+    m_freeList = nullptr;
+    linkSlots(m_chunks.front().first.get(), m_chunks.front().second, m_slotSize, m_freeList);
+}
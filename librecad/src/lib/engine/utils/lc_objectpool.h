@@ -0,0 +1,84 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_OBJECTPOOL_H
+#define LC_OBJECTPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The LC_ObjectPool class, a free list allocator of fixed size objects.
+ *
+ * Objects are carved from chunks, which grow geometrically, so a million lines take a few hundred allocations
+ * without the per allocation overhead of the heap, and stay close in memory. Freed objects are reused first.
+ * All chunks but the first one are released, when the last object of the pool is freed.
+ *
+ * A class uses a pool through its own operator new and operator delete; allocations of another size, i.e. of
+ * derived classes, are passed to the global heap. Pools are created with new and never destroyed, so pooled
+ * objects may outlive static data.
+ */
+class LC_ObjectPool {
+public:
+    /**
+     * @param objectSize - the size of the pooled class
+     * @param name - the name of the pooled class, for the memory report
+     */
+    LC_ObjectPool(std::size_t objectSize, const char* name);
+    ~LC_ObjectPool() = delete;
+    LC_ObjectPool(const LC_ObjectPool&) = delete;
+    LC_ObjectPool& operator = (const LC_ObjectPool&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* object, std::size_t size);
+
+    struct Statistics {
+        const char* name = nullptr;
+        std::size_t objectSize = 0;
+        //! objects in use
+        std::size_t liveObjects = 0;
+        //! bytes reserved by chunks, used or free
+        std::size_t reservedBytes = 0;
+    };
+    Statistics getStatistics() const;
+
+    /** @return the statistics of all pools, in the order of creation */
+    static std::vector<Statistics> getAllStatistics();
+
+private:
+    void addChunk();
+    void releaseChunks();
+
+    const char* m_name = nullptr;
+    std::size_t m_objectSize = 0;
+    std::size_t m_slotSize = 0;
+    std::size_t m_liveObjects = 0;
+    void* m_freeList = nullptr;
+    std::vector<std::pair<std::unique_ptr<char[]>, std::size_t>> m_chunks;
+    mutable std::mutex m_mutex;
+};
+
+#endif // LC_OBJECTPOOL_H
@@ -0,0 +1,211 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include <QFile>
+#include <QHash>
+
+#include "lc_graphicsnapshot.h"
+#include "lc_ucs.h"
+#include "lc_ucslist.h"
+#include "lc_view.h"
+#include "lc_viewslist.h"
+#include "rs_block.h"
+#include "rs_blocklist.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_graphic.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
+
+namespace {
+/**
+ * Moves the entities of a cloned container to the cloned layers. Sub-entities are not written with own
+ * attributes, so only the entities of the container itself are moved.
+ */
+void mapLayers(RS_EntityContainer& container, const QHash<RS_Layer*, RS_Layer*>& layers)
+{
+    for (RS_Entity* e: container) {
+        e->setLayer(layers.value(e->getLayer(false), nullptr));
+    }
+}
+
+/**
+ * Binds a cloned insert to the cloned block. Clones keep the cached block of the original insert, which is a
+ * block of the drawing, edited meanwhile.
+ */
+void bindBlock(RS_Entity* entity, RS_BlockList& blocks)
+{
+    if (entity->rtti() == RS2::EntityInsert) {
+        auto* insert = static_cast<RS_Insert*>(entity);
+        insert->setBlockForInsert(blocks.find(insert->getName()));
+    }
+}
+}
+
+LC_GraphicSnapshot::LC_GraphicSnapshot(RS_Graphic& graphic, QString fileName, RS2::FormatType type):
+    m_graphic{std::make_unique<RS_Graphic>()}
+  , m_fileIO{RS_FileIO::instance()}
+  , m_fileName{std::move(fileName)}
+  , m_type{type == RS2::FormatUnknown ? RS2::FormatDXFRW : type}
+{
+    RS_DEBUG->print("LC_GraphicSnapshot: copying %u entities", graphic.count());
+
+    m_graphic->setVariableDictObject(graphic.getVariableDictObject());
+    m_graphic->setMargins(graphic.getMarginLeft(), graphic.getMarginTop(),
+                          graphic.getMarginRight(), graphic.getMarginBottom());
+    m_graphic->setPagesNum(graphic.getPagesNumHoriz(), graphic.getPagesNumVert());
+    m_graphic->setPaperScaleFixed(graphic.getPaperScaleFixed());
+
+    QHash<RS_Layer*, RS_Layer*> layers;
+    for (RS_Layer* layer: *graphic.getLayerList()) {
+        RS_Layer* copy = layer->clone();
+        layers.insert(layer, copy);
+        m_layers.push_back(copy);
+        m_graphic->addLayer(copy);
+    }
+    if (graphic.getActiveLayer() != nullptr) {
+        m_graphic->activateLayer(layers.value(graphic.getActiveLayer(), nullptr));
+    }
+
+    RS_BlockList* blockList = graphic.getBlockList();
+    for (unsigned i = 0; i < blockList->count(); ++i) {
+        auto* copy = static_cast<RS_Block*>(blockList->at(i)->clone());
+        copy->reparent(m_graphic.get());
+        mapLayers(*copy, layers);
+        m_blocks.push_back(copy);
+        m_graphic->addBlock(copy, false);
+    }
+    // inserts are bound once all blocks are copied, as blocks may insert blocks added later
+    for (RS_Block* block: m_blocks) {
+        for (RS_Entity* e: *block) {
+            bindBlock(e, *m_graphic->getBlockList());
+        }
+    }
+
+    LC_ViewList* views = graphic.getViewList();
+    for (unsigned i = 0; i < views->count(); ++i) {
+        auto* copy = new LC_View(*views->at(i));
+        if (copy->getUCS() != nullptr) {
+            copy->setUCS(new LC_UCS(*copy->getUCS()));
+            m_ucss.push_back(copy->getUCS());
+        }
+        m_views.push_back(copy);
+        m_graphic->getViewList()->add(copy);
+    }
+
+    // the first UCS is the WCS of the list
+    LC_UCSList* ucsList = graphic.getUCSList();
+    for (unsigned i = 1; i < ucsList->count(); ++i) {
+        auto* copy = new LC_UCS(*ucsList->at(i));
+        m_ucss.push_back(copy);
+        m_graphic->getUCSList()->add(copy);
+    }
+
+    std::vector<RS_Entity*> entities;
+    entities.reserve(graphic.count());
+    for (RS_Entity* e: graphic) {
+        if (e->isUndone()) {
+            continue;
+        }
+        RS_Entity* copy = e->clone();
+        copy->reparent(m_graphic.get());
+        copy->setLayer(layers.value(e->getLayer(false), nullptr));
+        bindBlock(copy, *m_graphic->getBlockList());
+        entities.push_back(copy);
+    }
+    m_graphic->setAutoUpdateBorders(false);
+    m_graphic->insertEntities(0, entities);
+
+    // the clones have the borders of the entities, so the borders of the copy are known without walking into
+    // the entities or blocks on the writing thread
+    for (RS_Entity* copy: entities) {
+        if (copy->isVisible()) {
+            m_graphic->adjustBorders(copy);
+        }
+    }
+}
+
+LC_GraphicSnapshot::~LC_GraphicSnapshot()
+{
+    m_graphic.reset();
+    for (RS_Block* block: m_blocks) {
+        delete block;
+    }
+    for (RS_Layer* layer: m_layers) {
+        delete layer;
+    }
+    for (LC_View* view: m_views) {
+        delete view;
+    }
+    for (LC_UCS* ucs: m_ucss) {
+        delete ucs;
+    }
+}
+
+QString LC_GraphicSnapshot::temporaryFileName() const
+{
+    return m_fileName + ".tmp";
+}
+
+bool LC_GraphicSnapshot::write()
+{
+    m_written = m_fileIO->fileExport(*m_graphic, temporaryFileName(), m_type);
+    if (!m_written) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_GraphicSnapshot::write: can't write %s",
+                        temporaryFileName().toLatin1().data());
+        QFile::remove(temporaryFileName());
+    }
+    return m_written;
+}
+
+bool LC_GraphicSnapshot::commit()
+{
+    if (!m_written) {
+        return false;
+    }
+    m_written = false;
+    // unlike QFile::rename(), replaces an existing target in one step
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::u8path(temporaryFileName().toStdString()),
+                            std::filesystem::u8path(m_fileName.toStdString()), error);
+    if (error) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_GraphicSnapshot::commit: can't rename to %s: %s",
+                        m_fileName.toLatin1().data(), error.message().c_str());
+        QFile::remove(temporaryFileName());
+        return false;
+    }
+    return true;
+}
+
+void LC_GraphicSnapshot::discard()
+{
+    if (m_written) {
+        m_written = false;
+        QFile::remove(temporaryFileName());
+    }
+}
@@ -0,0 +1,99 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_GRAPHICSNAPSHOT_H
+#define LC_GRAPHICSNAPSHOT_H
+
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+#include "rs.h"
+
+class LC_UCS;
+class LC_View;
+class RS_Block;
+class RS_FileIO;
+class RS_Graphic;
+class RS_Layer;
+
+/**
+ * @brief The LC_GraphicSnapshot class, a copy of a drawing, which is written to a file on a worker thread.
+ *
+ * The copy is taken on the main thread: entities, layers, blocks, variables, named views and UCSs are cloned,
+ * and the cloned entities and block entities are moved to the cloned layers, so that writing the copy doesn't
+ * access the drawing, which is edited meanwhile. The graphic view isn't copied, so the active viewport of the
+ * written file has no zoom.
+ *
+ * The file is written to a temporary file next to the target, which replaces the target by commit() only.
+ */
+class LC_GraphicSnapshot {
+public:
+    /**
+     * @param graphic - the drawing to copy
+     * @param fileName - the target file
+     * @param type - the format of the target file
+     */
+    LC_GraphicSnapshot(RS_Graphic& graphic, QString fileName, RS2::FormatType type);
+    ~LC_GraphicSnapshot();
+
+    LC_GraphicSnapshot(const LC_GraphicSnapshot&) = delete;
+    LC_GraphicSnapshot& operator=(const LC_GraphicSnapshot&) = delete;
+
+    const QString& getFileName() const {
+        return m_fileName;
+    }
+
+    /**
+     * @brief write - writes the copy to the temporary file, may be called on any thread
+     * @return true, if the file was written
+     */
+    bool write();
+
+    /**
+     * @brief commit - replaces the target file by the written temporary file
+     * @return true, if the target file was replaced
+     */
+    bool commit();
+
+    /** @brief discard - removes the written temporary file */
+    void discard();
+
+private:
+    QString temporaryFileName() const;
+
+    std::unique_ptr<RS_Graphic> m_graphic;
+    RS_FileIO* m_fileIO = nullptr;
+    QString m_fileName;
+    RS2::FormatType m_type = RS2::FormatDXFRW;
+    bool m_written = false;
+
+    // the lists of a graphic don't delete their items
+    std::vector<RS_Layer*> m_layers;
+    std::vector<RS_Block*> m_blocks;
+    std::vector<LC_View*> m_views;
+    std::vector<LC_UCS*> m_ucss;
+};
+
+#endif // LC_GRAPHICSNAPSHOT_H
@@ -26,11 +26,12 @@
 **********************************************************************/
 
 #include <cstddef>
+#include <QApplication>
 #include <QFileInfo>
 #include <QTextStream>
+#include <QThread>
 #ifdef DWGSUPPORT
 #include <QMessageBox>
-#include <QApplication>
 #endif
 #include "rs_fileio.h"
 #include "rs_filtercxf.h"
@@ -39,6 +40,7 @@
 #include "rs_filterlff.h"
 #include "rs_filterdxfrw.h"
 #include "rs_debug.h"
+#include "lc_trace.h"
 
 /**
  * Calls the import method of the filter responsible for the format
@@ -51,8 +53,11 @@
  */
 bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
                            RS2::FormatType type) {
+    LC_TRACE_ZONE("io", "fileImport");
 
-    RS_DEBUG->print("Trying to import file '%s'...", file.toLatin1().data());
+    if (RS_DEBUG->getLevel() >= RS_Debug::D_DEBUGGING) {
+        RS_DEBUG->print("Trying to import file '%s'...", file.toLatin1().data());
+    }
 
     RS2::FormatType t;
     if (type == RS2::FormatUnknown) {
@@ -65,9 +70,11 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
     if (RS2::FormatUnknown != t) {
         std::unique_ptr<RS_FilterInterface>&& filter(getImportFilter(file, t));
         if (filter){
+            // files may be imported by worker threads, e.g. by the batch console converters, which can't show dialogs
+            const bool isGuiThread {qApp != nullptr && QThread::currentThread() == qApp->thread()};
 #ifdef DWGSUPPORT
             bool isDwg {file.endsWith( ".dwg", Qt::CaseInsensitive)};
-            if (isDwg) {
+            if (isDwg && isGuiThread) {
                 QApplication::restoreOverrideCursor();  // disable WaitCursor for massagebox
 
                 // use QStringList to avoid "\n" in translation strings
@@ -85,6 +92,11 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
             }
 #endif
             bool bImported {filter->fileImport(graphic, file, t)};
+            if (!bImported && !isGuiThread) {
+                RS_DEBUG->print(RS_Debug::D_WARNING, "RS_FileIO::fileImport: failed to import file: %s: %s",
+                                file.toLatin1().data(), filter->lastError().toLatin1().data());
+                return false;
+            }
             if (!bImported) {
                 QApplication::restoreOverrideCursor();  // disable WaitCursor for massagebox
 
@@ -214,6 +226,7 @@ RS2::FormatType RS_FileIO::detectFormat(QString const& file, bool forRead)
  */
 bool RS_FileIO::fileExport(RS_Graphic& graphic, const QString& file,
                            RS2::FormatType type) {
+    LC_TRACE_ZONE("io", "fileExport");
 
     RS_DEBUG->print("RS_FileIO::fileExport");
     //RS_DEBUG->print("Trying to export file '%s'...", file.latin1());
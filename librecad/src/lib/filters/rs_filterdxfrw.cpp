@@ -59,6 +59,7 @@
 #include "rs_math.h"
 #include "dxf_format.h"
 #include "lc_defaults.h"
+#include "lc_trace.h"
 
 #ifdef DWGSUPPORT
 #include "libdwgr.h"
@@ -151,6 +152,7 @@ QString RS_FilterDXFRW::lastError() const
  * taken to be stored in a file.
  */
 bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unused]] RS2::FormatType type) {
+    LC_TRACE_ZONE("io", "dxfImport");
     RS_DEBUG->print("RS_FilterDXFRW::fileImport");
 
     RS_DEBUG->print("DXFRW Filter: importing file '%s'...", (const char*)QFile::encodeName(file));
@@ -158,6 +160,14 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
     graphic = &g;
     currentContainer = graphic;
 	dummyContainer = new RS_EntityContainer(nullptr, true);
+    regenScheduler.clear();
+    // texts, hatches and dimensions are updated at once, before the entities of the dummy container are deleted;
+    // partially read drawings may still be opened, so they're updated on errors as well
+    auto updateEntities = [this]() {
+        RS_DEBUG->print("RS_FilterDXFRW::fileImport: updating %zu entities", regenScheduler.size());
+        LC_TRACE_COUNTER("io", "regenEntities", regenScheduler.size());
+        regenScheduler.run();
+    };
 
     this->file = file;
     // add some variables that need to be there for DXF drawings:
@@ -184,6 +194,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
             RS_DEBUG->print(RS_Debug::D_WARNING,
                             "Cannot open DWG file '%s'.", (const char*)QFile::encodeName(file));
             errorCode = dwgr.getError();
+            updateEntities();
             return false;
         }
     } else {
@@ -194,7 +205,11 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
         if (RS_Debug::D_DEBUGGING == RS_DEBUG->getLevel()) {
             dxfR.setDebug(DRW::DebugLevel::Debug);
         }
-        bool success = dxfR.read(this, true);
+        bool success = false;
+        {
+            LC_TRACE_ZONE("io", "dxfRead");
+            success = dxfR.read(this, true);
+        }
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file: OK");
         //graphic->setAutoUpdateBorders(true);
 
@@ -202,12 +217,15 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
             RS_DEBUG->print(RS_Debug::D_WARNING,
                             "Cannot open DXF file '%s'.", (const char*)QFile::encodeName(file));
             errorCode = dxfR.getError();
+            updateEntities();
             return false;
         }
 #ifdef DWGSUPPORT
     }
 #endif
 
+    updateEntities();
+
     delete dummyContainer;
     /*set current layer */
     RS_Layer* cl = graphic->findLayer(graphic->getVariableString("$CLAYER", "0"));
@@ -924,8 +942,8 @@ void RS_FilterDXFRW::addMText(const DRW_MText& data) {
     RS_MText* entity = new RS_MText(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -983,8 +1001,8 @@ void RS_FilterDXFRW::addText(const DRW_Text& data) {
     RS_Text* entity = new RS_Text(currentContainer, d);
 
     setEntityAttributes(entity, &data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1072,8 +1090,8 @@ void RS_FilterDXFRW::addDimAlign(const DRW_DimAligned *data) {
                             dimensionData, d);
     setEntityAttributes(entity, data);
     entity->updateDimPoint();
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1096,8 +1114,8 @@ void RS_FilterDXFRW::addDimLinear(const DRW_DimLinear *data) {
     RS_DimLinear* entity = new RS_DimLinear(currentContainer,
                                             dimensionData, d);
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1118,8 +1136,8 @@ void RS_FilterDXFRW::addDimRadial(const DRW_DimRadial* data) {
                                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1140,8 +1158,8 @@ void RS_FilterDXFRW::addDimDiametric(const DRW_DimDiametric* data) {
                               dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1165,8 +1183,8 @@ void RS_FilterDXFRW::addDimAngular(const DRW_DimAngular* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1191,8 +1209,8 @@ void RS_FilterDXFRW::addDimAngular3P(const DRW_DimAngular3p* data) {
                             dimensionData, d);
 
     setEntityAttributes(entity, data);
-    entity->update();
     currentContainer->addEntity(entity);
+    regenScheduler.add(entity);
 }
 
 
@@ -1214,8 +1232,8 @@ void RS_FilterDXFRW::addLeader(const DRW_Leader *data) {
 	for (auto const& vert: data->vertexlist)
 		leader->addVertex({vert->x, vert->y});
 
-    leader->update();
     currentContainer->addEntity(leader);
+    regenScheduler.add(leader);
 
 }
 
@@ -1336,9 +1354,8 @@ void RS_FilterDXFRW::addHatch(const DRW_Hatch *data) {
 
     }
 
-    RS_DEBUG->print("hatch->update()");
     if (hatch->validate()) {
-        hatch->update();
+        regenScheduler.add(hatch);
     } else {
         graphic->removeEntity(hatch);
         RS_DEBUG->print(RS_Debug::D_ERROR,
@@ -1535,6 +1552,7 @@ void RS_FilterDXFRW::addHeader(const DRW_Header* data){
  * @param file Full path to the DXF file that will be written.
  */
 bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type) {
+    LC_TRACE_ZONE("io", "dxfExport");
 
     RS_DEBUG->print("RS_FilterDXFDW::fileExport: exporting file '%s'...",
                     (const char*)QFile::encodeName(file));
@@ -3274,12 +3292,14 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
     QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
 
     // Layer: add layer in case it doesn't exist:
-	if (!graphic->findLayer(layName)) {
+    RS_Layer* layer = graphic->findLayer(layName);
+	if (!layer) {
         DRW_Layer lay;
         lay.name = attrib->layer;
         addLayer(lay);
+        layer = graphic->findLayer(layName);
     }
-    entity->setLayer(layName);
+    entity->setLayer(layer);
 
     // Color:
     if (attrib->color24 >= 0)
@@ -33,6 +33,7 @@
 #include "rs_dimension.h"
 #include "drw_interface.h"
 #include "libdxfrw.h"
+#include "lc_regenscheduler.h"
 
 class RS_Point;
 class RS_Line;
@@ -240,6 +241,8 @@ private:
     QHash<int, RS_EntityContainer*> blockHash;
     /** Pointer to entity container to store possible orphan entities like paper space */
     RS_EntityContainer* dummyContainer;
+    /** Entities updated after all entities are read. */
+    LC_RegenScheduler regenScheduler;
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include "rs_math.h"
 #include "lc_graphicviewport.h"
 #include "rs_entitycontainer.h"
+#include "lc_trace.h"
 
 LC_PrintViewportRenderer::LC_PrintViewportRenderer(LC_GraphicViewport *viewport, RS_Painter* p)
    :LC_GraphicViewportRenderer(viewport, nullptr)
@@ -37,34 +38,25 @@ LC_PrintViewportRenderer::LC_PrintViewportRenderer(LC_GraphicViewport *viewport,
 
 
 void LC_PrintViewportRenderer::doRender() {
+    LC_TRACE_ZONE("render", "print");
     setupPainter(painter);
     RS_EntityContainer *container = viewport->getContainer();
+    painter->setBatching(true);
     container->draw(painter);
+    painter->setBatching(false);
 }
 
 
 void LC_PrintViewportRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
     // entity is not visible:
-    bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
+    bool visible = isEntityVisible(e);
     if (!visible) {
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
     // do not draw construction layer on print preview or print
-    if (!e->isPrint() || constructionEntity)
+    if (!isEntityPrinted(e) || constructionEntity)
         return;
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
@@ -75,15 +67,12 @@ void LC_PrintViewportRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
 }
 
 void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = resolvePen(e);
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
-    if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+    if (paintState().lastPaintEntityPen.isSameAs(pen, patternOffset)) {
         return;
     }
     // Avoid negative widths
@@ -141,16 +130,13 @@ void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_E
         pen.setDashOffset(patternOffset * defaultWidthFactor);
     }
     
-    if (e->getFlag(RS2::FlagTransparent) ) {
+    if (isEntityTransparent(e)) {
         pen.setColor(m_colorBackground);
     }
 
     // we store original pen as last painted, not resolved one - since original pen lead to resulting resolved and may be used by the next entity
-    lastPaintEntityPen.updateBy(originalPen);
+    paintState().lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
 }
 
 
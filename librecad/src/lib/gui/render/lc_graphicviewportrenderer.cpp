@@ -21,8 +21,16 @@
  ******************************************************************************/
 
 #include "lc_graphicviewportrenderer.h"
+#include <QImage>
+#include <QPen>
+#include <QRectF>
+
 #include "lc_graphicviewport.h"
+#include "lc_previewtransform.h"
+#include "rs_block.h"
 #include "rs_entity.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
 #include "lc_rect.h"
 #include "rs_painter.h"
 #include "rs_units.h"
@@ -30,6 +38,37 @@
 #include "lc_defaults.h"
 #include "lc_linemath.h"
 
+thread_local LC_GraphicViewportRenderer::PaintState* LC_GraphicViewportRenderer::threadPaintState = nullptr;
+
+// the selection drawn into an image for transformed previews, with the view and the pen it was drawn for
+struct LC_GraphicViewportRenderer::TransformedPreviewCache {
+    // ids of the entities, as entities deleted after the preview may be replaced by new ones at the same address
+    std::vector<unsigned long> entityIds;
+    RS_Vector uiOrigin;
+    RS_Vector uiUnitX;
+    RS_Vector uiUnitY;
+    QSize viewSize;
+    QPen pen;
+    bool antialiasing = false;
+    QImage image;
+    QPoint uiTopLeft;
+};
+
+namespace {
+LC_Rect mapRect(const LC_Rect& rect, const LC_PreviewTransform& transform) {
+    const RS_Vector corners[] = {rect.minP(), {rect.maxP().x, rect.minP().y},
+                                 rect.maxP(), {rect.minP().x, rect.maxP().y}};
+    RS_Vector mappedMin(false);
+    RS_Vector mappedMax(false);
+    for (const RS_Vector &corner: corners) {
+        const RS_Vector mapped = transform.map(corner);
+        mappedMin = mappedMin.valid ? RS_Vector::minimum(mappedMin, mapped) : mapped;
+        mappedMax = mappedMax.valid ? RS_Vector::maximum(mappedMax, mapped) : mapped;
+    }
+    return {mappedMin, mappedMax};
+}
+}
+
 LC_GraphicViewportRenderer::LC_GraphicViewportRenderer(LC_GraphicViewport* v, QPaintDevice* painterDevice):
     pd{painterDevice}
     , viewport{v}
@@ -37,21 +76,26 @@ LC_GraphicViewportRenderer::LC_GraphicViewportRenderer(LC_GraphicViewport* v, QP
 {
 }
 
+LC_GraphicViewportRenderer::~LC_GraphicViewportRenderer() = default;
+
+void LC_GraphicViewportRenderer::beginTransformedPreviews() {
+    m_transformedPreviewCacheUsed = false;
+}
+
+void LC_GraphicViewportRenderer::endTransformedPreviews() {
+    // the preview was cleared, so its image is released instead of being kept for the next preview
+    if (!m_transformedPreviewCacheUsed) {
+        m_transformedPreviewCache.reset();
+    }
+}
+
 void LC_GraphicViewportRenderer::render() {
-    renderBoundingClipRect = prepareBoundingClipRect();
+    paintState().boundingClipRect = prepareBoundingClipRect();
     doRender();
 }
 
 void LC_GraphicViewportRenderer::renderEntityAsChild(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    drawEntityCount++;
-    drawTimer.start();
-#endif
     e->drawAsChild(painter);
-#ifdef DEBUG_RENDERING
-    qint64 elapsed = drawTimer.nsecsElapsed();
-    entityDrawTime+= elapsed;
-#endif
 }
 
 void LC_GraphicViewportRenderer::loadSettings() {
@@ -62,10 +106,12 @@ void LC_GraphicViewportRenderer::loadSettings() {
 }
 
 LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(){
-    int width = viewport->getWidth();
-    int height = viewport->getHeight();
-    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(0, 0);
-    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(width, height);
+    return prepareBoundingClipRect(0, 0, viewport->getWidth(), viewport->getHeight());
+}
+
+LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(int uiLeft, int uiTop, int uiRight, int uiBottom){
+    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(uiLeft, uiTop);
+    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(uiRight, uiBottom);
 
     if (viewport->hasUCS()){
         // here were extend (enlarge) clipping rect to ensure that if there is shift/rotation in ucs, resulting bounding box cover the entire screen
@@ -86,26 +132,27 @@ LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(){
 
 bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Entity* e, bool constructionEntity){
     // test if the entity is in the viewport
+    const LC_Rect &clipRect = paintState().boundingClipRect;
     switch (e->rtti()){
         /* case RS2::EntityGraphic:
              break;*/
         case RS2::EntityLine:{
             if (constructionEntity){
-                if (!LC_LineMath::hasIntersectionLineRect(e->getMin(), e->getMax(), renderBoundingClipRect.minP(), renderBoundingClipRect.maxP())){
+                if (!LC_LineMath::hasIntersectionLineRect(e->getMin(), e->getMax(), clipRect.minP(), clipRect.maxP())){
                     return true;
                 }
             }
             else{ // normal line
-                if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                    e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
+                if (e->getMax().x < clipRect.minP().x || e->getMin().x > clipRect.maxP().x ||
+                    e->getMin().y > clipRect.maxP().y || e->getMax().y < clipRect.minP().y){
                     return true;
                 }
             }
             break;
         }
         default:
-            if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
+            if (e->getMax().x < clipRect.minP().x || e->getMin().x > clipRect.maxP().x ||
+                e->getMin().y > clipRect.maxP().y || e->getMax().y < clipRect.minP().y){
                 return true;
             }
     }
@@ -117,15 +164,270 @@ bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Entity* e, bool
  * The painter must be initialized and all the attributes (pen) must be set.
  */
 void LC_GraphicViewportRenderer::justDrawEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    drawEntityCount++;
-    drawTimer.start();
-#endif
     e->draw(painter);
-#ifdef DEBUG_RENDERING
-    qint64 elapsed = drawTimer.nsecsElapsed();
-    entityDrawTime+= elapsed;
-#endif
+}
+
+void LC_GraphicViewportRenderer::renderInsertInstance(RS_Painter *painter, RS_Insert *insert, RS_Block *block, int col, int row) {
+    InstanceContext context;
+    context.insert = insert;
+    context.pen = resolvePen(insert);
+    context.layer = resolveLayer(insert);
+    context.selected = isEntitySelected(insert);
+    context.highlighted = isEntityHighlighted(insert);
+    context.transparent = isEntityTransparent(insert);
+
+    // the clip rect is mapped to the block, so entities of the block are culled as usual
+    PaintState &state = paintState();
+    const LC_Rect savedClipRect = state.boundingClipRect;
+    RS_Vector blockMin(false);
+    RS_Vector blockMax(false);
+    const RS_Vector clipCorners[] = {savedClipRect.minP(), {savedClipRect.maxP().x, savedClipRect.minP().y},
+                                     savedClipRect.maxP(), {savedClipRect.minP().x, savedClipRect.maxP().y}};
+    for (const RS_Vector &corner: clipCorners) {
+        const RS_Vector blockCorner = insert->mapToBlock(corner, col, row);
+        blockMin = blockMin.valid ? RS_Vector::minimum(blockMin, blockCorner) : blockCorner;
+        blockMax = blockMax.valid ? RS_Vector::maximum(blockMax, blockCorner) : blockCorner;
+    }
+    LC_Rect blockClipRect{blockMin, blockMax};
+
+    painter->pushInstanceTransform(insert->mapToWorld({0., 0.}, col, row),
+                                   insert->mapToWorld({1., 0.}, col, row),
+                                   insert->mapToWorld({0., 1.}, col, row),
+                                   insert->getInstanceScale());
+    painter->setWorldBoundingRect(blockClipRect);
+    state.boundingClipRect = blockClipRect;
+    // the pen of the previous entity stays valid, as resolved pens don't depend on the context and the painter keeps
+    // its pen through instance transforms, so letters of the same pen don't set it again. Only transparency of the
+    // insert changes the pen, without being a part of the resolved pen.
+    if (context.transparent) {
+        state.lastPaintEntityPen = RS_Pen();
+    }
+    state.instanceContexts.push_back(context);
+
+    for (RS_Entity *e: *block) {
+        painter->drawEntity(e);
+    }
+
+    state.instanceContexts.pop_back();
+    state.boundingClipRect = savedClipRect;
+    painter->popInstanceTransform();
+    if (context.transparent) {
+        state.lastPaintEntityPen = RS_Pen();
+    }
+    if (state.forcePen) {
+        painter->setPen(state.forcedPen);
+    }
+}
+
+void LC_GraphicViewportRenderer::renderTransformed(RS_Painter *painter, const std::vector<RS_Entity*> &entities,
+                                                   const LC_PreviewTransform &transform) {
+    if (entities.empty()) {
+        return;
+    }
+    PaintState &state = paintState();
+    const bool savedTransformedPreview = state.transformedPreview;
+    state.transformedPreview = true;
+
+    if (!renderTransformedCached(painter, entities, transform)) {
+        // the clip rect is mapped back to the entities, so entities are culled as usual
+        const LC_Rect savedClipRect = state.boundingClipRect;
+        LC_Rect entitiesClipRect = mapRect(savedClipRect, transform.inverted());
+
+        painter->pushInstanceTransform(transform.getOrigin(), transform.getUnitX(), transform.getUnitY(),
+                                       transform.getScale());
+        painter->setWorldBoundingRect(entitiesClipRect);
+        state.boundingClipRect = entitiesClipRect;
+        drawTransformedEntities(painter, entities);
+        state.boundingClipRect = savedClipRect;
+        painter->popInstanceTransform();
+    }
+
+    state.transformedPreview = savedTransformedPreview;
+    state.lastPaintEntityPen = RS_Pen();
+}
+
+void LC_GraphicViewportRenderer::drawTransformedEntities(RS_Painter *painter, const std::vector<RS_Entity*> &entities) {
+    PaintState &state = paintState();
+    // entities are drawn in the pen of the preview, which is forced for the children of containers as well
+    const RS_Pen pen = painter->getPen();
+    const bool savedForcePen = state.forcePen;
+    const RS_Pen savedForcedPen = state.forcedPen;
+    state.forcePen = true;
+    state.forcedPen = pen;
+    for (RS_Entity *e: entities) {
+        if (!isEntityVisible(e) || isOutsideOfBoundingClipRect(e, e->isConstruction())) {
+            continue;
+        }
+        painter->setPen(pen);
+        e->draw(painter);
+    }
+    state.forcePen = savedForcePen;
+    state.forcedPen = savedForcedPen;
+    state.lastPaintEntityPen = RS_Pen();
+    painter->setPen(pen);
+}
+
+/**
+ * The image of the selection covers the view, extended by the half of its size at each side, so selections, which
+ * don't fit there, are drawn directly. The image is scaled by scaling transforms, as it's drawn for the view.
+ */
+bool LC_GraphicViewportRenderer::renderTransformedCached(RS_Painter *painter, const std::vector<RS_Entity*> &entities,
+                                                         const LC_PreviewTransform &transform) {
+    if (m_previewCacheMinEntities <= 0 || entities.size() < static_cast<std::size_t>(m_previewCacheMinEntities)) {
+        return false;
+    }
+
+    const RS_Vector uiOrigin = painter->toGui(RS_Vector(0., 0.));
+    const RS_Vector uiUnitX = painter->toGui(RS_Vector(1., 0.)) - uiOrigin;
+    const RS_Vector uiUnitY = painter->toGui(RS_Vector(0., 1.)) - uiOrigin;
+    const QSize viewSize{viewport->getWidth(), viewport->getHeight()};
+    const QPen pen = painter->pen();
+    const bool antialiasing = painter->testRenderHint(QPainter::Antialiasing);
+
+    std::vector<unsigned long> entityIds;
+    entityIds.reserve(entities.size());
+    for (const RS_Entity *e: entities) {
+        entityIds.push_back(e->getId());
+    }
+
+    std::unique_ptr<TransformedPreviewCache> &cache = m_transformedPreviewCache;
+    if (cache == nullptr || cache->entityIds != entityIds || !(cache->uiOrigin == uiOrigin)
+        || !(cache->uiUnitX == uiUnitX) || !(cache->uiUnitY == uiUnitY) || cache->viewSize != viewSize
+        || cache->pen != pen || cache->antialiasing != antialiasing) {
+        cache.reset();
+
+        RS_Vector wcsMin(false);
+        RS_Vector wcsMax(false);
+        for (const RS_Entity *e: entities) {
+            if (isEntityVisible(e)) {
+                wcsMin = wcsMin.valid ? RS_Vector::minimum(wcsMin, e->getMin()) : e->getMin();
+                wcsMax = wcsMax.valid ? RS_Vector::maximum(wcsMax, e->getMax()) : e->getMax();
+            }
+        }
+        if (!wcsMin.valid) {
+            return false;
+        }
+        QRectF uiBounds;
+        for (const RS_Vector &corner: {wcsMin, RS_Vector(wcsMax.x, wcsMin.y), wcsMax, RS_Vector(wcsMin.x, wcsMax.y)}) {
+            const RS_Vector uiCorner = painter->toGui(corner);
+            uiBounds |= QRectF(uiCorner.x, uiCorner.y, 0., 0.).adjusted(-1., -1., 1., 1.);
+        }
+        // line widths and point markers may exceed the borders of the entities
+        const QRect uiRect = uiBounds.toAlignedRect().adjusted(-16, -16, 16, 16);
+        const QRect uiLimit = QRect(QPoint(0, 0), viewSize).adjusted(-viewSize.width() / 2, -viewSize.height() / 2,
+                                                                     viewSize.width() / 2, viewSize.height() / 2);
+        if (!uiLimit.contains(uiRect)) {
+            return false;
+        }
+
+        auto created = std::make_unique<TransformedPreviewCache>();
+        created->image = QImage(uiRect.size(), QImage::Format_ARGB32_Premultiplied);
+        created->image.fill(Qt::transparent);
+        {
+            RS_Painter imagePainter(&created->image);
+            setupPainter(&imagePainter);
+            imagePainter.setTile(uiRect.topLeft(), viewSize, painter->getDpmm());
+            imagePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
+            imagePainter.setPen(painter->getPen());
+
+            PaintState &state = paintState();
+            const LC_Rect savedClipRect = state.boundingClipRect;
+            LC_Rect imageClipRect = prepareBoundingClipRect(uiRect.left(), uiRect.top(), uiRect.right(), uiRect.bottom());
+            imagePainter.setWorldBoundingRect(imageClipRect);
+            state.boundingClipRect = imageClipRect;
+            drawTransformedEntities(&imagePainter, entities);
+            state.boundingClipRect = savedClipRect;
+        }
+        created->entityIds = std::move(entityIds);
+        created->uiOrigin = uiOrigin;
+        created->uiUnitX = uiUnitX;
+        created->uiUnitY = uiUnitY;
+        created->viewSize = viewSize;
+        created->pen = pen;
+        created->antialiasing = antialiasing;
+        created->uiTopLeft = uiRect.topLeft();
+        cache = std::move(created);
+    }
+
+    m_transformedPreviewCacheUsed = true;
+    painter->pushInstanceTransform(transform.getOrigin(), transform.getUnitX(), transform.getUnitY(),
+                                   transform.getScale());
+    const bool smooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawImage(cache->uiTopLeft, cache->image);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+    painter->popInstanceTransform();
+    return true;
+}
+
+RS_Pen LC_GraphicViewportRenderer::resolvePen(const RS_Entity *e) const {
+    const std::vector<InstanceContext> &contexts = paintState().instanceContexts;
+    if (contexts.empty()) {
+        return e->getPenResolved();
+    }
+    const InstanceContext &context = contexts.back();
+    return context.insert->getInstancePen(e, context.pen, context.layer);
+}
+
+RS_Layer* LC_GraphicViewportRenderer::resolveLayer(const RS_Entity *e) const {
+    const std::vector<InstanceContext> &contexts = paintState().instanceContexts;
+    if (contexts.empty()) {
+        return e->getLayerResolved();
+    }
+    const InstanceContext &context = contexts.back();
+    return context.insert->getInstanceLayer(e, context.layer);
+}
+
+bool LC_GraphicViewportRenderer::isEntityVisible(const RS_Entity *e) const {
+    const std::vector<InstanceContext> &contexts = paintState().instanceContexts;
+    if (contexts.empty()) {
+        return e->isVisible();
+    }
+    // entities of the block are on the layer of the insert, if they are on layer "0"
+    if (!e->getFlag(RS2::FlagVisible) || e->isUndone()) {
+        return false;
+    }
+    const RS_Layer *layer = resolveLayer(e);
+    if (layer != nullptr && layer->isFrozen()) {
+        return false;
+    }
+    if (e->rtti() == RS2::EntityInsert) {
+        const RS_Block *block = static_cast<const RS_Insert *>(e)->getBlockForInsert();
+        return block == nullptr || !block->isFrozen();
+    }
+    return true;
+}
+
+bool LC_GraphicViewportRenderer::isEntityPrinted(const RS_Entity *e) const {
+    const std::vector<InstanceContext> &contexts = paintState().instanceContexts;
+    if (contexts.empty()) {
+        return e->isPrint();
+    }
+    const RS_Layer *layer = resolveLayer(e);
+    return layer == nullptr || layer->isPrint();
+}
+
+bool LC_GraphicViewportRenderer::isEntitySelected(const RS_Entity *e) const {
+    const PaintState &state = paintState();
+    if (state.transformedPreview) {
+        return false;
+    }
+    const std::vector<InstanceContext> &contexts = state.instanceContexts;
+    return e->getFlag(RS2::FlagSelected) || (!contexts.empty() && contexts.back().selected);
+}
+
+bool LC_GraphicViewportRenderer::isEntityHighlighted(const RS_Entity *e) const {
+    const PaintState &state = paintState();
+    if (state.transformedPreview) {
+        return false;
+    }
+    const std::vector<InstanceContext> &contexts = state.instanceContexts;
+    return e->getFlag(RS2::FlagHighlighted) || (!contexts.empty() && contexts.back().highlighted);
+}
+
+bool LC_GraphicViewportRenderer::isEntityTransparent(const RS_Entity *e) const {
+    const std::vector<InstanceContext> &contexts = paintState().instanceContexts;
+    return e->getFlag(RS2::FlagTransparent) || (!contexts.empty() && contexts.back().transparent);
 }
 
 void LC_GraphicViewportRenderer::updateEndCapsStyle(const RS_Graphic *graphic) {//        Lineweight endcaps setting for new objects:
@@ -206,7 +508,7 @@ void LC_GraphicViewportRenderer::setupPainter(RS_Painter *painter) {
     painter->updatePointsScreenSize(pdsize);
     painter->setPointsMode(pdmode);
     painter->setDefaultWidthFactor(defaultWidthFactor);
-    painter->setWorldBoundingRect(renderBoundingClipRect);
+    painter->setWorldBoundingRect(paintState().boundingClipRect);
 }
 
 bool LC_GraphicViewportRenderer::isTextLineNotRenderable([[maybe_unused]]double d) const {
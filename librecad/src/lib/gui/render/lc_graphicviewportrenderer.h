@@ -23,20 +23,19 @@
 #ifndef LC_GRAPHICVIEWPORTRENDERER_H
 #define LC_GRAPHICVIEWPORTRENDERER_H
 
+#include <memory>
+#include <vector>
+
 #include "lc_rect.h"
 #include "rs_color.h"
 #include "rs_pen.h"
 
-#define DEBUG_RENDERING_
-
-#ifdef DEBUG_RENDERING
-#include <QElapsedTimer>
-
-#define DEBUG_RENDERING_DETAILS
-#endif
-
 class LC_GraphicViewport;
+class LC_PreviewTransform;
+class RS_Block;
 class RS_Entity;
+class RS_Insert;
+class RS_Layer;
 class RS_Painter;
 class RS_Graphic;
 class QPaintDevice;
@@ -44,14 +43,25 @@ class QPaintDevice;
 class LC_GraphicViewportRenderer{
   public:
     explicit LC_GraphicViewportRenderer(LC_GraphicViewport* viewport, QPaintDevice* painterDevice);
-    virtual ~LC_GraphicViewportRenderer() = default;
+    virtual ~LC_GraphicViewportRenderer();
     virtual void loadSettings();
     void render();
     virtual void renderEntity(RS_Painter* painter, RS_Entity* entity)  = 0;
     void renderEntityAsChild(RS_Painter *painter, RS_Entity *e) ;
     void justDrawEntity(RS_Painter *painter, RS_Entity *e);
+    /**
+     * Draws entities of the block as the given column and row of the instanced insert
+     */
+    void renderInsertInstance(RS_Painter *painter, RS_Insert *insert, RS_Block *block, int col, int row);
+    /**
+     * Draws the entities through the transform, in the current pen of the painter, as the preview of their
+     * transformed copies. Selection and highlighting of the entities are ignored.
+     * Selections of at least m_previewCacheMinEntities entities are drawn once into an image, which is drawn
+     * through the transform, while the view and the selection don't change.
+     */
+    void renderTransformed(RS_Painter *painter, const std::vector<RS_Entity*> &entities, const LC_PreviewTransform &transform);
     void setBackground(const RS_Color &bg);
-    const LC_Rect &getBoundingClipRect() const {return renderBoundingClipRect;}
+    const LC_Rect &getBoundingClipRect() const {return paintState().boundingClipRect;}
 
     virtual bool isTextLineNotRenderable(double uiLineHeight) const = 0;
 
@@ -67,16 +77,46 @@ protected:
     LC_GraphicViewport* viewport = nullptr;
     RS_Graphic* graphic = nullptr;
 
-    LC_Rect renderBoundingClipRect;
-
     /** background color (any color) */
     RS_Color m_colorBackground;
     /** foreground color (black or white) */
     RS_Color m_colorForeground;
 
-    RS_Pen lastPaintEntityPen = {};
+    // attributes of an instanced insert, which are inherited by the block entities drawn for it
+    struct InstanceContext {
+        RS_Insert* insert = nullptr;
+        RS_Pen pen;
+        RS_Layer* layer = nullptr;
+        bool selected = false;
+        bool highlighted = false;
+        bool transparent = false;
+    };
+
+    /**
+     * The state, which changes while entities are drawn by a painter. Tiles of the view are drawn concurrently, so
+     * each thread drawing a tile has its own state, while other painters use the state of the renderer.
+     */
+    struct PaintState {
+        LC_Rect boundingClipRect;
+        RS_Pen lastPaintEntityPen = {};
+        bool lastPaintedHighlighted = false;
+        bool lastPaintedSelected = false;
+        bool lastPaintOverlay = false;
+        std::vector<InstanceContext> instanceContexts;
+        // original entities are drawn as the preview of their transformed copies
+        bool transformedPreview = false;
+        // all entities, including children of containers and instances, are drawn in the forced pen
+        bool forcePen = false;
+        RS_Pen forcedPen = {};
+    };
+
+    PaintState& paintState() const {return threadPaintState != nullptr ? *threadPaintState : m_paintState;}
+    // the state of the tile, drawn by the current thread
+    static thread_local PaintState* threadPaintState;
 
     LC_Rect prepareBoundingClipRect();
+    // the bounding rect of an area of the view, given in ui coordinates
+    LC_Rect prepareBoundingClipRect(int uiLeft, int uiTop, int uiRight, int uiBottom);
     virtual void doRender() = 0;
 
     // painting cached values
@@ -96,6 +136,9 @@ protected:
     double m_angleBasisBaseAngle = 0.0;
     bool m_angleBasisCounterClockwise = false;
 
+    // the smallest selection, which is cached as an image for transformed previews; 0 disables the cache
+    int m_previewCacheMinEntities = 0;
+
     virtual void setupPainter(RS_Painter *painter);
     virtual void updateGraphicRelatedSettings(RS_Graphic *g);
     void updateEndCapsStyle(const RS_Graphic *graphic);
@@ -104,28 +147,32 @@ protected:
     void updateUnitAndDefaultWidthFactors(const RS_Graphic *g);
     bool isOutsideOfBoundingClipRect(RS_Entity *e, bool constructionEntity);
 
-    RS_Graphic* getGraphic(){return graphic;}
+    // entity attributes, resolved for entities of blocks drawn as instances
+    bool isInInstance() const {return !paintState().instanceContexts.empty();}
+    RS_Pen resolvePen(const RS_Entity *e) const;
+    RS_Layer* resolveLayer(const RS_Entity *e) const;
+    bool isEntityVisible(const RS_Entity *e) const;
+    bool isEntityPrinted(const RS_Entity *e) const;
+    bool isEntitySelected(const RS_Entity *e) const;
+    bool isEntityHighlighted(const RS_Entity *e) const;
+    bool isEntityTransparent(const RS_Entity *e) const;
 
-#ifdef DEBUG_RENDERING
-    QElapsedTimer drawTimer;
-    QElapsedTimer isVisibleTimer;
-    QElapsedTimer setPenTimer;
-    QElapsedTimer painterSetPenTimer;
-    QElapsedTimer getPenTimer;
-    QElapsedTimer isConstructionTimer;
-
-    // painting debug
-    int drawEntityCount = 1;
-    long long entityDrawTime = 0;
-    long long isVisibleTime = 0;
-    long long isConstructionTime = 0;
-    long long setPenTime = 0;
-    long long painterSetPenTime = 0;
-    long long getPenTime = 0;
-#endif
+    RS_Graphic* getGraphic(){return graphic;}
 
+    // overlays are drawn between these calls; the cached image of a transformed preview, which is not drawn, is released
+    void beginTransformedPreviews();
+    void endTransformedPreviews();
 
     void updateAnglesBasis(RS_Graphic *g);
+private:
+    mutable PaintState m_paintState;
+
+    struct TransformedPreviewCache;
+    std::unique_ptr<TransformedPreviewCache> m_transformedPreviewCache;
+    bool m_transformedPreviewCacheUsed = false;
+
+    void drawTransformedEntities(RS_Painter *painter, const std::vector<RS_Entity*> &entities);
+    bool renderTransformedCached(RS_Painter *painter, const std::vector<RS_Entity*> &entities, const LC_PreviewTransform &transform);
 };
 
 #endif // LC_GRAPHICVIEWPORTRENDERER_H
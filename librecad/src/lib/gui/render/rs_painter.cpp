@@ -86,11 +86,12 @@ const QColor qcolorWhite = colorWhite.toQColor();
         }
     }
 
-    // RAII style QPainter
+    // RAII style painter state, saved and restored through RS_Painter, so batched primitives are drawn before
+    // the state changes
     class PainterGuard {
-        QPainter* m_painter = nullptr;
+        RS_Painter* m_painter = nullptr;
     public:
-    PainterGuard(QPainter& painter):
+    PainterGuard(RS_Painter& painter):
             m_painter{&painter}
         {
         painter.save();
@@ -127,7 +128,7 @@ const QColor qcolorWhite = colorWhite.toQColor();
         painter.drawLine(left, right);
     }
 
-    void drawOctagon(QPainter& painter, const QPointF& uiPos, int halfSize)
+    void drawOctagon(RS_Painter& painter, const QPointF& uiPos, int halfSize)
     {
         QPointF dr0(double(halfSize), std::sin(M_PI/8.) * halfSize);
         std::vector<QPointF> vertices{{dr0, dr0.transposed()}};
@@ -145,7 +146,7 @@ const QColor qcolorWhite = colorWhite.toQColor();
         painter.drawPolygon(octagon);
     }
 
-    void drawSquare(QPainter& painter, const QPointF& uiPos, int halfSize)
+    void drawSquare(RS_Painter& painter, const QPointF& uiPos, int halfSize)
     {
         auto dr0 = QPoint(halfSize, halfSize).toPointF();
         auto dr1 = QPoint(- halfSize, halfSize).toPointF();
@@ -165,6 +166,12 @@ RS_Painter::RS_Painter( QPaintDevice* pd)
 {
 }
 
+RS_Painter::~RS_Painter()
+{
+    // QPainter ends painting after this destructor
+    flushBatch();
+}
+
 /**
  * Draws a grid point at (x1, y1).
  */
@@ -178,7 +185,7 @@ void RS_Painter::drawGridPoint(const double &x, const double &y) {
 
 void RS_Painter::drawPointEntityWCS(const RS_Vector& wcsPos) {
     RS_Vector uiPos = toGui(wcsPos);
-    drawPointEntityUI(uiPos, pointsMode, screenPointsSize);
+    drawPointEntityScreenSized(uiPos, pointsMode, screenPointsSize);
 }
 
 void RS_Painter::drawRefPointEntityWCS(const RS_Vector &wcsPos, int pdMode, double pdSize){
@@ -186,7 +193,24 @@ void RS_Painter::drawRefPointEntityWCS(const RS_Vector &wcsPos, int pdMode, doub
     int screenPDSize = determinePointScreenSize(pdSize);
     double uiX, uiY;
     toGui(wcsPos, uiX, uiY);
-    drawPointEntityUI({uiX, uiY},  pdMode, screenPDSize);
+    drawPointEntityScreenSized({uiX, uiY},  pdMode, screenPDSize);
+}
+
+/**
+ * Point markers have the size in pixels, so within instances they are drawn without the instance transform.
+ */
+void RS_Painter::drawPointEntityScreenSized(const RS_Vector& uiPos, int pdmode, int pdsize) {
+    if (instanceTransforms.empty()) {
+        drawPointEntityUI(uiPos, pdmode, pdsize);
+        return;
+    }
+    const QTransform instanceTransform = worldTransform();
+    const QTransform& baseTransform = instanceTransforms.front().worldTransform;
+    const QPointF pos = baseTransform.inverted().map(instanceTransform.map(QPointF(uiPos.x, uiPos.y)));
+    flushBatch();
+    setWorldTransform(baseTransform);
+    drawPointEntityUI({pos.x(), pos.y()}, pdmode, pdsize);
+    setWorldTransform(instanceTransform);
 }
 
 /**
@@ -289,10 +313,26 @@ void RS_Painter::drawLineUISimple(const double &x1, const double &y1, const doub
 
 void RS_Painter::drawLineUI(const double &x1, const double &y1, const double &x2, const double &y2){
     if(QPointF(x2-x1, y2-y1).manhattanLength() > minLineDrawingLen) {
-        QPainter::drawLine(QPointF(x1, y1),QPointF(x2, y2));
+        if (canBatch()) {
+            const QLineF line(x1, y1, x2, y2);
+            batchedLines.push_back(batchTransformed ? batchTransform.map(line) : line);
+            flushFullBatch();
+        }
+        else {
+            QPainter::drawLine(QPointF(x1, y1),QPointF(x2, y2));
+        }
     }
     else{
-        QPainter::drawPoint(QPointF(x1, y1));
+        drawPointUI(QPointF(x1, y1));
+    }
+}
+
+void RS_Painter::drawPointUI(const QPointF& uiPos) {
+    if (canBatch()) {
+        batchedPoints.push_back(batchTransformed ? batchTransform.map(uiPos) : uiPos);
+    }
+    else {
+        QPainter::drawPoint(uiPos);
     }
 }
 
@@ -300,8 +340,19 @@ void RS_Painter::drawLineUI(const double &x1, const double &y1, const double &x2
 
 
 void RS_Painter::drawEntityArc(RS_Arc* arc) {
+    if (canBatch() && !batchTransformed) {
+        // every way of drawing an arc starts a new subpath
+        drawArcEntity(arc, batchedPath);
+        flushFullBatch();
+        return;
+    }
     QPainterPath path;
     drawArcEntity(arc, path);
+    if (canBatch()) {
+        batchedPath.addPath(batchTransform.map(path));
+        flushFullBatch();
+        return;
+    }
     QPainter::drawPath(path);
 }
 
@@ -338,7 +389,7 @@ void RS_Painter::drawArcEntity(RS_Arc* arc, QPainterPath &path){
     RS_Vector uiRadii { toGuiDX(radius),  toGuiDY(radius)};
 
     if(uiRadii.x<=minArcDrawingRadius) { // draw just a point
-        QPainter::drawPoint(QPointF{uiCenter.x, uiCenter.y});
+        drawPointUI(QPointF{uiCenter.x, uiCenter.y});
     }
     else if (arcRenderInterpolate){ // draw arc interpolated by lines
         drawArcInterpolatedByLines(uiCenter, uiRadii.x, toUCSAngleDegrees(arc->getData().startAngleDegrees), arc->getData().angularLength, path);
@@ -693,7 +744,6 @@ void RS_Painter::drawEllipseUI(const RS_Vector& uiCenter, const RS_Vector& uiRad
         } else {
             QPainter::drawEllipse(QRectF{- radii, radii});
         }
-        restore();
     }
 }
 
@@ -914,7 +964,9 @@ void RS_Painter::drawSplinePointsUI(const std::vector<RS_Vector> &uiControlPoint
 }
 
 void RS_Painter::drawEntityPolyline(const RS_Polyline* polyline){
-    QPainterPath path;
+    const bool batched = canBatch();
+    QPainterPath polylinePath;
+    QPainterPath& path = batched && !batchTransformed ? batchedPath : polylinePath;
     double startX, startY, endX, endY;
     toGui(polyline->getStartpoint(), startX, startY);
     path.moveTo(startX, startY);
@@ -956,28 +1008,33 @@ void RS_Painter::drawEntityPolyline(const RS_Polyline* polyline){
                 LC_ERR<<"Polyline may contain lines/arcs only: found rtti() ="<<entity->rtti();
         }
     }
-    QPainter::drawPath(path);
+    if (batched) {
+        if (batchTransformed) {
+            batchedPath.addPath(batchTransform.map(path));
+        }
+        flushFullBatch();
+    }
+    else {
+        QPainter::drawPath(path);
+    }
 }
 
-void RS_Painter::drawSplineWCS(const RS_Spline& spline){
+void RS_Painter::drawSplineWCS(const std::vector<RS_Vector>& wcsPoints){
+    if (wcsPoints.size() < 2) {
+        return;
+    }
     QPainterPath path;
-    unsigned int count = spline.count();
-    if (count > 0) {
-        RS_Entity *child = spline.unsafeEntityAt(0);
-        double uiX, uiY;
-        toGui(child->getStartpoint(), uiX, uiY);
-        path.moveTo(uiX, uiY);
-        for (unsigned int i = 0; i < count;i++) {
-            child = spline.unsafeEntityAt(i);
-            toGui(child->getEndpoint(), uiX, uiY);
-            path.lineTo(uiX, uiY);
-        }
+    double uiX, uiY;
+    toGui(wcsPoints.front(), uiX, uiY);
+    path.moveTo(uiX, uiY);
+    for (size_t i = 1; i < wcsPoints.size(); i++) {
+        toGui(wcsPoints[i], uiX, uiY);
+        path.lineTo(uiX, uiY);
     }
-
     QPainter::drawPath(path);
 }
 
-void RS_Painter::drawImgWCS(QImage& img, const RS_Vector& wcsInsertionPoint,
+void RS_Painter::drawImgWCS(const QImage& img, const RS_Vector& wcsInsertionPoint,
                            const RS_Vector& uVector, const RS_Vector& vVector) {
 
 //    if (viewport->hasUCS()) {
@@ -1000,8 +1057,9 @@ void RS_Painter::drawImgWCS(QImage& img, const RS_Vector& wcsInsertionPoint,
     drawImgUI(img, uiInsert, ucsUVector, ucsVVector, scale);
 }
 
-void RS_Painter::drawImgUI(QImage& img, const RS_Vector& uiInsert,
+void RS_Painter::drawImgUI(const QImage& img, const RS_Vector& uiInsert,
                            const RS_Vector& uVector, const RS_Vector& vVector, const RS_Vector& factor) {
+    flushBatch();
     save();
 
 //    LC_ERR << "IMG FACTOR " << factor;
@@ -1027,7 +1085,7 @@ void RS_Painter::drawImgUI(QImage& img, const RS_Vector& uiInsert,
     }
 
     wm->scale(factor.x, factor.y);
-    setWorldTransform(*wm);
+    setWorldTransform(*wm, true);
 
     drawImage(0,-img.height(), img);
 
@@ -1054,6 +1112,7 @@ void RS_Painter::drawTextV(int x1, int y1,
 
 void RS_Painter::fillRect(int x1, int y1, int w, int h,
                             const RS_Color& col) {
+    flushBatch();
     QPainter::fillRect(x1, y1, w, h, col);
 }
 
@@ -1062,6 +1121,7 @@ void RS_Painter::fillPolygonUI( const QPolygonF& uiPolygon)
     if (uiPolygon.size() <= 2)
         return;
 
+    flushBatch();
     const QBrush brushSaved = brush();
     setBrushColor(RS_Color(pen().color()));
     QPainter::drawPolygon(uiPolygon, Qt::OddEvenFill);
@@ -1072,6 +1132,7 @@ void RS_Painter::fillTriangleUI(
     const RS_Vector &uiP1,
     const RS_Vector &uiP2,
     const RS_Vector &uiP3) {
+    flushBatch();
     QPolygonF arr;
     QBrush brushSaved = brush();
     arr.append({uiP1.x, uiP1.y});
@@ -1083,6 +1144,7 @@ void RS_Painter::fillTriangleUI(
 }
 
 void RS_Painter::fillTriangleUI(double uiX1, double uiY1, double uiX2, double uiY2, double uiX3, double uiY3) {
+    flushBatch();
     QPolygonF arr;
     QBrush brushSaved = brush();
     arr.append({uiX1, uiY1});
@@ -1095,11 +1157,12 @@ void RS_Painter::fillTriangleUI(double uiX1, double uiY1, double uiX2, double ui
 
 
 void RS_Painter::erase() {
+    flushBatch();
     QPainter::eraseRect(0,0,getWidth(),getHeight());
 }
 
 int RS_Painter::getWidth() const{
-    return device()->width();
+    return tileDeviceSize.isValid() ? tileDeviceSize.width() : device()->width();
 }
 
 /** get Density per millimeter on screen/print device
@@ -1113,7 +1176,7 @@ double RS_Painter::getDpmm() const{
 }
 
 int RS_Painter::getHeight() const{
-    return device()->height();
+    return tileDeviceSize.isValid() ? tileDeviceSize.height() : device()->height();
 }
 
 
@@ -1122,6 +1185,7 @@ RS_Pen RS_Painter::getPen() const{
 }
 
 void RS_Painter::noCapStyle(){
+    flushBatch();
     QPen pen = QPainter::pen();
     pen.setCapStyle(Qt::PenCapStyle::FlatCap);
     QPainter::setPen(pen);
@@ -1164,6 +1228,10 @@ void RS_Painter::setPen(const RS_Pen& pen) {
             p.setDashOffset(newDashOffset);
             p.setJoinStyle(penJoinStyle);
             p.setCapStyle(penCapStyle);
+            p.setCosmetic(!instanceTransforms.empty());
+            if (p != lastUsedPen) {
+                flushBatch();
+            }
             lastUsedPen = p;
             QPainter::setPen(p);
             return;
@@ -1184,15 +1252,23 @@ void RS_Painter::setPen(const RS_Pen& pen) {
         lastUsedPen.setStyle(style);
         changed = true;
     }
+    // widths are in pixels, so they are not scaled by instance transforms
+    const bool cosmetic = !instanceTransforms.empty();
+    if (lastUsedPen.isCosmetic() != cosmetic){
+        lastUsedPen.setCosmetic(cosmetic);
+        changed = true;
+    }
     lastUsedPen.setJoinStyle(penJoinStyle);
     lastUsedPen.setCapStyle(penCapStyle);
 
     if (changed){
+        flushBatch();
         QPainter::setPen(lastUsedPen);
     }
 }
 
 void RS_Painter::setPen(const RS_Color& color) {
+    flushBatch();
     switch (drawingMode) {
         case RS2::ModeBW: {
             const RS_Color &color = RS_Color(Qt::black);
@@ -1214,6 +1290,7 @@ void RS_Painter::setPen(const RS_Color& color) {
 }
 
 void RS_Painter::setPen(int r, int g, int b) {
+    flushBatch();
     switch (drawingMode) {
         case RS2::ModeBW: {
             RS_Color color = RS_Color(Qt::black);
@@ -1237,12 +1314,14 @@ void RS_Painter::setPen(int r, int g, int b) {
 }
 
 void RS_Painter::disablePen() {
+    flushBatch();
     lpen = RS_Pen(RS2::FlagInvalid);
     QPainter::setPen(Qt::NoPen);
 }
 
 
 void RS_Painter::setBrushColor(const RS_Color& color) {
+    flushBatch();
     switch (drawingMode) {
         case RS2::ModeBW:
             QPainter::setBrush( QColor( Qt::black));
@@ -1259,6 +1338,7 @@ void RS_Painter::setBrushColor(const RS_Color& color) {
 }
 
 void RS_Painter::fillPath ( const QPainterPath & path, const QBrush& brush){
+    flushBatch();
     QPainter::fillPath(path, brush);
 }
 void RS_Painter::drawPath ( const QPainterPath & path ) {
@@ -1266,15 +1346,18 @@ void RS_Painter::drawPath ( const QPainterPath & path ) {
 }
 
 void RS_Painter::setClipRect(int x, int y, int w, int h) {
+    flushBatch();
     QPainter::setClipRect(x, y, w, h);
     setClipping(true);
 }
 
 void RS_Painter::resetClipping() {
+    flushBatch();
     setClipping(false);
 }
 
 void RS_Painter::fillRect ( const QRectF & rectangle, const RS_Color & color ) {
+    flushBatch();
 
     double x1=rectangle.left();
     double x2=rectangle.right();
@@ -1285,6 +1368,7 @@ void RS_Painter::fillRect ( const QRectF & rectangle, const RS_Color & color ) {
     QPainter::fillRect(x1,y1,x2-x1,y2-y1, color);
 }
 void RS_Painter::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
+    flushBatch();
   /*  double x1=rectangle.left();
     double x2=rectangle.right();
     double y1=rectangle.top();
@@ -1353,13 +1437,18 @@ void RS_Painter::setMinRenderableTextHeightInPx(int i) {
 }
 
 void RS_Painter::updateDashOffset(RS_Entity *e) {
+    if (lpen.getLineType() != RS2::SolidLine)
+        updateDashOffset(e->getLength());
+}
+
+void RS_Painter::updateDashOffset(double length) {
     // Adjust dash offset
     if (lpen.getLineType() == RS2::SolidLine /*|| view.getGraphic() == nullptr*/)
         return;
 
     // factor from model space to GUI
     const double toMm = defaultWidthFactor;
-    currenPatternOffset -= e->getLength() * toMm;
+    currenPatternOffset -= length * toMm;
 }
 
 int RS_Painter::determinePointScreenSize(double pdsize) const{
@@ -1439,8 +1528,96 @@ void RS_Painter::drawAsChild(RS_Entity* entity)
     renderer->renderEntityAsChild(this, entity);
 }
 
+void RS_Painter::drawInsertInstance(RS_Insert* insert, RS_Block* block, int col, int row)
+{
+    renderer->renderInsertInstance(this, insert, block, col, row);
+}
+
+void RS_Painter::drawTransformed(const std::vector<RS_Entity*>& entities, const LC_PreviewTransform& transform)
+{
+    renderer->renderTransformed(this, entities, transform);
+}
+
+void RS_Painter::pushInstanceTransform(const RS_Vector& wcsOrigin, const RS_Vector& wcsUnitX,
+                                       const RS_Vector& wcsUnitY, double scale) {
+    if (instanceTransforms.empty() && worldTransform().type() > QTransform::TxTranslate) {
+        // cosmetic pens of instances are drawn differently from pens outside of them
+        flushBatch();
+    }
+    instanceTransforms.push_back({worldTransform(), wcsBoundingRect,
+                                  minCircleDrawingRadius, minArcDrawingRadius, minEllipseMajorRadius,
+                                  minEllipseMinorRadius, minLineDrawingLen, instanceScale});
+
+    // entities are mapped to the screen by toGui(), so the instance transform is applied in screen coordinates:
+    // screen point of the block -> block point -> world point -> screen point
+    const RS_Vector uiOrigin = toGui(RS_Vector(0., 0.));
+    const RS_Vector uiUnitX = toGui(RS_Vector(1., 0.)) - uiOrigin;
+    const RS_Vector uiUnitY = toGui(RS_Vector(0., 1.)) - uiOrigin;
+    const QTransform toGuiTransform(uiUnitX.x, uiUnitX.y, uiUnitY.x, uiUnitY.y, uiOrigin.x, uiOrigin.y);
+
+    const RS_Vector uiInstanceOrigin = toGui(wcsOrigin);
+    const RS_Vector uiInstanceUnitX = toGui(wcsUnitX) - uiInstanceOrigin;
+    const RS_Vector uiInstanceUnitY = toGui(wcsUnitY) - uiInstanceOrigin;
+    const QTransform instanceToGuiTransform(uiInstanceUnitX.x, uiInstanceUnitX.y, uiInstanceUnitY.x, uiInstanceUnitY.y,
+                                            uiInstanceOrigin.x, uiInstanceOrigin.y);
+
+    setWorldTransform(toGuiTransform.inverted() * instanceToGuiTransform, true);
+
+    // level of details thresholds are in pixels of the screen
+    instanceScale *= scale;
+    minCircleDrawingRadius /= scale;
+    minArcDrawingRadius /= scale;
+    minEllipseMajorRadius /= scale;
+    minEllipseMinorRadius /= scale;
+    minLineDrawingLen /= scale;
+
+    QPen pen = QPainter::pen();
+    pen.setCosmetic(true);
+    lastUsedPen.setCosmetic(true);
+    QPainter::setPen(pen);
+    updateBatchTransform();
+}
+
+void RS_Painter::popInstanceTransform() {
+    if (instanceTransforms.empty()) {
+        return;
+    }
+    if (instanceTransforms.size() == 1 && instanceTransforms.front().worldTransform.type() > QTransform::TxTranslate) {
+        flushBatch();
+    }
+    const InstanceTransform& saved = instanceTransforms.back();
+    setWorldTransform(saved.worldTransform);
+    wcsBoundingRect = saved.wcsBoundingRect;
+    minCircleDrawingRadius = saved.minCircleDrawingRadius;
+    minArcDrawingRadius = saved.minArcDrawingRadius;
+    minEllipseMajorRadius = saved.minEllipseMajorRadius;
+    minEllipseMinorRadius = saved.minEllipseMinorRadius;
+    minLineDrawingLen = saved.minLineDrawingLen;
+    instanceScale = saved.instanceScale;
+    instanceTransforms.pop_back();
+
+    if (instanceTransforms.empty()) {
+        QPen pen = QPainter::pen();
+        pen.setCosmetic(false);
+        lastUsedPen.setCosmetic(false);
+        QPainter::setPen(pen);
+    }
+    updateBatchTransform();
+}
+
+/**
+ * Primitives are batched in the transform outside of instances, so instances drawn in the same pen one after another
+ * (e.g. letters of texts) share a batch instead of flushing it on each transform change.
+ */
+void RS_Painter::updateBatchTransform() {
+    batchTransformed = !instanceTransforms.empty();
+    if (batchTransformed) {
+        batchTransform = worldTransform() * instanceTransforms.front().worldTransform.inverted();
+    }
+}
+
 bool RS_Painter::isTextLineNotRenderable(double wcsLineHeight) const {
-    double uiHeight = toGuiDY(wcsLineHeight);
+    double uiHeight = toGuiDY(wcsLineHeight) * instanceScale;
     return renderer->isTextLineNotRenderable(uiHeight);
 }
 
@@ -1537,6 +1714,10 @@ double RS_Painter::toGuiDY(double ucsDY) const {
     return ucsDY * m_viewPortFactor.y;
 }
 
+double RS_Painter::toWcsLength(double uiLength) const {
+    return uiLength / (m_viewPortFactor.x * instanceScale);
+}
+
 void RS_Painter::disableUCS(){
     useUCS(false);
 }
@@ -1559,3 +1740,75 @@ bool RS_Painter::isFullyWithinBoundingRect(const LC_Rect &rect){
 const LC_Rect &RS_Painter::getWcsBoundingRect() const {
     return wcsBoundingRect;
 }
+
+void RS_Painter::setBatching(bool on) {
+    if (!on) {
+        flushBatch();
+    }
+    batching = on;
+}
+
+void RS_Painter::setTile(const QPoint& tileOrigin, const QSize& deviceSize, double deviceDpmm) {
+    flushBatch();
+    tileDeviceSize = deviceSize;
+    cachedDpmm = deviceDpmm;
+    setWorldTransform(QTransform::fromTranslate(-tileOrigin.x(), -tileOrigin.y()));
+}
+
+// translucent pens would darken overlaps of separately drawn primitives, but not within a single path
+bool RS_Painter::canBatch() const {
+    return batching && QPainter::brush().style() == Qt::NoBrush && QPainter::pen().color().alpha() == 255;
+}
+
+void RS_Painter::flushBatch() {
+    if (batchedLines.empty() && batchedPath.isEmpty() && batchedPoints.empty()) {
+        return;
+    }
+    const QTransform instanceTransform = worldTransform();
+    if (batchTransformed) {
+        setWorldTransform(instanceTransforms.front().worldTransform);
+    }
+    if (!batchedLines.empty()) {
+        QPainter::drawLines(batchedLines.data(), static_cast<int>(batchedLines.size()));
+        batchedLines.clear();
+    }
+    if (!batchedPath.isEmpty()) {
+        QPainter::drawPath(batchedPath);
+        batchedPath.clear();
+    }
+    if (!batchedPoints.empty()) {
+        QPainter::drawPoints(batchedPoints.data(), static_cast<int>(batchedPoints.size()));
+        batchedPoints.clear();
+    }
+    if (batchTransformed) {
+        setWorldTransform(instanceTransform);
+    }
+}
+
+// keeps the buffers and the paths passed to the rasterizer small
+void RS_Painter::flushFullBatch() {
+    constexpr std::size_t maxPrimitives = 4096;
+    if (batchedLines.size() >= maxPrimitives || static_cast<std::size_t>(batchedPath.elementCount()) >= maxPrimitives) {
+        flushBatch();
+    }
+}
+
+void RS_Painter::setBrush(const QBrush& brush) {
+    flushBatch();
+    QPainter::setBrush(brush);
+}
+
+void RS_Painter::setBrush(Qt::BrushStyle style) {
+    flushBatch();
+    QPainter::setBrush(style);
+}
+
+void RS_Painter::save() {
+    flushBatch();
+    QPainter::save();
+}
+
+void RS_Painter::restore() {
+    flushBatch();
+    QPainter::restore();
+}
@@ -28,8 +28,13 @@
 #ifndef RS_PAINTER_H
 #define RS_PAINTER_H
 
+#include <vector>
+
+#include <QLineF>
 #include <QPen>
 #include <QPainter>
+#include <QPainterPath>
+#include <QTransform>
 #include <Qt>
 
 #include "lc_coordinates_mapper.h"
@@ -41,11 +46,13 @@
 
 
 class RS_Arc;
+class RS_Block;
 class RS_Circle;
 class RS_Color;
 class RS_Ellipse;
 class RS_Entity;
 class RS_EntityContainer;
+class RS_Insert;
 class RS_Pen;
 class RS_Polyline;
 class RS_Spline;
@@ -61,6 +68,7 @@ class QString;
 
 class LC_GraphicViewport;
 class LC_GraphicViewportRenderer;
+class LC_PreviewTransform;
 
 struct LC_SplinePointsData;
 
@@ -76,7 +84,7 @@ struct LC_SplinePointsData;
 class RS_Painter: public QPainter, LC_CoordinatesMapper {
 public:
     explicit RS_Painter(QPaintDevice* pd);
-    ~RS_Painter() = default;
+    ~RS_Painter();
 
     enum ArcRenderHint{
         FULL_IN_VIEW,
@@ -90,6 +98,8 @@ public:
     RS_Vector toGui(const RS_Vector& worldCoordinates) const;
     double toGuiDX(double d) const;
     double toGuiDY(double d) const;
+    /** @return the length in world coordinates of the given length in pixels, also inside of inserts */
+    double toWcsLength(double uiLength) const;
 
     bool isPrinting() const
     {
@@ -107,6 +117,7 @@ public:
     void setViewPort(LC_GraphicViewport* v);
     void setRenderer(LC_GraphicViewportRenderer *r) {renderer = r;}
     void updateDashOffset(RS_Entity* e);
+    void updateDashOffset(double length);
     void clearDashOffset() {currenPatternOffset = 0.0;}
     double currentDashOffset() const {return currenPatternOffset;}
 
@@ -131,11 +142,11 @@ public:
     void drawSolidWCS(const RS_VectorSolutions& wcsVertices);
 
     void drawArcWCS(const RS_Vector &wcsCenter, double wcsRadius, double wcsStartAngleDegrees, double angularLength);
-    void drawSplineWCS(const RS_Spline &spline);
+    void drawSplineWCS(const std::vector<RS_Vector> &wcsPoints);
     void drawLineWCS(const RS_Vector &wcsP1, const RS_Vector &wcP2);
     void drawPolylineWCS(const RS_Polyline *polyline);
     void drawHandleWCS(const RS_Vector &wcsPosition, const RS_Color &c, int size = -1);
-    void drawImgWCS(QImage &img, const RS_Vector &wcsInsertionPoint, const RS_Vector &uVector, const RS_Vector &vVector);
+    void drawImgWCS(const QImage &img, const RS_Vector &wcsInsertionPoint, const RS_Vector &uVector, const RS_Vector &vVector);
 
     // drawing in screen coordinates
     void drawCircleUI(const RS_Vector& uiCenter, double uiRadius);
@@ -154,6 +165,43 @@ public:
     void drawAsChild(RS_Entity* entity);
     void drawInfiniteWCS(RS_Vector start, RS_Vector end);
 
+    // methods invoked from inserts drawn as instances of their blocks
+    void drawInsertInstance(RS_Insert* insert, RS_Block* block, int col, int row);
+    /**
+     * Entities drawn until popInstanceTransform() are in the coordinates of a block: the block origin and unit
+     * vectors are mapped to the given world points. The mapping must be a similarity with the given scale.
+     * Pens are cosmetic while an instance transform is active, and level of details thresholds are scaled, so
+     * entities are drawn as their transformed copies would be.
+     */
+    void pushInstanceTransform(const RS_Vector& wcsOrigin, const RS_Vector& wcsUnitX, const RS_Vector& wcsUnitY, double scale);
+    void popInstanceTransform();
+    bool hasInstanceTransform() const {return !instanceTransforms.empty();}
+
+    // method invoked from previews of transformed entities
+    void drawTransformed(const std::vector<RS_Entity*>& entities, const LC_PreviewTransform& transform);
+
+    /**
+     * While batching, lines, arcs and polylines drawn with an opaque pen and no brush are collected, and drawn with
+     * a single drawLines() and drawPath() call for all primitives of the same pen. Collected primitives are flushed
+     * when the pen, the brush, the transformation or the clipping changes, before fills and images, and when
+     * batching is disabled. Instance transforms don't flush them, as primitives of instances are mapped out of them.
+     */
+    void setBatching(bool on);
+    bool isBatching() const {return batching;}
+    void flushBatch();
+
+    /**
+     * Makes the painter draw a tile of a larger device. Ui coordinates remain the ones of the device, and sizes
+     * depending on the device, like the density or the size of points, are taken from the device.
+     */
+    void setTile(const QPoint& tileOrigin, const QSize& deviceSize, double deviceDpmm);
+
+    // state changes, which must flush the collected primitives first
+    void setBrush(const QBrush& brush);
+    void setBrush(Qt::BrushStyle style);
+    void save();
+    void restore();
+
     /**
      * Sets the drawing mode.
      */
@@ -273,6 +321,8 @@ protected:
     Qt::PenCapStyle penCapStyle = Qt::RoundCap;
     QPen lastUsedPen;
     double cachedDpmm = 0.;
+    // the size of the device, a tile of which is drawn
+    QSize tileDeviceSize;
     double minCircleDrawingRadius = 2.0;
     double minArcDrawingRadius = 0.8;
     double minEllipseMajorRadius = 2.;
@@ -306,6 +356,35 @@ protected:
     LC_GraphicViewportRenderer* renderer = nullptr;
     LC_GraphicViewport* viewport = nullptr;
 
+    // painter state replaced by pushInstanceTransform()
+    struct InstanceTransform {
+        QTransform worldTransform;
+        LC_Rect wcsBoundingRect;
+        double minCircleDrawingRadius = 0.;
+        double minArcDrawingRadius = 0.;
+        double minEllipseMajorRadius = 0.;
+        double minEllipseMinorRadius = 0.;
+        double minLineDrawingLen = 0.;
+        double instanceScale = 1.;
+    };
+    std::vector<InstanceTransform> instanceTransforms;
+    // scale of the current instance transform, relatively to the world
+    double instanceScale = 1.;
+
+    // primitives collected while batching, all of the current pen
+    bool batching = false;
+    std::vector<QLineF> batchedLines;
+    std::vector<QPointF> batchedPoints;
+    QPainterPath batchedPath;
+    // maps primitives of the current instance to the transform of the batch, which is the one outside of instances
+    QTransform batchTransform;
+    bool batchTransformed = false;
+
+    bool canBatch() const;
+    void updateBatchTransform();
+    void flushFullBatch();
+    void drawPointUI(const QPointF& uiPos);
+
 //    void drawPolygonF(const QPolygonF &a, Qt::FillRule rule);
     void debugOutPath(const QPainterPath &tmpPath) const;
     double getDpmmCached() const {return cachedDpmm;}
@@ -326,9 +405,10 @@ protected:
     void drawArc(double uiCenterX, double uiCenterY, double uiRadiusX, double uiRadiusY,
                  double uiStartAngleDegrees, double angularLength, QPainterPath &path) const;
     void drawLineUI(const double &x1, const double &y1, const double &x2, const double &y2);
-    void drawImgUI(QImage& img, const RS_Vector& uiInsert, const RS_Vector& uVector, const RS_Vector& vVector, const RS_Vector& factor);
+    void drawImgUI(const QImage& img, const RS_Vector& uiInsert, const RS_Vector& uVector, const RS_Vector& vVector, const RS_Vector& factor);
 
     void drawRectUI(const RS_Vector& p1, const RS_Vector& p2);
+    void drawPointEntityScreenSized(const RS_Vector& uiPos, int pdmode, int pdsize);
 
 
     void drawTextH(int x1, int y1, int x2, int y2,
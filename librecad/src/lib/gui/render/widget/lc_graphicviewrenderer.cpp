@@ -64,6 +64,7 @@ void LC_GraphicViewRenderer::loadSettings() {
     {
         drawTextsAsDraftForPreview = LC_GET_BOOL("DrawTextsAsDraftInPreview", true);
         drawTextsAsDraftForPanning = LC_GET_BOOL("DrawTextsAsDraftInPanning", true);
+        m_previewCacheMinEntities = LC_GET_INT("PreviewCacheMinEntities", 5000);
     }
     LC_GROUP_END();
 
@@ -89,28 +90,16 @@ void LC_GraphicViewRenderer::loadSettings() {
 
 void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
+    if (/*!e->isContainer() && */(isEntitySelected(e) != painter->shouldDrawSelected())) {
         return;
     }
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
     // entity is not visible:
-    bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
+    bool visible = isEntityVisible(e);
     if (!visible) {
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
         return;
@@ -179,8 +168,8 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
         }
     }
 
-    // draw reference points:
-    if (e->getFlag(RS2::FlagSelected)) {
+    // draw reference points (entities of instanced blocks have no own reference points):
+    if (!isInInstance() && e->getFlag(RS2::FlagSelected)) {
         if (!e->isParentSelected()) {
             drawEntityReferencePoints(painter, e);
         }
@@ -235,7 +224,7 @@ void LC_GraphicViewRenderer::doDrawLayerOverlays(RS_Painter *painter) {
     if (graphic != nullptr){ // fixme - sand - again, support for hatch dialog :(
         drawRelativeZero(painter);
     }
-    lastPaintEntityPen = RS_Pen();
+    paintState().lastPaintEntityPen = RS_Pen();
     drawOverlay(painter);
 }
 
@@ -257,6 +246,7 @@ void LC_GraphicViewRenderer::drawOverlay(RS_Painter *painter) {
     LC_OverlaysManager *overlaysManager = viewport->getOverlaysManager();
 
     inOverlayDrawing = true;
+    beginTransformedPreviews();
 
     drawEntitiesInOverlay(overlaysManager, painter, RS2::OverlayGraphics::OverlayEffects);
     drawOverlayEntitiesInOverlay(overlaysManager, painter, RS2::OverlayGraphics::OverlayEffects);
@@ -268,6 +258,7 @@ void LC_GraphicViewRenderer::drawOverlay(RS_Painter *painter) {
     drawEntitiesInOverlay(overlaysManager, painter, RS2::OverlayGraphics::InfoCursor);
     drawOverlayEntitiesInOverlay(overlaysManager, painter, RS2::OverlayGraphics::InfoCursor);
 
+    endTransformedPreviews();
     inOverlayDrawing = false;
 }
 
@@ -373,36 +364,33 @@ void LC_GraphicViewRenderer::setPenForOverlayEntity(RS_Painter *painter, RS_Enti
 }
 
 void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay) {
-#ifdef DEBUG_RENDERING
-    getPenTimer.start();
-#endif
+    PaintState &state = paintState();
+    // children of previewed containers are drawn in the pen of the preview
+    if (state.forcePen) {
+        painter->setPen(state.forcedPen);
+        return;
+    }
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
-#ifdef DEBUG_RENDERING
-    getPenTime += getPenTimer.nsecsElapsed();
-#endif
+    RS_Pen pen = resolvePen(e);
     RS_Pen originalPen = pen;
-    bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
+    bool highlighted = isEntityHighlighted(e);
+    bool selected = isEntitySelected(e);
     bool overlayPaint = inOverlay || inOverlayDrawing;
     // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
     // arbitrary QPainter::setPen was called between drawing entities.
     double patternOffset = painter->currentDashOffset();
-    if (lastPaintedHighlighted == highlighted && lastPaintedSelected == selected && lastPaintOverlay == overlayPaint) {
-        if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+    if (state.lastPaintedHighlighted == highlighted && state.lastPaintedSelected == selected && state.lastPaintOverlay == overlayPaint) {
+        if (state.lastPaintEntityPen.isSameAs(pen, patternOffset)) {
             return;
         }
     }
     else{
-        lastPaintedHighlighted = highlighted;
-        lastPaintedSelected = selected;
-        lastPaintOverlay = overlayPaint;
+        state.lastPaintedHighlighted = highlighted;
+        state.lastPaintedSelected = selected;
+        state.lastPaintOverlay = overlayPaint;
     }
 
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Avoid negative widths
 //    int w = std::max(static_cast<int>(pen.getWidth()), 0);
     double width = pen.getWidth();
@@ -457,7 +445,7 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
         else if (highlighted) {
             pen.setColor(m_colorHighlightedEntity);
         }
-        else  if (e->getFlag(RS2::FlagTransparent)) {
+        else  if (isEntityTransparent(e)) {
             pen.setColor(m_colorBackground);
         }
         else if (pen.getColor().isEqualIgnoringFlags(m_colorBackground)
@@ -474,40 +462,35 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
     // deleting not drawing:
 
 // LC_ERR << "PEN " << pen.getColor().name() << "Width: " << pen.getWidth() <<  " | " << pen.getScreenWidth() << " LT " << pen.getLineType();
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-    painterSetPenTimer.start();
-#endif
-    lastPaintEntityPen.updateBy(originalPen);
+    state.lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    painterSetPenTime +=painterSetPenTimer.nsecsElapsed();
-
-#endif
 }
 
 void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
-    RS_Pen pen = e->getPenResolved();
+    PaintState &state = paintState();
+    // children of previewed containers are drawn in the pen of the preview
+    if (state.forcePen) {
+        painter->setPen(state.forcedPen);
+        return;
+    }
+    RS_Pen pen = resolvePen(e);
     RS_Pen originalPen = pen;
-    bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
+    bool highlighted = isEntityHighlighted(e);
+    bool selected = isEntitySelected(e);
     bool overlayPaint = inOverlay || inOverlayDrawing;
 // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
     // arbitrary QPainter::setPen was called between drawing entities.
     double patternOffset = painter->currentDashOffset();
-    if (lastPaintedHighlighted == highlighted && lastPaintedSelected == selected && lastPaintOverlay == overlayPaint) {
-        if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+    if (state.lastPaintedHighlighted == highlighted && state.lastPaintedSelected == selected && state.lastPaintOverlay == overlayPaint) {
+        if (state.lastPaintEntityPen.isSameAs(pen, patternOffset)) {
             return;
         }
     }
     else{
-        lastPaintedHighlighted = highlighted;
-        lastPaintedSelected = selected;
-        lastPaintOverlay = overlayPaint;
+        state.lastPaintedHighlighted = highlighted;
+        state.lastPaintedSelected = selected;
+        state.lastPaintOverlay = overlayPaint;
     }
     pen.setScreenWidth(0.0);
 
@@ -533,7 +516,7 @@ void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity
         else if (highlighted) {
             pen.setColor(m_colorHighlightedEntity);
         }
-        else if (e->getFlag(RS2::FlagTransparent)) {
+        else if (isEntityTransparent(e)) {
             pen.setColor(m_colorBackground);
         }
         else if (pen.getColor().isEqualIgnoringFlags(m_colorBackground) || (pen.getColor().toIntColor() == RS_Color::Black
@@ -547,11 +530,8 @@ void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity
     }
 
 // LC_ERR << "PEN " << pen.getColor().name() << "Width: " << pen.getWidth() <<  " | " << pen.getScreenWidth() << " LT " << pen.getLineType();
-    lastPaintEntityPen.updateBy(originalPen);
+    state.lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
 }
 
 /**
@@ -603,7 +583,8 @@ void LC_GraphicViewRenderer::drawCoordinateSystems(RS_Painter *painter){
 
 void LC_GraphicViewRenderer::doSetupBeforeContainerDraw() {
     LC_WidgetViewPortRenderer::doSetupBeforeContainerDraw();
-    lastPaintedHighlighted = false;
-    lastPaintedSelected = false;
-    lastPaintOverlay = false;
+    PaintState &state = paintState();
+    state.lastPaintedHighlighted = false;
+    state.lastPaintedSelected = false;
+    state.lastPaintOverlay = false;
 }
@@ -88,9 +88,6 @@ protected:
     RS_Color m_colorPreviewReferenceHighlightedEntities;
 
 
-    bool lastPaintedHighlighted = false;
-    bool lastPaintedSelected = false;
-    bool lastPaintOverlay = false;
     bool m_draftMode = false;
 
     QString draftMarkText = QObject::tr("Draft");
@@ -159,30 +159,18 @@ void LC_PrintPreviewViewRenderer::drawPaper(RS_Painter *painter) {
 void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     // fixme - sand - ucs - is it really necessary for print preview??????
     // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
+    if (/*!e->isContainer() && */(isEntitySelected(e) != painter->shouldDrawSelected())) {
         return;
     }
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
     // entity is not visible:
-    bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
+    bool visible = isEntityVisible(e);
     if (!visible) {
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
 
-    if (!e->isPrint() || constructionEntity)
+    if (!isEntityPrinted(e) || constructionEntity)
         return;
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
@@ -195,15 +183,12 @@ void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e
 }
 
 void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = resolvePen(e);
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
-    if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+    if (paintState().lastPaintEntityPen.isSameAs(pen, patternOffset)) {
         return;
     }
     // Avoid negative widths
@@ -261,16 +246,13 @@ void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, R
         pen.setDashOffset(patternOffset * defaultWidthFactor);
     }
 
-    if (e->getFlag(RS2::FlagTransparent) ) {
+    if (isEntityTransparent(e)) {
         pen.setColor(m_colorBackground);
     }
 
     // we store original pen as last painted, not resolved one - since original pen lead to resulting resolved and may be used by the next entity
-    lastPaintEntityPen.updateBy(originalPen);
+    paintState().lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
 }
 
 void LC_PrintPreviewViewRenderer::setupPainter(RS_Painter *painter)  {
@@ -20,16 +20,38 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  ******************************************************************************/
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <memory>
+#include <vector>
+
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include "lc_graphicviewport.h"
+#include "lc_trace.h"
 #include "lc_widgetviewportrenderer.h"
 #include "rs_debug.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_math.h"
 #include "rs_painter.h"
 #include "rs_settings.h"
 
+namespace {
+// entities are picked for a part of the view within this margin, so the wide lines of entities next to the part are
+// drawn into it
+constexpr int partOfViewMargin = 32;
+// size of the tiles rendered concurrently, in pixels
+constexpr int tileSize = 256;
+}
+
 LC_WidgetViewPortRenderer::LC_WidgetViewPortRenderer(LC_GraphicViewport *viewport, QPaintDevice* paintDevice):
     LC_GraphicViewportRenderer(viewport, paintDevice)
     , pixmapLayerBackground{ std::make_unique<QPixmap>() }
@@ -79,28 +101,14 @@ void LC_WidgetViewPortRenderer::loadSettings() {
         m_render_arcsInterpolateMaxSagitta = sagittaMax / 100.0;
 
         m_render_circlesSameAsArcs = LC_GET_BOOL("CircleRenderAsArcs", false);
+
+        m_render_tiled = LC_GET_BOOL("TiledRendering", false);
     } // Render group
     LC_GROUP_END();
 }
 
 void LC_WidgetViewPortRenderer::doRender() {
-
-#ifdef DEBUG_RENDERING
-    QElapsedTimer timer;
-    timer.start();
-    drawEntityCount = 0;
-    entityDrawTime = 0;
-    isVisibleTime = 0;
-    isConstructionTime  = 0;
-    setPenTime = 0;
-    painterSetPenTime = 0;
-    getPenTime = 0;
-
-
-    drawLayerBackgroundTime = 0;
-    drawLayerEntitiesTime = 0;
-    drawLayerOverlaysTime = 0;
-#endif
+    LC_TRACE_ZONE("render", "paint");
     if (antialiasing){
         if (classicRenderer) {
             paintClassicalBuffered(pd);
@@ -113,13 +121,6 @@ void LC_WidgetViewPortRenderer::doRender() {
         paintClassicalBuffered(pd);
     }
 
-#ifdef DEBUG_RENDERING
-    LC_ERR<<"Paint:"  << timer.elapsed() <<
-    " Layer 1 - Background: "  << drawLayerBackgroundTime <<" Layer 2 - Entities:"  << drawLayerEntitiesTime  <<" Layer 3 - overlays: "  << drawLayerOverlaysTime
-    << " Entity Draw: " << entityDrawTime*1e-6 <<  " isVisible: " << isVisibleTime*1e-6 <<  " isConstruction: " << isConstructionTime*1e-6
-    << " setPen: " << setPenTime*1e-6 <<  " getPen: " << getPenTime*1e-6 << " painter setPen: " << painterSetPenTime*1e-6 << " Entities: " << drawEntityCount;
-#endif
-
     redrawMethod=RS2::RedrawNone;
 }
 
@@ -143,12 +144,19 @@ void LC_WidgetViewPortRenderer::paintSequental(QPaintDevice* pd) {
     }
 
     if (redrawMethod & RS2::RedrawDrawing) {
+        // the classic drawing layer is not updated here, so it can't be scrolled later
+        m_drawingPlacement.valid = false;
         // DRaw layer 2
         *pixmapLayerDrawing = *pixmapLayerBackground;
         RS_Painter painterLayerDrawing(pixmapLayerDrawing.get());
         setupPainter(&painterLayerDrawing);
 
-        drawLayerEntities(&painterLayerDrawing);
+        if (m_render_tiled) {
+            drawLayerEntitiesTiled(&painterLayerDrawing);
+        }
+        else {
+            drawLayerEntities(&painterLayerDrawing);
+        }
         drawLayerEntitiesOver(&painterLayerDrawing);
         painterLayerDrawing.end();
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawOverlay);
@@ -188,13 +196,25 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
         drawLayerBackground(&painterBackground);
     }
 
-    if (redrawMethod & RS2::RedrawDrawing) {
+    // on pure panning, the rendered entities are moved and only the exposed strips are rendered
+    bool redrawDrawing = redrawMethod & RS2::RedrawDrawing;
+    if (!redrawDrawing && (redrawMethod & RS2::RedrawViewport)) {
+        redrawDrawing = !scrollDrawing(m_pixmapLayer2.get());
+    }
+
+    if (redrawDrawing) {
         // DRaw layer 2
         m_pixmapLayer2->fill(Qt::transparent);
         RS_Painter painterLayerDrawing(m_pixmapLayer2.get());
         setupPainter(&painterLayerDrawing);
-        drawLayerEntities(&painterLayerDrawing);
+        if (m_render_tiled) {
+            drawLayerEntitiesTiled(&painterLayerDrawing);
+        }
+        else {
+            drawLayerEntities(&painterLayerDrawing);
+        }
         drawLayerEntitiesOver(&painterLayerDrawing);
+        m_drawingPlacement = getDrawingPlacement();
     }
 
     if (redrawMethod & RS2::RedrawOverlay) {
@@ -211,6 +231,72 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
     wPainter.drawPixmap(0, 0, *m_pixmapLayer3);
 }
 
+/**
+ * Scrolls the rendered entities by the change of the viewport offset, and renders the exposed strips only.
+ * @return false, if the viewport changed otherwise, so the drawing layer should be rendered completely
+ */
+bool LC_WidgetViewPortRenderer::scrollDrawing(QPixmap* pixmap) {
+    const DrawingPlacement placement = getDrawingPlacement();
+    if (!m_drawingPlacement.valid || !placement.isScrolledFrom(m_drawingPlacement)) {
+        return false;
+    }
+    // the y axis of the offset points up
+    const int dx = placement.offsetX - m_drawingPlacement.offsetX;
+    const int dy = m_drawingPlacement.offsetY - placement.offsetY;
+    if (std::abs(dx) >= placement.width || std::abs(dy) >= placement.height) {
+        return false;
+    }
+    m_drawingPlacement = placement;
+    if (dx == 0 && dy == 0) {
+        return true;
+    }
+
+    QRegion exposed;
+    pixmap->scroll(dx, dy, pixmap->rect(), &exposed);
+    {
+        // the exposed area keeps the scrolled out pixels
+        QPainter painterClear(pixmap);
+        painterClear.setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect& strip: exposed) {
+            painterClear.fillRect(strip, Qt::transparent);
+        }
+    }
+
+    const LC_Rect viewBoundingClipRect = paintState().boundingClipRect;
+    RS_Painter painterLayerDrawing(pixmap);
+    for (const QRect& strip: exposed) {
+        const QRect area = strip.adjusted(-partOfViewMargin, -partOfViewMargin, partOfViewMargin, partOfViewMargin);
+        paintState().boundingClipRect = prepareBoundingClipRect(area.left(), area.top(), area.right() + 1, area.bottom() + 1);
+        setupPainter(&painterLayerDrawing);
+        painterLayerDrawing.setClipRect(strip.x(), strip.y(), strip.width(), strip.height());
+        drawLayerEntities(&painterLayerDrawing);
+        drawLayerEntitiesOver(&painterLayerDrawing);
+    }
+    paintState().boundingClipRect = viewBoundingClipRect;
+    return true;
+}
+
+LC_WidgetViewPortRenderer::DrawingPlacement LC_WidgetViewPortRenderer::getDrawingPlacement() const {
+    DrawingPlacement placement;
+    placement.valid = true;
+    placement.offsetX = viewport->getOffsetX();
+    placement.offsetY = viewport->getOffsetY();
+    placement.width = viewport->getWidth();
+    placement.height = viewport->getHeight();
+    placement.factor = viewport->getFactor();
+    placement.hasUCS = viewport->hasUCS();
+    placement.ucsOrigin = viewport->getUcsOrigin();
+    placement.ucsAngle = viewport->getXAxisAngle();
+    // texts are drawn as drafts while panning
+    placement.panning = viewport->isPanning();
+    return placement;
+}
+
+bool LC_WidgetViewPortRenderer::DrawingPlacement::isScrolledFrom(const DrawingPlacement& other) const {
+    return width == other.width && height == other.height && factor == other.factor && hasUCS == other.hasUCS
+           && ucsOrigin == other.ucsOrigin && ucsAngle == other.ucsAngle && panning == other.panning;
+}
+
 void LC_WidgetViewPortRenderer::setupPainter(RS_Painter *painter) {
     LC_GraphicViewportRenderer::setupPainter(painter);
     painter->setMinCircleDrawingRadius(m_render_minCircleDrawingRadius);
@@ -235,49 +321,157 @@ void LC_WidgetViewPortRenderer::setupPainter(RS_Painter *painter) {
 
 
 void LC_WidgetViewPortRenderer::drawLayerBackground(RS_Painter *painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerBackgroundTimer.start();
-#endif
+    LC_TRACE_ZONE("render", "drawLayerBackground");
     doDrawLayerBackground(painter);
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerBackgroundTime += drawLayerBackgroundTimer.elapsed();
-#endif
 }
 
 
 // fixme - sand - ADD additional pass with ordering of entities - in order to draw construction entities under normal ones!!!
 
 void LC_WidgetViewPortRenderer::drawLayerEntities(RS_Painter* painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerEntitiesTimer.start();
-#endif
+    LC_TRACE_ZONE("render", "drawLayerEntities");
+    drawLayerEntities(painter, collectLayerEntities(paintState().boundingClipRect, hasVisibleConstructionLayers()));
+}
+
+LC_WidgetViewPortRenderer::LayerEntities LC_WidgetViewPortRenderer::collectLayerEntities(
+    const LC_Rect& clipRect, bool constructionVisible) const {
+    LayerEntities result;
+    // lines on construction layers are drawn as infinite lines, so they may be visible even if their
+    // bounding boxes are outside of the view. The whole container is traversed in this case
+    const RS_EntityContainer *container = viewport->getContainer();
+    result.indexed = !constructionVisible &&
+                     container->getEntitiesInWindow(clipRect.minP(), clipRect.maxP(), result.entities) &&
+                     container->getSelectedEntitiesInWindow(clipRect.minP(), clipRect.maxP(), result.selected);
+    if (result.indexed) {
+        LC_TRACE_COUNTER("render", "entitiesInView", result.entities.size());
+    }
+    return result;
+}
 
+void LC_WidgetViewPortRenderer::drawLayerEntities(RS_Painter* painter, const LayerEntities& layerEntities) {
     RS_EntityContainer *container = viewport->getContainer();
+
+    // lines and arcs of consecutive entities with the same pen are drawn by a single call
+    painter->setBatching(true);
     painter->setDrawSelectedOnly(false);
     doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+    if (layerEntities.indexed) {
+        for (RS_Entity* e: layerEntities.entities) {
+            painter->drawEntity(e);
+        }
+    }
+    else {
+        justDrawEntity(painter, container);
+    }
 
     painter->setDrawSelectedOnly(true);
     doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+    if (layerEntities.indexed) {
+        for (RS_Entity* e: layerEntities.selected) {
+            painter->drawEntity(e);
+        }
+    }
+    else {
+        justDrawEntity(painter, container);
+    }
+    painter->setBatching(false);
+}
+
+/**
+ * Draws the entities by tiles of the view, which are rendered concurrently by the threads of the global pool
+ * and the calling thread. Each tile is rendered by own painter to own image, and the images are drawn by the painter.
+ */
+void LC_WidgetViewPortRenderer::drawLayerEntitiesTiled(RS_Painter* painter) {
+    LC_TRACE_ZONE("render", "drawLayerEntitiesTiled");
+    const QSize deviceSize{viewport->getWidth(), viewport->getHeight()};
+    std::vector<QRect> tiles;
+    for (int y = 0; y < deviceSize.height(); y += tileSize) {
+        for (int x = 0; x < deviceSize.width(); x += tileSize) {
+            tiles.emplace_back(x, y, std::min(tileSize, deviceSize.width() - x), std::min(tileSize, deviceSize.height() - y));
+        }
+    }
+    std::vector<QImage> images(tiles.size());
+
+    // the spatial index is built and re-indexed lazily by queries, so the tiles are queried here, and the
+    // tiles only draw the collected entities
+    const bool constructionVisible = hasVisibleConstructionLayers();
+    std::vector<LC_Rect> clipRects;
+    std::vector<LayerEntities> tileEntities;
+    clipRects.reserve(tiles.size());
+    tileEntities.reserve(tiles.size());
+    for (const QRect& tile: tiles) {
+        const QRect area = tile.adjusted(-partOfViewMargin, -partOfViewMargin, partOfViewMargin, partOfViewMargin);
+        clipRects.push_back(prepareBoundingClipRect(area.left(), area.top(), area.right() + 1, area.bottom() + 1));
+        tileEntities.push_back(collectLayerEntities(clipRects.back(), constructionVisible));
+    }
 
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerEntitiesTime += drawLayerEntitiesTimer.elapsed();
-#endif
+    const double deviceDpmm = painter->getDpmm();
+    std::atomic<std::size_t> nextTile{0};
+    auto renderTiles = [&]() {
+        for (std::size_t i = nextTile++; i < tiles.size(); i = nextTile++) {
+            renderTile(tiles[i], clipRects[i], tileEntities[i], images[i], deviceSize, deviceDpmm);
+        }
+    };
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    const int workers = std::min(pool->maxThreadCount(), static_cast<int>(tiles.size())) - 1;
+    QSemaphore finished;
+    int started = 0;
+    for (; started < workers; ++started) {
+        if (!pool->tryStart([&renderTiles, &finished]() {
+            renderTiles();
+            finished.release();
+        })) {
+            break;
+        }
+    }
+    renderTiles();
+    finished.acquire(started);
+
+    for (std::size_t i = 0; i < tiles.size(); ++i) {
+        painter->drawImage(tiles[i].topLeft(), images[i]);
+    }
+
+}
+
+void LC_WidgetViewPortRenderer::renderTile(const QRect& tile, const LC_Rect& clipRect, const LayerEntities& layerEntities,
+                                           QImage& image, const QSize& deviceSize, double deviceDpmm) {
+    LC_TRACE_ZONE("render", "renderTile");
+    PaintState state;
+    threadPaintState = &state;
+    state.boundingClipRect = clipRect;
+
+    image = QImage(tile.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        RS_Painter painter(&image);
+        painter.setTile(tile.topLeft(), deviceSize, deviceDpmm);
+        setupPainter(&painter);
+        drawLayerEntities(&painter, layerEntities);
+    }
+    threadPaintState = nullptr;
+}
+
+bool LC_WidgetViewPortRenderer::hasVisibleConstructionLayers() const {
+    if (graphic == nullptr) {
+        return false;
+    }
+    for (const RS_Layer* layer: *graphic->getLayerList()) {
+        if (layer->isConstruction() && !layer->isFrozen()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void LC_WidgetViewPortRenderer::doSetupBeforeContainerDraw() {
-    lastPaintEntityPen = RS_Pen{};
-    lastPaintEntityPen.setFlags(RS2::FlagInvalid);
+    RS_Pen &lastPen = paintState().lastPaintEntityPen;
+    lastPen = RS_Pen{};
+    lastPen.setFlags(RS2::FlagInvalid);
 }
 
 
 void LC_WidgetViewPortRenderer::drawLayerOverlays(RS_Painter *painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerOverlaysTimer.start();
-#endif
+    LC_TRACE_ZONE("render", "drawLayerOverlays");
     doDrawLayerOverlays(painter);
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerOverlaysTime +=  drawLayerOverlaysTimer.elapsed();
-#endif
 }
@@ -24,8 +24,13 @@
 #define LC_WIDGETVIEWPORTRENDERER_H
 
 #include "lc_graphicviewportrenderer.h"
+#include "rs_vector.h"
 
+class QImage;
 class QPixmap;
+class QRect;
+class QSize;
+class RS_Entity;
 
 class LC_WidgetViewPortRenderer:public LC_GraphicViewportRenderer
 {
@@ -42,9 +47,11 @@ protected:
     virtual void doSetupBeforeContainerDraw();
     void paintClassicalBuffered(QPaintDevice* pd);
     void paintSequental(QPaintDevice* pd);
+    bool scrollDrawing(QPixmap* pixmap);
 
     void drawLayerBackground(RS_Painter *painter);
     void drawLayerEntities(RS_Painter* painter);
+    void drawLayerEntitiesTiled(RS_Painter* painter);
     void drawLayerOverlays(RS_Painter *painter);
 
     virtual void drawLayerEntitiesOver([[maybe_unused]]RS_Painter* painter){}
@@ -53,17 +60,46 @@ protected:
     int getMinRenderableTextHeightInPx() const {
         return m_render_minRenderableTextHeightInPx;
     }
-
-#ifdef DEBUG_RENDERING
-    QElapsedTimer drawLayerBackgroundTimer;
-    QElapsedTimer drawLayerEntitiesTimer;
-    QElapsedTimer drawLayerOverlaysTimer;
-    long drawLayerBackgroundTime = 0;
-    long drawLayerEntitiesTime = 0;
-    long drawLayerOverlaysTime = 0;
-#endif
+    bool hasVisibleConstructionLayers() const;
 
 private:
+    /**
+     * The state of the viewport, the drawing layer was rendered for. The rendered entities are scrolled
+     * while only the offset changes.
+     */
+    struct DrawingPlacement {
+        bool valid = false;
+        int offsetX = 0;
+        int offsetY = 0;
+        int width = 0;
+        int height = 0;
+        RS_Vector factor;
+        bool hasUCS = false;
+        RS_Vector ucsOrigin;
+        double ucsAngle = 0.;
+        bool panning = false;
+
+        bool isScrolledFrom(const DrawingPlacement& other) const;
+    };
+
+    DrawingPlacement getDrawingPlacement() const;
+
+    /**
+     * Entities of the drawing layer, which may be visible within a clip rect
+     */
+    struct LayerEntities {
+        // false, if the spatial index isn't used, and the whole container is drawn
+        bool indexed = false;
+        std::vector<RS_Entity*> entities;
+        // selected entities of the window, drawn again over the others
+        std::vector<RS_Entity*> selected;
+    };
+
+    LayerEntities collectLayerEntities(const LC_Rect& clipRect, bool constructionVisible) const;
+    void drawLayerEntities(RS_Painter* painter, const LayerEntities& layerEntities);
+    void renderTile(const QRect& tile, const LC_Rect& clipRect, const LayerEntities& layerEntities, QImage& image,
+                    const QSize& deviceSize, double deviceDpmm);
+
     bool antialiasing = false;
     bool classicRenderer = true;
 
@@ -85,11 +121,13 @@ private:
     double m_render_arcsInterpolateAngleValue = M_PI / 36;
     double m_render_arcsInterpolateMaxSagitta = 0.9;
     bool m_render_circlesSameAsArcs = false;
+    bool m_render_tiled = false;
 
     // Used for buffering different paint layers
     std::unique_ptr<QPixmap> m_pixmapLayer1;  // Used for grids and absolute 0
     std::unique_ptr<QPixmap> m_pixmapLayer2;  // Used for the actual CAD drawing
     std::unique_ptr<QPixmap> m_pixmapLayer3;  // Used for crosshair and actionitems
+    DrawingPlacement m_drawingPlacement; // of m_pixmapLayer2
 };
 
 #endif // LC_WIDGETVIEWPORTRENDERER_H
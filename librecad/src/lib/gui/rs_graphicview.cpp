@@ -47,6 +47,7 @@
 #include "rs_settings.h"
 #include "rs_units.h"
 #include "lc_graphicviewport.h"
+#include "lc_intersectioncache.h"
 #include "lc_widgetviewportrenderer.h"
 #include "lc_shortcuts_manager.h"
 
@@ -60,7 +61,8 @@
  */
 RS_GraphicView::RS_GraphicView(QWidget *parent, Qt::WindowFlags f)
     :QWidget(parent, f), eventHandler{new RS_EventHandler{this}},
-    defaultSnapMode{std::make_unique<RS_SnapMode>()}{
+    defaultSnapMode{std::make_unique<RS_SnapMode>()},
+    intersectionCache{std::make_unique<LC_IntersectionCache>()}{
     viewport = new LC_GraphicViewport();
     viewport->addViewportListener(this);
 }
@@ -245,7 +247,7 @@ void RS_GraphicView::onViewportChanged() {
     adjustZoomControls();
     QString info = viewport->getGrid()->getInfo();
     updateGridStatusWidget(info);
-    redraw();
+    redraw(static_cast<RS2::RedrawMethod>(RS2::RedrawGrid | RS2::RedrawViewport | RS2::RedrawOverlay));
 }
 
 void RS_GraphicView::onViewportRedrawNeeded() {
@@ -305,6 +307,10 @@ RS_EventHandler *RS_GraphicView::getEventHandler() const {
     return eventHandler;
 }
 
+LC_IntersectionCache *RS_GraphicView::getIntersectionCache() const {
+    return intersectionCache.get();
+}
+
 RS_Graphic *RS_GraphicView::getGraphic() const {
     if (container && container->rtti() == RS2::EntityGraphic) {
         return static_cast<RS_Graphic *>(container);
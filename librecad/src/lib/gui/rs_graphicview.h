@@ -56,6 +56,7 @@ class RS_Painter;
 struct RS_LineTypePattern;
 struct RS_SnapMode;
 class LC_GraphicViewport;
+class LC_IntersectionCache;
 class LC_WidgetViewPortRenderer;
 
 /**
@@ -137,6 +138,10 @@ public:
     RS2::SnapRestriction getSnapRestriction() const;
     RS_EventHandler *getEventHandler() const;
     /**
+     * @return intersections of entities, kept between snapping queries in this view
+     */
+    LC_IntersectionCache *getIntersectionCache() const;
+    /**
   * Enables or disables print preview.
   */
     void setPrintPreview(bool pv);
@@ -197,6 +202,7 @@ protected:
      * actions.
      */
     std::unique_ptr<RS_SnapMode> defaultSnapMode;
+    std::unique_ptr<LC_IntersectionCache> intersectionCache;
  /**
   * Current default snap restriction for this graphic view. Used for new
   * actions.
@@ -0,0 +1,101 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <functional>
+
+#include "lc_intersectioncache.h"
+#include "rs_entity.h"
+#include "rs_information.h"
+
+namespace {
+// entries are dropped all at once beyond this size
+constexpr std::size_t maxEntries = 1 << 16;
+
+void combine(std::size_t& seed, std::size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+void combine(std::size_t& seed, const RS_Vector& point)
+{
+    combine(seed, std::hash<double>{}(point.x));
+    combine(seed, std::hash<double>{}(point.y));
+}
+
+// all data the intersections depend on; the reference points define the shape of every snapped entity type
+std::size_t geometryHash(const RS_Entity& entity)
+{
+    std::size_t seed = std::hash<int>{}(entity.rtti());
+    combine(seed, entity.isConstruction() ? 1 : 0);
+    combine(seed, entity.getMin());
+    combine(seed, entity.getMax());
+    for (const RS_Vector& ref: entity.getRefPoints()) {
+        combine(seed, ref);
+    }
+    return seed;
+}
+}
+
+std::size_t LC_IntersectionCache::KeyHash::operator()(const std::pair<unsigned long, unsigned long>& key) const
+{
+    std::size_t seed = std::hash<unsigned long>{}(key.first);
+    combine(seed, std::hash<unsigned long>{}(key.second));
+    return seed;
+}
+
+const RS_VectorSolutions& LC_IntersectionCache::getIntersection(const RS_Entity* e1, const RS_Entity* e2)
+{
+    // the pair is unordered
+    if (e2->getId() < e1->getId()) {
+        std::swap(e1, e2);
+    }
+    const std::size_t hash1 = geometryHash(*e1);
+    const std::size_t hash2 = geometryHash(*e2);
+    const std::pair<unsigned long, unsigned long> key{e1->getId(), e2->getId()};
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        if (it->second.hash1 == hash1 && it->second.hash2 == hash2) {
+            return it->second.solutions;
+        }
+    } else {
+        if (m_entries.size() >= maxEntries) {
+            m_entries.clear();
+        }
+        it = m_entries.emplace(key, Entry{}).first;
+    }
+    it->second.hash1 = hash1;
+    it->second.hash2 = hash2;
+    it->second.solutions = RS_Information::getIntersection(e1, e2, true);
+    return it->second.solutions;
+}
+
+void LC_IntersectionCache::clear()
+{
+    m_entries.clear();
+}
+
+std::size_t LC_IntersectionCache::size() const
+{
+    return m_entries.size();
+}
@@ -0,0 +1,67 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_INTERSECTIONCACHE_H
+#define LC_INTERSECTIONCACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_IntersectionCache class, intersection points of entity pairs, kept between snapping queries.
+ *
+ * Entries are keyed by the ids of both entities, and store a hash of the geometry of each entity (type, borders,
+ * reference points and construction state). An entry is recomputed when the hash of either entity differs, so
+ * entities modified in place are never reported with stale intersections.
+ *
+ * The cache is bounded: it is cleared when it grows beyond a fixed number of entries.
+ */
+class LC_IntersectionCache {
+public:
+    /**
+     * @brief getIntersection - intersections on both entities, as computed by RS_Information::getIntersection()
+     */
+    const RS_VectorSolutions& getIntersection(const RS_Entity* e1, const RS_Entity* e2);
+
+    void clear();
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::size_t hash1 = 0;
+        std::size_t hash2 = 0;
+        RS_VectorSolutions solutions;
+    };
+    struct KeyHash {
+        std::size_t operator()(const std::pair<unsigned long, unsigned long>& key) const;
+    };
+
+    std::unordered_map<std::pair<unsigned long, unsigned long>, Entry, KeyHash> m_entries;
+};
+
+#endif // LC_INTERSECTIONCACHE_H
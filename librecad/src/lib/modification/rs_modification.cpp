@@ -29,6 +29,7 @@
 
 #include "lc_graphicviewport.h"
 #include "lc_linemath.h"
+#include "lc_previewtransform.h"
 #include "lc_splinepoints.h"
 #include "lc_undosection.h"
 #include "rs_arc.h"
@@ -49,6 +50,7 @@
 #include "rs_modification.h"
 #include "rs_mtext.h"
 #include "rs_polyline.h"
+#include "rs_preview.h"
 #include "rs_text.h"
 #include "rs_units.h"
 #include "rs_settings.h"
@@ -1726,7 +1728,15 @@ bool RS_Modification::move(RS_MoveData& data, const std::vector<RS_Entity*> &ent
     int numberOfCopies = data.obtainNumberOfCopies();
     std::vector<RS_Entity*> clonesList;
 
-    for(auto e: entitiesList){
+    std::vector<LC_PreviewTransform> transforms;
+    if (forPreviewOnly) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            transforms.push_back(LC_PreviewTransform::move(data.offset * num));
+        }
+    }
+    const std::vector<RS_Entity*> clonedEntities = forPreviewOnly ? previewTransformed(entitiesList, transforms) : entitiesList;
+
+    for(auto e: clonedEntities){
         // Create new entities
         for (int num = 1; num <= numberOfCopies; num++) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
@@ -1742,6 +1752,14 @@ bool RS_Modification::move(RS_MoveData& data, const std::vector<RS_Entity*> &ent
     return true;
 }
 
+std::vector<RS_Entity*> RS_Modification::previewTransformed(const std::vector<RS_Entity*> &entitiesList,
+                                                            const std::vector<LC_PreviewTransform> &transforms) const {
+    if (transforms.empty() || container->rtti() != RS2::EntityPreview) {
+        return entitiesList;
+    }
+    return static_cast<RS_Preview*>(container)->addTransformedEntities(entitiesList, transforms);
+}
+
 RS_Entity *RS_Modification::getClone(bool forPreviewOnly, const RS_Entity *e) const {
     RS_Entity* result = nullptr;
     if (forPreviewOnly){
@@ -1902,19 +1920,39 @@ bool RS_Modification::rotate(RS_RotateData& data, const std::vector<RS_Entity*>
     // Create new entities
 
     int numberOfCopies = data.obtainNumberOfCopies();
-    for (auto e: entitiesList) {
+    bool rotateTwice = data.twoRotations;
+    double distance = data.refPoint.distanceTo(data.center);
+    if (distance < RS_TOLERANCE){
+        rotateTwice = false;
+    }
+
+    std::vector<LC_PreviewTransform> transforms;
+    if (forPreviewOnly) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            double rotationAngle = data.angle * num;
+            LC_PreviewTransform transform = LC_PreviewTransform::rotate(data.center, rotationAngle);
+            if (rotateTwice) {
+                RS_Vector rotatedRefPoint = data.refPoint;
+                rotatedRefPoint.rotate(data.center, rotationAngle);
+
+                double secondRotationAngle = data.secondAngle;
+                if (data.secondAngleIsAbsolute){
+                    secondRotationAngle -= rotationAngle;
+                }
+                transform = transform.then(LC_PreviewTransform::rotate(rotatedRefPoint, secondRotationAngle));
+            }
+            transforms.push_back(transform);
+        }
+    }
+    const std::vector<RS_Entity*> clonedEntities = forPreviewOnly ? previewTransformed(entitiesList, transforms) : entitiesList;
+
+    for (auto e: clonedEntities) {
         for (int num = 1; num <= numberOfCopies; num++) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
 
             double rotationAngle = data.angle * num;
             ec->rotate(data.center, rotationAngle);
 
-            bool rotateTwice = data.twoRotations;
-            double distance = data.refPoint.distanceTo(data.center);
-            if (distance < RS_TOLERANCE){
-                rotateTwice = false;
-            }
-
             if (rotateTwice) {
                 RS_Vector rotatedRefPoint = data.refPoint;
                 rotatedRefPoint.rotate(data.center, rotationAngle);
@@ -1959,7 +1997,18 @@ bool RS_Modification::scale(RS_ScaleData& data, bool forPreviewOnly, const bool
 bool RS_Modification::scale(RS_ScaleData& data, const std::vector<RS_Entity*> &entitiesList, bool forPreviewOnly, const bool keepSelected) {
     std::vector<RS_Entity*> selectedList,clonesList;
 
-    for(auto ec: entitiesList){
+    int numberOfCopies = data.obtainNumberOfCopies();
+
+    // only isotropic scaling is a similarity, which can be drawn through a transform
+    std::vector<LC_PreviewTransform> transforms;
+    if (forPreviewOnly && data.isotropicScaling && data.factor.x == data.factor.y) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            transforms.push_back(LC_PreviewTransform::scale(data.referencePoint, RS_Math::pow(data.factor, num).x));
+        }
+    }
+    const std::vector<RS_Entity*> clonedEntities = forPreviewOnly ? previewTransformed(entitiesList, transforms) : entitiesList;
+
+    for(auto ec: clonedEntities){
         if ( !data.isotropicScaling ) {
             RS2::EntityType rtti = ec->rtti();
             if (rtti == RS2::EntityCircle ) {
@@ -1987,8 +2036,6 @@ bool RS_Modification::scale(RS_ScaleData& data, const std::vector<RS_Entity*> &e
         selectedList.push_back(ec);
     }
 
-    int numberOfCopies = data.obtainNumberOfCopies();
-
     // Create new entities
     for(RS_Entity* e: selectedList) {
         if (e != nullptr) {
@@ -2028,9 +2075,15 @@ bool RS_Modification::mirror(RS_MirrorData& data, const std::vector<RS_Entity*>
 //    int numberOfCopies = obtainNumberOfCopies(data);
     int numberOfCopies = 1; // fixme - think about support of multiple copies.... may it be be something like moving the central point of selection? Like mirror+move?
 
+    std::vector<LC_PreviewTransform> transforms;
+    if (forPreviewOnly) {
+        transforms.push_back(LC_PreviewTransform::mirror(data.axisPoint1, data.axisPoint2));
+    }
+    const std::vector<RS_Entity*> clonedEntities = forPreviewOnly ? previewTransformed(entitiesList, transforms) : entitiesList;
+
     // Create new entities
 
-    for(auto e: entitiesList){
+    for(auto e: clonedEntities){
         for (int num=1; num<=numberOfCopies; ++num) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
             ec->mirror(data.axisPoint1, data.axisPoint2);
@@ -2124,8 +2177,19 @@ bool RS_Modification::moveRotate(RS_MoveRotateData &data, const std::vector<RS_E
 
     int numberOfCopies = data.obtainNumberOfCopies();
 
+    std::vector<LC_PreviewTransform> transforms;
+    if (forPreviewOnly) {
+        for (int num = 1; num <= numberOfCopies; ++num) {
+            const RS_Vector &offset = data.offset * num;
+            double angleForCopy = data.sameAngleForCopies ?  data.angle : data.angle * num;
+            transforms.push_back(LC_PreviewTransform::move(offset)
+                                     .then(LC_PreviewTransform::rotate(data.referencePoint + offset, angleForCopy)));
+        }
+    }
+    const std::vector<RS_Entity*> clonedEntities = forPreviewOnly ? previewTransformed(entitiesList, transforms) : entitiesList;
+
     // Create new entities
-    for(auto e: entitiesList){
+    for(auto e: clonedEntities){
         for (int num=1; num <= numberOfCopies; ++num) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
 
@@ -43,6 +43,7 @@ class RS_Document;
 class RS_Graphic;
 class RS_GraphicView;
 class LC_GraphicViewport;
+class LC_PreviewTransform;
 
 struct LC_ModifyOperationFlags{
     bool useCurrentAttributes = false;
@@ -402,6 +403,13 @@ protected:
                              bool forPreviewOnly, bool keepSelected) const;
 
     RS_Entity *getClone(bool forPreviewOnly, const RS_Entity *e) const;
+
+    /**
+     * Previews the entities through the transforms, one transform per copy, if the container is a preview
+     * @return entities, which are previewed by modified clones
+     */
+    std::vector<RS_Entity*> previewTransformed(const std::vector<RS_Entity*> &entitiesList,
+                                               const std::vector<LC_PreviewTransform> &transforms) const;
 };
 
 #endif
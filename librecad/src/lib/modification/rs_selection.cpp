@@ -27,6 +27,7 @@
 
 #include "qc_applicationwindow.h"
 
+#include "lc_endpointgraph.h"
 #include "qg_dialogfactory.h"
 
 #include "rs_block.h"
@@ -207,53 +208,34 @@ void RS_Selection::selectContour(RS_Entity *e){
     auto *ae = (RS_AtomicEntity *) e;
     RS_Vector p1 = ae->getStartpoint();
     RS_Vector p2 = ae->getEndpoint();
-    bool found = false;
 
     // (de)select 1st entity:
     e->setSelected(select);
 
-    do {// fixme - hm...iterating over all entities of drawing in cycle???? too nice for me...
-        found = false;
-        // fixme - iterating over all entities of drawing
-        for (auto en: *container) {
-
-            if (en && en->isVisible() &&
+    // both ends of the chain are extended by entities connected to them, found by the end point graph of the
+    // container, so each step doesn't iterate over all entities of the drawing
+    LC_EndpointGraph *graph = container->getEndpointGraph();
+    auto extend = [graph, select](RS_Vector &p) {
+        for (RS_Entity *en: graph->getConnected(p, 1.0e-4)) {
+            if (en->isVisible() &&
                 en->isAtomic() && en->isSelected() != select &&
                 (!(en->getLayer() && en->getLayer()->isLocked()))){
 
-                ae = (RS_AtomicEntity *) en;
-                bool doit = false;
-
-                // startpoint connects to 1st point
-                if (ae->getStartpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getStartpoint();
-                }
-
-                    // startpoint connects to 2nd point
-                else if (ae->getStartpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getStartpoint();
-                }
-
-                if (doit){
-                    ae->setSelected(select);
-                    found = true;
-                }
+                auto *connected = (RS_AtomicEntity *) en;
+                // the chain continues at the other end point
+                p = (connected->getStartpoint().distanceTo(p) < 1.0e-4) ? connected->getEndpoint()
+                                                                        : connected->getStartpoint();
+                connected->setSelected(select);
+                return true;
             }
         }
+        return false;
+    };
+
+    bool found = false;
+    do {
+        found = extend(p1);
+        found = extend(p2) || found;
     } while (found);
     graphicView->notifyChanged();
 }
@@ -0,0 +1,186 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "benchmark_drawing.h"
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_circle.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_insert.h"
+#include "rs_line.h"
+#include "rs_math.h"
+#include "rs_spline.h"
+#include "rs_text.h"
+
+namespace {
+const char* const blockName = "BENCHMARK_BLOCK";
+
+class Generator {
+public:
+    Generator(RS_Graphic& graphic, const BenchmarkDrawingParams& params):
+        m_graphic{graphic}
+        , m_random{params.seed}
+        // about 100 square units per line
+        , m_extent{10. * std::sqrt(std::max(params.lines, 1))}
+    {}
+
+    double uniform(double min, double max)
+    {
+        return std::uniform_real_distribution<double>{min, max}(m_random);
+    }
+
+    RS_Vector point()
+    {
+        return {uniform(0., m_extent), uniform(0., m_extent)};
+    }
+
+    RS_Vector direction(double length)
+    {
+        return RS_Vector::polar(length, uniform(0., 2. * M_PI));
+    }
+
+    void addLines(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const RS_Vector start = point();
+            m_graphic.addEntity(new RS_Line(&m_graphic, start, start + direction(uniform(1., 20.))));
+        }
+    }
+
+    void addArcs(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            const double angle1 = uniform(0., 2. * M_PI);
+            RS_ArcData data{point(), uniform(1., 10.), angle1, angle1 + uniform(0.2, 1.8 * M_PI), false};
+            m_graphic.addEntity(new RS_Arc(&m_graphic, data));
+        }
+    }
+
+    void addSplines(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            auto* spline = new RS_Spline(&m_graphic, RS_SplineData{3, false});
+            RS_Vector controlPoint = point();
+            for (int j = 0; j < 8; ++j) {
+                spline->addControlPoint(controlPoint);
+                controlPoint += direction(uniform(2., 10.));
+            }
+            spline->update();
+            m_graphic.addEntity(spline);
+        }
+    }
+
+    void addBlock()
+    {
+        auto* block = new RS_Block(&m_graphic, RS_BlockData{blockName, RS_Vector{0., 0.}, false});
+        for (int i = 0; i <= 4; ++i) {
+            block->addEntity(new RS_Line(block, RS_Vector{2. * i, 0.}, RS_Vector{2. * i, 8.}));
+            block->addEntity(new RS_Line(block, RS_Vector{0., 2. * i}, RS_Vector{8., 2. * i}));
+        }
+        block->addEntity(new RS_Circle(block, RS_CircleData{RS_Vector{4., 4.}, 3.}));
+        m_graphic.addBlock(block, false);
+    }
+
+    void addInserts(int count)
+    {
+        if (count <= 0) {
+            return;
+        }
+        addBlock();
+        for (int i = 0; i < count; ++i) {
+            RS_InsertData data{blockName, point(), RS_Vector{1., 1.}, uniform(0., 2. * M_PI), 1, 1,
+                               RS_Vector{0., 0.}, nullptr, RS2::NoUpdate};
+            m_graphic.addEntity(new RS_Insert(&m_graphic, data));
+        }
+        m_graphic.updateInserts();
+    }
+
+    void addHatches(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            auto* hatch = new RS_Hatch(&m_graphic, RS_HatchData{false, 1., uniform(0., M_PI), "ANSI31"});
+            auto* loop = new RS_EntityContainer(hatch);
+            loop->setLayer(nullptr);
+            const RS_Vector corner = point();
+            const RS_Vector size{uniform(10., 50.), uniform(10., 50.)};
+            const RS_Vector corners[] = {corner, corner + RS_Vector{size.x, 0.}, corner + size,
+                                         corner + RS_Vector{0., size.y}};
+            for (int j = 0; j < 4; ++j) {
+                auto* edge = new RS_Line(loop, corners[j], corners[(j + 1) % 4]);
+                edge->setLayer(nullptr);
+                loop->addEntity(edge);
+            }
+            hatch->addEntity(loop);
+            m_graphic.addEntity(hatch);
+            hatch->update();
+        }
+    }
+
+    void addTexts(int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            RS_TextData data{point(), RS_Vector{0., 0.}, 2.5, 1., RS_TextData::VABaseline, RS_TextData::HALeft,
+                             RS_TextData::None, QString("LibreCAD %1").arg(i), "standard", uniform(0., 2. * M_PI),
+                             RS2::NoUpdate};
+            auto* text = new RS_Text(&m_graphic, data);
+            m_graphic.addEntity(text);
+            text->update();
+        }
+    }
+
+private:
+    RS_Graphic& m_graphic;
+    std::mt19937 m_random;
+    double m_extent = 1.;
+};
+}
+
+BenchmarkDrawingParams BenchmarkDrawingParams::scaled(int n, unsigned seed)
+{
+    BenchmarkDrawingParams params;
+    params.lines = std::max(n, 0);
+    params.arcs = params.lines;
+    params.splines = params.lines / 10;
+    params.inserts = params.lines / 10;
+    params.hatches = params.lines / 100;
+    params.texts = params.lines / 10;
+    params.seed = seed;
+    return params;
+}
+
+void generateBenchmarkDrawing(RS_Graphic& graphic, const BenchmarkDrawingParams& params)
+{
+    Generator generator{graphic, params};
+    generator.addLines(params.lines);
+    generator.addArcs(params.arcs);
+    generator.addSplines(params.splines);
+    generator.addInserts(params.inserts);
+    generator.addHatches(params.hatches);
+    generator.addTexts(params.texts);
+    graphic.calculateBorders();
+}
@@ -0,0 +1,51 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef BENCHMARK_DRAWING_H
+#define BENCHMARK_DRAWING_H
+
+class RS_Graphic;
+
+/**
+ * Sizes of a synthetic benchmark drawing. The entities are spread uniformly over a square, which grows with the
+ * number of lines, so the density of the drawing doesn't depend on its size.
+ */
+struct BenchmarkDrawingParams {
+    int lines = 10000;
+    int arcs = 10000;
+    int splines = 1000;
+    int inserts = 1000;   // inserts of a block with a grid of lines and a circle
+    int hatches = 100;    // pattern hatches of rectangles
+    int texts = 1000;
+    unsigned seed = 1;    // the same seed generates the same drawing
+
+    /** @brief scaled sizes for n lines; the other types keep their ratio to the lines */
+    static BenchmarkDrawingParams scaled(int n, unsigned seed);
+};
+
+/**
+ * @brief generateBenchmarkDrawing add the synthetic entities to an empty graphic, and update them
+ */
+void generateBenchmarkDrawing(RS_Graphic& graphic, const BenchmarkDrawingParams& params);
+
+#endif // BENCHMARK_DRAWING_H
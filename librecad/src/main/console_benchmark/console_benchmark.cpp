@@ -0,0 +1,375 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "main.h"
+
+#include "benchmark_drawing.h"
+#include "console_benchmark.h"
+#include "lc_graphicviewport.h"
+#include "lc_printviewportrenderer.h"
+#include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_fontlist.h"
+#include "rs_graphic.h"
+#include "rs_hatch.h"
+#include "rs_painter.h"
+#include "rs_patternlist.h"
+#include "rs_settings.h"
+#include "rs_system.h"
+
+namespace {
+struct BenchmarkParams {
+    BenchmarkDrawingParams drawing;
+    int repeat = 3;
+    int queries = 1000;
+    QSize imageSize{2000, 2000};
+    QString outFile;   // if empty, the results are printed to stdout
+};
+
+/**
+ * Timings of one stage over all repetitions.
+ */
+struct StageTimes {
+    QString name;
+    std::vector<double> ms;
+};
+
+/**
+ * Runs the stages of one repetition, and keeps the timings of all repetitions in the order of the stages.
+ */
+class StageTimer {
+public:
+    void time(const QString& name, const std::function<void()>& stage)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        stage();
+        const double ms = timer.nsecsElapsed() / 1e6;
+
+        auto it = std::find_if(m_stages.begin(), m_stages.end(),
+                               [&name](const StageTimes& times) { return times.name == name; });
+        if (it == m_stages.end()) {
+            m_stages.push_back({name, {}});
+            it = std::prev(m_stages.end());
+        }
+        it->ms.push_back(ms);
+    }
+
+    const std::vector<StageTimes>& getStages() const
+    {
+        return m_stages;
+    }
+
+private:
+    std::vector<StageTimes> m_stages;
+};
+
+void renderGraphic(RS_Graphic& graphic, const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    RS_Painter painter(&image);
+    painter.setBackground(Qt::white);
+    painter.eraseRect(0, 0, size.width(), size.height());
+
+    LC_GraphicViewport viewport;
+    viewport.setSize(size.width(), size.height());
+    viewport.setBorders(5, 5, 5, 5);
+    viewport.setContainer(&graphic);
+    viewport.loadSettings();
+    viewport.zoomAuto(false);
+
+    LC_PrintViewportRenderer renderer(&viewport, &painter);
+    renderer.loadSettings();
+    renderer.setBackground(Qt::white);
+    renderer.render();
+    painter.end();
+}
+
+// the same query points in every repetition, spread over the drawing
+std::vector<RS_Vector> queryPoints(const RS_Graphic& graphic, int count, unsigned seed)
+{
+    std::mt19937 random{seed};
+    const RS_Vector min = graphic.getMin();
+    const RS_Vector max = graphic.getMax();
+    std::uniform_real_distribution<double> x{min.x, max.x};
+    std::uniform_real_distribution<double> y{min.y, max.y};
+    std::vector<RS_Vector> points;
+    points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        points.emplace_back(x(random), y(random));
+    }
+    return points;
+}
+
+bool runRepetition(const BenchmarkParams& params, const QString& dxfFile, StageTimer& timer, QJsonObject& counts)
+{
+    auto generated = std::make_unique<RS_Graphic>();
+    generated->newDoc();
+    timer.time("generate", [&]() {
+        generateBenchmarkDrawing(*generated, params.drawing);
+    });
+
+    bool ok = false;
+    timer.time("dxfExport", [&]() {
+        RS_FilterDXFRW filter;
+        ok = filter.fileExport(*generated, dxfFile, RS2::FormatDXFRW);
+    });
+    if (!ok) {
+        qDebug() << "ERROR: Failed to export" << dxfFile;
+        return false;
+    }
+    generated.reset();
+
+    // the loaded drawing is the one measured by the other stages, as after opening a file
+    auto graphic = std::make_unique<RS_Graphic>();
+    graphic->newDoc();
+    timer.time("dxfImport", [&]() {
+        RS_FilterDXFRW filter;
+        ok = filter.fileImport(*graphic, dxfFile, RS2::FormatDXFRW);
+    });
+    if (!ok) {
+        qDebug() << "ERROR: Failed to import" << dxfFile;
+        return false;
+    }
+    graphic->calculateBorders();
+    counts = {{"entities", static_cast<int>(graphic->count())},
+              {"entitiesDeep", static_cast<int>(graphic->countDeep())}};
+
+    timer.time("updateInserts", [&]() {
+        graphic->updateInserts();
+    });
+
+    timer.time("render", [&]() {
+        renderGraphic(*graphic, params.imageSize);
+    });
+
+    const std::vector<RS_Vector> points = queryPoints(*graphic, params.queries, params.drawing.seed);
+    timer.time("snapEndpoint", [&]() {
+        for (const RS_Vector& point: points) {
+            graphic->getNearestEndpoint(point, nullptr);
+        }
+    });
+    timer.time("snapOnEntity", [&]() {
+        for (const RS_Vector& point: points) {
+            graphic->getNearestPointOnEntity(point, true, nullptr, nullptr);
+        }
+    });
+    // the range of the snapper, for a 20 pixels range in a view of the image size
+    const double range = 20. * (graphic->getMax() - graphic->getMin()).magnitude()
+                         / std::max(1, std::max(params.imageSize.width(), params.imageSize.height()));
+    timer.time("snapIntersection", [&]() {
+        for (const RS_Vector& point: points) {
+            graphic->getNearestIntersection(point, nullptr, range, nullptr);
+        }
+    });
+
+    timer.time("hatchUpdate", [&]() {
+        for (RS_Entity* entity: *graphic) {
+            if (entity->rtti() == RS2::EntityHatch) {
+                static_cast<RS_Hatch*>(entity)->update();
+            }
+        }
+    });
+    return true;
+}
+
+QJsonObject stageResult(const StageTimes& stage)
+{
+    std::vector<double> sorted = stage.ms;
+    std::sort(sorted.begin(), sorted.end());
+    QJsonArray runs;
+    for (double ms: stage.ms) {
+        runs.append(ms);
+    }
+    return {{"name", stage.name},
+            {"unit", "ms"},
+            {"min", sorted.front()},
+            {"median", sorted.at(sorted.size() / 2)},
+            {"max", sorted.back()},
+            {"runs", runs}};
+}
+
+int parseIntArg(const QString& arg, int def, const char* name)
+{
+    if (arg.isEmpty()) {
+        return def;
+    }
+    bool ok = false;
+    const int value = arg.toInt(&ok);
+    if (!ok || value < 0) {
+        qDebug() << "WARNING: Ignoring bad" << name << ":" << arg;
+        return def;
+    }
+    return value;
+}
+}
+
+/////////
+/// \brief console_benchmark is called if librecad runs as the benchmark tool:
+/// a synthetic drawing is exported, imported, rendered into an image and
+/// queried like the snapper does, and the timings are written as JSON.
+/// No window and no GPU are used.
+/// \return EXIT_SUCCESS, if all repetitions ran
+///
+int console_benchmark(int argc, char* argv[])
+{
+    RS_DEBUG->setLevel(RS_Debug::D_NOTHING);
+
+    // render into images only, also without a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("LibreCAD");
+    QCoreApplication::setApplicationName("LibreCAD");
+    QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+    QFileInfo prgInfo(QFile::decodeName(argv[0]));
+    RS_Settings::init(app.organizationName(), app.applicationName());
+    RS_SYSTEM->init(app.applicationName(), app.applicationVersion(), XSTR(QC_APPDIR), argv[0]);
+
+    QCommandLineParser parser;
+
+    QString appDesc;
+    appDesc += "\nbenchmark usage: " + prgInfo.filePath() + " benchmark [options]\n";
+    appDesc += "\nTime loading, regenerating, rendering and snapping of a synthetic drawing.";
+    appDesc += "\nThe drawing has N lines and arcs, N/10 splines, inserts and texts, and N/100 hatches.";
+    appDesc += "\nThe results are written as JSON, with the times in ms of each repetition.";
+    parser.setApplicationDescription(appDesc);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption countOpt(QStringList() << "n" << "count",
+        "Number of lines of the drawing (default 10000).", "N");
+    parser.addOption(countOpt);
+
+    QCommandLineOption repeatOpt(QStringList() << "r" << "repeat",
+        "Number of repetitions (default 3).", "integer");
+    parser.addOption(repeatOpt);
+
+    QCommandLineOption queriesOpt(QStringList() << "q" << "queries",
+        "Number of snap queries of each kind (default 1000).", "integer");
+    parser.addOption(queriesOpt);
+
+    QCommandLineOption seedOpt(QStringList() << "s" << "seed",
+        "Seed of the random drawing (default 1).", "integer");
+    parser.addOption(seedOpt);
+
+    QCommandLineOption sizeOpt(QStringList() << "i" << "image",
+        "Size of the rendered image (default 2000x2000).", "WxH");
+    parser.addOption(sizeOpt);
+
+    QCommandLineOption outFileOpt(QStringList() << "o" << "outfile",
+        "Output JSON file (default stdout).", "file");
+    parser.addOption(outFileOpt);
+
+    parser.process(app);
+
+    BenchmarkParams params;
+    params.drawing = BenchmarkDrawingParams::scaled(parseIntArg(parser.value(countOpt), 10000, "count"),
+                                                    parseIntArg(parser.value(seedOpt), 1, "seed"));
+    params.repeat = std::max(1, parseIntArg(parser.value(repeatOpt), 3, "repeat"));
+    params.queries = parseIntArg(parser.value(queriesOpt), 1000, "queries");
+    params.outFile = parser.value(outFileOpt);
+
+    QRegularExpression sizeRe("^(?<width>\\d+)[x|X]{1}(?<height>\\d+)$");
+    QRegularExpressionMatch sizeMatch = sizeRe.match(parser.value(sizeOpt));
+    if (sizeMatch.hasMatch()) {
+        params.imageSize = QSize(sizeMatch.captured("width").toInt(), sizeMatch.captured("height").toInt());
+    } else if (parser.isSet(sizeOpt)) {
+        qDebug() << "WARNING: Ignoring bad image size:" << parser.value(sizeOpt);
+    }
+
+    RS_FONTLIST->init();
+    RS_PATTERNLIST->init();
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "ERROR: Cannot create a temporary directory";
+        return EXIT_FAILURE;
+    }
+    const QString dxfFile = tempDir.filePath("benchmark.dxf");
+
+    StageTimer timer;
+    QJsonObject counts;
+    for (int i = 0; i < params.repeat; ++i) {
+        if (!runRepetition(params, dxfFile, timer, counts)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    const BenchmarkDrawingParams& drawing = params.drawing;
+    QJsonObject parameters{{"lines", drawing.lines},
+                           {"arcs", drawing.arcs},
+                           {"splines", drawing.splines},
+                           {"inserts", drawing.inserts},
+                           {"hatches", drawing.hatches},
+                           {"texts", drawing.texts},
+                           {"seed", static_cast<int>(drawing.seed)},
+                           {"repeat", params.repeat},
+                           {"queries", params.queries},
+                           {"imageWidth", params.imageSize.width()},
+                           {"imageHeight", params.imageSize.height()}};
+    QJsonArray stages;
+    for (const StageTimes& stage: timer.getStages()) {
+        stages.append(stageResult(stage));
+    }
+    QJsonObject result{{"version", QCoreApplication::applicationVersion()},
+                       {"parameters", parameters},
+                       {"drawing", counts},
+                       {"stages", stages}};
+    const QByteArray json = QJsonDocument(result).toJson();
+
+    if (params.outFile.isEmpty()) {
+        QTextStream(stdout) << json;
+        return EXIT_SUCCESS;
+    }
+    QFile file(params.outFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        qDebug() << "ERROR: Cannot write" << params.outFile;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -36,6 +36,7 @@
 #include "main.h"
 
 #include "console_dxf2pdf.h"
+#include "lc_consolejobs.h"
 #include "pdf_print_loop.h"
 
 
@@ -76,6 +77,9 @@ int console_dxf2pdf(int argc, char* argv[])
     appDesc << "";
     appDesc << "  " + librecad + QObject::tr( " -o some.pdf *.dxf");
     appDesc << "    " + QObject::tr( "-- print all dxf files to 'some.pdf' file.");
+    appDesc << "";
+    appDesc << "  " + librecad + QObject::tr( " -j 8 *.dxf");
+    appDesc << "    " + QObject::tr( "-- print all dxf files to pdf files, 8 files at a time.");
     parser.setApplicationDescription( appDesc.join( "\n"));
 
     parser.addHelpOption();
@@ -125,6 +129,10 @@ int console_dxf2pdf(int argc, char* argv[])
         QObject::tr( "Target output directory."), "path");
     parser.addOption(outDirOpt);
 
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        QObject::tr( "Number of files processed concurrently (0 for all cores)."), "integer");
+    parser.addOption(jobsOpt);
+
     parser.addPositionalArgument(QObject::tr( "<dxf_files>"), QObject::tr( "Input DXF file(s)"));
 
     parser.process(app);
@@ -157,6 +165,7 @@ int console_dxf2pdf(int argc, char* argv[])
 
     params.outFile = parser.value(outFileOpt);
     params.outDir = parser.value(outDirOpt);
+    params.jobs = LC_ConsoleJobs::parseJobsArg(parser.value(jobsOpt));
 
     for (auto arg : args) {
         QFileInfo dxfFileInfo(arg);
@@ -22,6 +22,9 @@
 **
 ******************************************************************************/
 
+#include <algorithm>
+#include <vector>
+
 #include <QtCore>
 
 #include "rs.h"
@@ -31,19 +34,22 @@
 #include "rs_units.h"
 #include "lc_graphicviewport.h"
 #include "lc_printviewportrenderer.h"
+#include "lc_consolejobs.h"
 #include "pdf_print_loop.h"
 
 
-static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&);
-static void touchGraphic(RS_Graphic*, PdfPrintParams&);
-static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, PdfPrintParams&);
+static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&, QStringList&);
+static void touchGraphic(RS_Graphic*, const PdfPrintParams&);
+static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, const PdfPrintParams&, const QString&);
 static void drawGraphic(RS_Graphic *graphic, QPrinter &printer, RS_Painter &painter);
 
 void PdfPrintLoop::run(){
     if (params.outFile.isEmpty()) {
-        for (auto &&f : params.dxfFiles) {
-            printOneDxfToOnePdf(f);
-        }
+        // every file is printed to its own pdf, so the files are independent jobs
+        LC_ConsoleJobs jobs(params.jobs);
+        jobs.run(params.dxfFiles.size(), [this](int index, QStringList& messages) {
+            return printOneDxfToOnePdf(params.dxfFiles.at(index), messages);
+        });
     } else {
         printManyDxfToOnePdf();
     }
@@ -51,30 +57,31 @@ void PdfPrintLoop::run(){
 }
 
 
-void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
+bool PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile,
+    QStringList& messages) const {
 
     // Main code logic and flow for this method is originally stolen from
     // QC_ApplicationWindow::slotFilePrint(bool printPDF) method.
     // But finally it was split in to smaller parts.
 
     QFileInfo dxfFileInfo(dxfFile);
-    params.outFile =
+    const QString outFile =
         (params.outDir.isEmpty() ? dxfFileInfo.path() : params.outDir)
         + "/" + dxfFileInfo.completeBaseName() + ".pdf";
 
     RS_Document *doc;
     RS_Graphic *graphic;
 
-    if (!openDocAndSetGraphic(&doc, &graphic, dxfFile))
-        return;
+    if (!openDocAndSetGraphic(&doc, &graphic, dxfFile, messages))
+        return false;
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << ">>>>";
+    messages << QString("Printing \"%1\" to \"%2\" >>>>").arg(dxfFile, outFile);
 
     touchGraphic(graphic, params);
 
     QPrinter printer(QPrinter::HighResolution);
 
-    setupPrinterAndPaper(graphic, printer, params);
+    setupPrinterAndPaper(graphic, printer, params, outFile);
 
     RS_Painter painter(&printer);
 
@@ -85,16 +92,17 @@ void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
     painter.end();
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << "DONE";
+    messages << QString("Printing \"%1\" to \"%2\" DONE").arg(dxfFile, outFile);
 
     delete doc;
+    return true;
 }
 
 
 void PdfPrintLoop::printManyDxfToOnePdf() {
     struct DxfContentItems {
-        RS_Document* doc;
-        RS_Graphic* graphic;
+        RS_Document* doc = nullptr;
+        RS_Graphic* graphic = nullptr;
         QString dxfFile;
         QPageSize::PageSizeId paperSize;
     };
@@ -104,26 +112,32 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
         params.outFile = params.outDir + "/" + outFileInfo.fileName();
     }
 
-    QVector<DxfContentItems> contentItems;
-    int nrPages = 0;
+    std::vector<DxfContentItems> contentItems(params.dxfFiles.size());
 
     // FIXME: Should probably open and print all dxf files in one 'for' loop.
     // Tried but failed to do this. It looks like some 'chicken and egg'
     // situation for the QPrinter and RS_PainterQt. Therefore, first open
     // all dxf files and apply required actions. Then run another 'for'
     // loop for actual printing.
-    for (auto dxfFile : params.dxfFiles) {
-        DxfContentItems page;
-        page.dxfFile = dxfFile;
-        if (!openDocAndSetGraphic(&page.doc, &page.graphic, dxfFile))
-            continue;
+    // All pages go to the same printer, so only the opening is concurrent.
+    LC_ConsoleJobs jobs(params.jobs);
+    jobs.run(params.dxfFiles.size(), [this, &contentItems](int index, QStringList& messages) {
+        DxfContentItems& page = contentItems[index];
+        page.dxfFile = params.dxfFiles.at(index);
+        if (!openDocAndSetGraphic(&page.doc, &page.graphic, page.dxfFile, messages)) {
+            page.doc = nullptr;
+            return false;
+        }
 
-        qDebug() << "Opened" << dxfFile;
+        messages << QString("Opened \"%1\"").arg(page.dxfFile);
 
         touchGraphic(page.graphic, params);
-        contentItems.append(page);
-        nrPages++;
-    }
+        return true;
+    });
+    contentItems.erase(std::remove_if(contentItems.begin(), contentItems.end(),
+                                      [](const DxfContentItems& page) { return page.doc == nullptr; }),
+                       contentItems.end());
+    int nrPages = static_cast<int>(contentItems.size());
 
     QPrinter printer(QPrinter::HighResolution);
 
@@ -131,7 +145,7 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
         // FIXME: Is it possible to set up printer and paper for every
         // opened dxf file and tie them with painter? For now just using
         // data extracted from the first opened dxf file for all pages.
-        setupPrinterAndPaper(contentItems.at(0).graphic, printer, params);
+        setupPrinterAndPaper(contentItems.at(0).graphic, printer, params, params.outFile);
     }
 
     RS_Painter painter(&printer);
@@ -162,18 +176,18 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
 
 
 static bool openDocAndSetGraphic(RS_Document** doc, RS_Graphic** graphic,
-    const QString& dxfFile){
+    const QString& dxfFile, QStringList& messages){
     *doc = new RS_Graphic();
 
     if (!(*doc)->open(dxfFile, RS2::FormatUnknown)) {
-        qDebug() << "ERROR: Failed to open document" << dxfFile;
+        messages << QString("ERROR: Failed to open document \"%1\"").arg(dxfFile);
         delete *doc;
         return false;
     }
 
     *graphic = (*doc)->getGraphic();
     if (*graphic == nullptr) {
-        qDebug() << "ERROR: No graphic in" << dxfFile;
+        messages << QString("ERROR: No graphic in \"%1\"").arg(dxfFile);
         delete *doc;
         return false;
     }
@@ -182,7 +196,7 @@ static bool openDocAndSetGraphic(RS_Document** doc, RS_Graphic** graphic,
 }
 
 
-static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params){
+static void touchGraphic(RS_Graphic* graphic, const PdfPrintParams& params){
     graphic->calculateBorders();
     graphic->setMargins(params.margins.left, params.margins.top,
                         params.margins.right, params.margins.bottom);
@@ -205,7 +219,7 @@ static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params){
 }
 
 static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
-    PdfPrintParams& params){
+    const PdfPrintParams& params, const QString& outFile){
     bool landscape = false;
 
     RS2::PaperFormat pf = graphic->getPaperFormat(&landscape);
@@ -232,7 +246,7 @@ static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
     printer.setOrientation(landscape ? QPrinter::Landscape : QPrinter::Portrait);
 #endif
 
-    printer.setOutputFileName(params.outFile);
+    printer.setOutputFileName(outFile);
     printer.setOutputFormat(QPrinter::PdfFormat);
     printer.setResolution(params.resolution);
     printer.setFullPage(true);
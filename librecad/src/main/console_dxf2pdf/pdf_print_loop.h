@@ -49,6 +49,7 @@ struct PdfPrintParams {
         } margins;           // If margin < 0.0, use value from dxf file.
         int pagesH = 0;      // If number of pages < 1,
         int pagesV = 0;      // use value from dxf file.
+        int jobs = 1;        // Number of files loaded and printed concurrently.
 };
 
 
@@ -75,7 +76,7 @@ signals:
 private:
     PdfPrintParams params{};
 
-    void printOneDxfToOnePdf(const QString&);
+    bool printOneDxfToOnePdf(const QString&, QStringList&) const;
     void printManyDxfToOnePdf();
 };
 
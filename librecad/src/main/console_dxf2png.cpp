@@ -47,6 +47,7 @@
 #include "rs_patternlist.h"
 #include "rs_settings.h"
 #include "rs_system.h"
+#include "lc_consolejobs.h"
 #include "lc_printviewportrenderer.h"
 
 
@@ -55,7 +56,9 @@
 /// for further manipulations
 /// \return
 //////////////////////////////////////////////////////////////////////
-static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString);
+static std::unique_ptr<RS_Document> openDocAndSetGraphic(const QString&, QStringList&);
+
+static bool printDxfFile(const QString&, const QString&, const QString&, QSize, QStringList&);
 
 static void touchGraphic(RS_Graphic*);
 
@@ -118,11 +121,13 @@ int console_dxf2png(int argc, char* argv[])
             appDesc += "\n" + prog + " usage: " + prgInfo.filePath()
             + " " + prog +" [options] <dxf_files>\n";
     }
-    appDesc += "\nPrint a DXF file to a PNG/SVG file.";
+    appDesc += "\nPrint DXF files to PNG/SVG files.";
     appDesc += "\n\n";
     appDesc += "Examples:\n\n";
     appDesc += "  " + librecad + " dxf2png *.dxf";
-    appDesc += "    -- print a dxf file to a png file with the same name.\n";
+    appDesc += "    -- print dxf files to png files with the same names.\n";
+    appDesc += "  " + librecad + " dxf2png -j 8 *.dxf";
+    appDesc += "    -- the same, printing 8 files at a time.\n";
     parser.setApplicationDescription(appDesc);
 
     parser.addHelpOption();
@@ -136,6 +141,10 @@ int console_dxf2png(int argc, char* argv[])
         "Output PNG size (Width x Height) in pixels.", "WxH");
     parser.addOption(pngSizeOpt);
 
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Number of files printed concurrently (0 for all cores).", "integer");
+    parser.addOption(jobsOpt);
+
     parser.addPositionalArgument("<dxf_files>", "Input DXF file");
 
     parser.process(app);
@@ -159,9 +168,30 @@ int console_dxf2png(int argc, char* argv[])
     if (dxfFiles.isEmpty())
         parser.showHelp(EXIT_FAILURE);
 
-    // Output setup
+    QString outFileArg = parser.value(outFileOpt);
+    if (!outFileArg.isEmpty() && dxfFiles.size() > 1) {
+        qDebug() << "WARNING: Only the first file is printed to" << outFileArg;
+        dxfFiles = dxfFiles.mid(0, 1);
+    }
+    // the output format is given by the tool name, e.g. dxf2svg
+    QString outSuffix = args[0].mid(args[0].size()-3);
+
+    LC_ConsoleJobs jobs(LC_ConsoleJobs::parseJobsArg(parser.value(jobsOpt)));
+    int failed = jobs.run(dxfFiles.size(), [&](int index, QStringList& messages) {
+        return printDxfFile(dxfFiles.at(index), outFileArg, outSuffix, pngSize, messages);
+    });
+    return failed == 0 ? 0 : 1;
+}
 
-    QString& dxfFile = dxfFiles[0];
+/////////
+/// \brief printDxfFile prints one DXF file; called concurrently in the batch mode,
+/// so it owns the document and the renderer, and collects its messages.
+/// \return true on success
+///
+static bool printDxfFile(const QString& dxfFile, const QString& outFileArg, const QString& outSuffix,
+                         QSize pngSize, QStringList& messages)
+{
+    // Output setup
 
     QFileInfo dxfFileInfo(dxfFile);
     QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
@@ -169,19 +199,19 @@ int console_dxf2png(int argc, char* argv[])
         fn = "unnamed";
 
     // Set output filename from user input if present
-    QString outFile = parser.value(outFileOpt);
+    QString outFile = outFileArg;
     if (outFile.isEmpty()) {
-        outFile = dxfFileInfo.path() + "/" + fn + "." + args[0].mid(args[0].size()-3);
+        outFile = dxfFileInfo.path() + "/" + fn + "." + outSuffix;
     } else {
         outFile = dxfFileInfo.path() + "/" + outFile;
     }
 
     // Open the file and process the graphics
 
-    std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile);
+    std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile, messages);
 
     if (doc == nullptr || doc->getGraphic() == nullptr)
-        return 1;
+        return false;
     RS_Graphic *graphic = doc->getGraphic();
 
     LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
@@ -215,24 +245,24 @@ int console_dxf2png(int argc, char* argv[])
                        black, bw);
     }
 
-    qDebug() << "Printing" << dxfFile << "to" << outFile << (ret ? "Done" : "Failed");
-    return 0;
+    messages << QString("Printing \"%1\" to \"%2\" %3").arg(dxfFile, outFile, ret ? "Done" : "Failed");
+    return ret;
 }
 
 
-static std::unique_ptr<RS_Document> openDocAndSetGraphic(QString dxfFile)
+static std::unique_ptr<RS_Document> openDocAndSetGraphic(const QString& dxfFile, QStringList& messages)
 {
     auto doc = std::make_unique<RS_Graphic>();
 
     if (!doc->open(dxfFile, RS2::FormatUnknown)) {
-        qDebug() << "ERROR: Failed to open document" << dxfFile;
-        qDebug() << "Check if file exists";
+        messages << QString("ERROR: Failed to open document \"%1\"").arg(dxfFile);
+        messages << "Check if file exists";
         return {};
     }
 
     RS_Graphic* graphic = doc->getGraphic();
     if (graphic == nullptr) {
-        qDebug() << "ERROR: No graphic in" << dxfFile;
+        messages << QString("ERROR: No graphic in \"%1\"").arg(dxfFile);
         return {};
     }
 
@@ -271,11 +301,10 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
         return false;
     }
 
-    QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
-
     bool ret = false;
     // set vars for normal pictures and vectors (svg)
-    QPixmap* picture = new QPixmap(size);
+    // QImage, not QPixmap: files may be printed by worker threads
+    QImage* picture = new QImage(size, QImage::Format_RGB32);
 
     QSvgGenerator* vector = new QSvgGenerator();
 
@@ -334,7 +363,7 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
     {
         // RVT_PORT QImageIO iio;
         QImageWriter iio;
-        QImage img = picture->toImage();
+        const QImage& img = *picture;
         // RVT_PORT iio.setImage(img);
         iio.setFileName(name);
         iio.setFormat(format.toLatin1());
@@ -344,7 +373,6 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
         }
 //        QString error=iio.errorString();
     }
-    QApplication::restoreOverrideCursor();
 
     // GraphicView deletes painter
     painter.end();
@@ -0,0 +1,120 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#include <algorithm>
+#include <vector>
+
+#include <QDebug>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "lc_consolejobs.h"
+
+namespace {
+struct JobResult {
+    bool done = false;
+    bool ok = false;
+    QStringList messages;
+};
+
+void printMessages(const QStringList& messages)
+{
+    for (const QString& message: messages) {
+        qDebug().noquote() << message;
+    }
+}
+}
+
+LC_ConsoleJobs::LC_ConsoleJobs(int jobs):
+    m_jobs{jobs > 0 ? jobs : std::max(1, QThread::idealThreadCount())}
+{
+}
+
+int LC_ConsoleJobs::parseJobsArg(const QString& arg)
+{
+    if (arg.isEmpty()) {
+        return 1;
+    }
+    bool ok = false;
+    const int jobs = arg.toInt(&ok);
+    if (!ok || jobs < 0) {
+        qDebug() << "WARNING: Ignoring bad number of jobs:" << arg;
+        return 1;
+    }
+    return jobs;
+}
+
+int LC_ConsoleJobs::getJobs() const
+{
+    return m_jobs;
+}
+
+int LC_ConsoleJobs::run(int count, const Job& job) const
+{
+    int failed = 0;
+    if (m_jobs == 1 || count < 2) {
+        for (int i = 0; i < count; ++i) {
+            QStringList messages;
+            if (!job(i, messages)) {
+                ++failed;
+            }
+            printMessages(messages);
+        }
+        return failed;
+    }
+
+    std::vector<JobResult> results(count);
+    QMutex mutex;
+    QWaitCondition jobDone;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::min(m_jobs, count));
+    for (int i = 0; i < count; ++i) {
+        pool.start([i, &job, &results, &mutex, &jobDone]() {
+            QStringList messages;
+            const bool ok = job(i, messages);
+            QMutexLocker locker{&mutex};
+            results[i] = {true, ok, std::move(messages)};
+            jobDone.wakeAll();
+        });
+    }
+
+    // print in the order of the jobs; a finished result isn't touched by the workers anymore
+    for (int i = 0; i < count; ++i) {
+        {
+            QMutexLocker locker{&mutex};
+            while (!results[i].done) {
+                jobDone.wait(&mutex);
+            }
+        }
+        if (!results[i].ok) {
+            ++failed;
+        }
+        printMessages(results[i].messages);
+        results[i].messages.clear();
+    }
+    pool.waitForDone();
+    return failed;
+}
@@ -0,0 +1,69 @@
+/*
+**********************************************************************************
+**
+** This file was created for the LibreCAD project (librecad.org), a 2D CAD program.
+**
+** Copyright (C) 2024 librecad (www.librecad.org)
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**
+**********************************************************************************
+*/
+#ifndef LC_CONSOLEJOBS_H
+#define LC_CONSOLEJOBS_H
+
+#include <functional>
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The LC_ConsoleJobs class, runs the conversions of independent files for the console converters.
+ *
+ * With more than one job, the conversions run on a private thread pool, so each job must own its document,
+ * viewport and renderer. A job collects its messages instead of printing them; the messages are printed in the
+ * order of the jobs, as soon as all previous jobs are done, so the output doesn't depend on the number of jobs.
+ */
+class LC_ConsoleJobs {
+public:
+    /**
+     * @brief Job converts the file with the index, and returns whether it succeeded
+     */
+    using Job = std::function<bool(int index, QStringList& messages)>;
+
+    /**
+     * @param jobs - the number of concurrent jobs; 0 uses all cores, 1 runs the jobs by the calling thread
+     */
+    explicit LC_ConsoleJobs(int jobs);
+
+    /**
+     * @brief parseJobsArg the number of jobs from a command line value
+     * @return 1 for an empty or a bad value
+     */
+    static int parseJobsArg(const QString& arg);
+
+    int getJobs() const;
+
+    /**
+     * @brief run the jobs with the indices 0 ... count - 1, and print their messages
+     * @return the number of failed jobs
+     */
+    int run(int count, const Job& job) const;
+
+private:
+    int m_jobs = 1;
+};
+
+#endif // LC_CONSOLEJOBS_H
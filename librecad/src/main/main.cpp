@@ -38,12 +38,14 @@
 #include <QSettings>
 #include <QSplashScreen>
 
+#include "console_benchmark.h"
 #include "console_dxf2pdf.h"
 #include "console_dxf2png.h"
 #include "lc_application.h"
 #include "main.h"
 
 #include "lc_iconcolorsoptions.h"
+#include "lc_trace.h"
 #include "qc_applicationwindow.h"
 #include "qg_dlginitial.h"
 #include "rs_debug.h"
@@ -57,6 +59,7 @@ namespace
     void restoreWindowGeometry(QC_ApplicationWindow& appWin, QSettings& settings);
 // update splash for alpha/beta names)
     void updateSplash(const std::unique_ptr<QSplashScreen>& splash);
+    QString takeTraceFile(int& argc, char** argv);
 }
 /**
  * Main. Creates Application window.
@@ -67,8 +70,11 @@ int main(int argc, char** argv)
 
     QT_REQUIRE_VERSION(argc, argv, "5.2.1");
 
+    // runtime tracing covers the console tools as well, so the option is removed before they parse the arguments
+    const LC_TraceCapture traceCapture{takeTraceFile(argc, argv)};
+
     // Check first two arguments in order to decide if we want to run librecad
-    // as console dxf2pdf or dxf2png tools. On Linux we can create a link to
+    // as console dxf2pdf, dxf2png or benchmark tools. On Linux we can create a link to
     // librecad executable and  name it dxf2pdf. So, we can run either:
     //
     //     librecad dxf2pdf [options] ...
@@ -88,6 +94,9 @@ int main(int argc, char** argv)
         if (arg.compare("dxf2png") == 0 || arg == "dxf2svg") {
             return console_dxf2png(argc, argv);
         }
+        if (arg.compare("benchmark") == 0) {
+            return console_benchmark(argc, argv);
+        }
     }
 
     RS_DEBUG->setLevel(RS_Debug::D_WARNING);
@@ -136,6 +145,8 @@ int main(int argc, char** argv)
             qDebug()<<"";
             qDebug()<<"  -h, --help\tdisplay this message";
             qDebug()<<"  -d, --debug <level>";
+            qDebug()<<"  --trace <file>\twrite a Chrome trace of the session to the file,";
+            qDebug()<<"\t\talso accepted by the commands, or set by LC_TRACE_FILE";
             qDebug()<<"";
             RS_DEBUG->print( RS_Debug::D_NOTHING, "possible debug levels:");
             RS_DEBUG->print( RS_Debug::D_NOTHING, "    %d Nothing", RS_Debug::D_NOTHING);
@@ -515,4 +526,30 @@ QPixmap getSplashImage(const std::unique_ptr<QSplashScreen>& splash, const QStri
         painter.drawText(labelRect,Qt::AlignRight, label);
         return pixmapSplash;
     }
+
+    /**
+     * @brief takeTraceFile removes the --trace <file> option from the arguments; there is no short form, as -t is
+     *        taken by dxf2pdf
+     * @return the trace file of the option, or of the LC_TRACE_FILE environment variable
+     */
+    QString takeTraceFile(int& argc, char** argv)
+    {
+        QString traceFile = qEnvironmentVariable("LC_TRACE_FILE");
+        int kept = 1;
+        bool allowOptions = true;
+        for (int i = 1; i < argc; i++) {
+            const QString argstr(argv[i]);
+            if (argstr == "--") {
+                allowOptions = false;
+            }
+            if (allowOptions && argstr == "--trace" && i + 1 < argc) {
+                traceFile = QFile::decodeName(argv[++i]);
+                continue;
+            }
+            argv[kept++] = argv[i];
+        }
+        argc = kept;
+        argv[argc] = nullptr;
+        return traceFile;
+    }
 }
@@ -246,6 +246,7 @@ INCLUDEPATH += \
     # ui/not_used \
     # actions/not_used \
     main \
+    main/console_benchmark \
     main/console_dxf2pdf \
     test \
     plugins \
@@ -298,10 +299,12 @@ HEADERS += \
     lib/engine/overlays/lc_overlayentitiescontainer.h \
     lib/engine/overlays/lc_overlayentity.h \
     lib/engine/overlays/lc_overlaysmanager.h \
+    lib/engine/overlays/preview/lc_previewtransform.h \
     lib/engine/overlays/preview/rs_preview.h \
     lib/actions/rs_previewactioninterface.h \
     lib/actions/rs_snapper.h \
     lib/creation/rs_creation.h \
+    lib/debug/lc_trace.h \
     lib/debug/rs_debug.h \
     lib/engine/document/ucs/lc_ucs.h \
     lib/engine/document/views/lc_view.h \
@@ -309,6 +312,9 @@ HEADERS += \
     lib/engine/document/entities/lc_cachedlengthentity.h \
     lib/engine/overlays/crosshair/lc_crosshair.h \
     lib/engine/document/container/lc_looputils.h \
+    lib/engine/document/container/lc_endpointgraph.h \
+    lib/engine/document/container/lc_entityindex.h \
+    lib/engine/document/container/lc_hatchscanline.h \
     lib/engine/document/entities/lc_parabola.h \
     lib/engine/overlays/references/lc_refarc.h \
     lib/engine/overlays/references/lc_refcircle.h \
@@ -336,6 +342,7 @@ HEADERS += \
     lib/engine/document/entities/rs_dimlinear.h \
     lib/engine/document/entities//rs_dimradial.h \
     lib/engine/document/entities/lc_dimarc.h \
+    lib/engine/document/entities/lc_hatchlines.h \
     lib/engine/document/rs_document.h \
     lib/engine/document/entities/rs_ellipse.h \
     lib/engine/document/entities/rs_entity.h \
@@ -380,6 +387,7 @@ HEADERS += \
     lib/engine/document/variables/rs_variable.h \
     lib/engine/document/variables/rs_variabledict.h \
     lib/engine/rs_vector.h \
+    lib/fileio/lc_graphicsnapshot.h \
     lib/fileio/rs_fileio.h \
     lib/filters/rs_filtercxf.h \
     lib/filters/rs_filterdxfrw.h \
@@ -448,6 +456,7 @@ HEADERS += \
     lib/gui/render/rs_painter.h \
     lib/gui/lc_coordinates_mapper.h \
     ui/view/lc_printpreviewview.h \
+    lib/information/lc_intersectioncache.h \
     lib/information/rs_locale.h \
     lib/information/rs_information.h \
     lib/information/rs_infoarea.h \
@@ -458,11 +467,17 @@ HEADERS += \
     lib/math/rs_math.h \
     lib/math/lc_quadratic.h \
     main/console_dxf2png.h \
+    main/lc_consolejobs.h \
     test/lc_simpletests.h \
     lib/generators/lc_makercamsvg.h \
     lib/generators/lc_xmlwriterinterface.h \
     lib/generators/lc_xmlwriterqxmlstreamwriter.h \
     lib/engine/document/entities/lc_rect.h \
+    lib/engine/utils/lc_imagecache.h \
+    lib/engine/utils/lc_objectpool.h \
+    lib/engine/document/lc_memoryreport.h \
+    lib/engine/document/lc_regenscheduler.h \
+    lib/engine/lc_compactvector.h \
     lib/engine/utils/lc_rtree.h \
     lib/engine/undo/lc_undosection.h \
     lib/printing/lc_printing.h \
@@ -536,10 +551,12 @@ SOURCES += \
     lib/engine/overlays/highlight/lc_highlight.cpp \
     lib/actions/lc_modifiersinfo.cpp \
     lib/actions/rs_actioninterface.cpp \
+    lib/engine/overlays/preview/lc_previewtransform.cpp \
     lib/engine/overlays/preview/rs_preview.cpp \
     lib/actions/rs_previewactioninterface.cpp \
     lib/actions/rs_snapper.cpp \
     lib/creation/rs_creation.cpp \
+    lib/debug/lc_trace.cpp \
     lib/debug/rs_debug.cpp \
     lib/engine/document/ucs/lc_ucs.cpp \
     lib/engine/document/views/lc_view.cpp \
@@ -547,6 +564,9 @@ SOURCES += \
     lib/engine/document/entities/lc_cachedlengthentity.cpp \
     lib/engine/overlays/crosshair/lc_crosshair.cpp \
     lib/engine/document/container/lc_looputils.cpp \
+    lib/engine/document/container/lc_endpointgraph.cpp \
+    lib/engine/document/container/lc_entityindex.cpp \
+    lib/engine/document/container/lc_hatchscanline.cpp \
     lib/engine/document/entities/lc_parabola.cpp \
     lib/engine/overlays/references/lc_refarc.cpp \
     lib/engine/overlays/references/lc_refcircle.cpp \
@@ -566,6 +586,7 @@ SOURCES += \
     lib/engine/document/entities/rs_dimlinear.cpp \
     lib/engine/document/entities/rs_dimradial.cpp \
     lib/engine/document/entities/lc_dimarc.cpp \
+    lib/engine/document/entities/lc_hatchlines.cpp \
     lib/engine/document/rs_document.cpp \
     lib/engine/document/entities/rs_ellipse.cpp \
     lib/engine/document/entities/rs_entity.cpp \
@@ -600,6 +621,7 @@ SOURCES += \
     lib/engine/utils/rs_utility.cpp \
     lib/engine/document/variables/rs_variabledict.cpp \
     lib/engine/rs_vector.cpp \
+    lib/fileio/lc_graphicsnapshot.cpp \
     lib/fileio/rs_fileio.cpp \
     lib/filters/rs_filtercxf.cpp \
     lib/filters/rs_filterdxfrw.cpp \
@@ -645,6 +667,7 @@ SOURCES += \
     lib/gui/render/rs_painter.cpp \
     lib/gui/lc_coordinates_mapper.cpp \
     ui/view/lc_printpreviewview.cpp \
+    lib/information/lc_intersectioncache.cpp \
     lib/information/rs_locale.cpp \
     lib/information/rs_information.cpp \
     lib/information/rs_infoarea.cpp \
@@ -657,6 +680,7 @@ SOURCES += \
     lib/engine/rs_color.cpp \
     lib/engine/rs_pen.cpp \
     main/console_dxf2png.cpp \
+    main/lc_consolejobs.cpp \
     test/lc_simpletests.cpp \
     lib/generators/lc_xmlwriterqxmlstreamwriter.cpp \
     lib/generators/lc_makercamsvg.cpp \
@@ -664,6 +688,10 @@ SOURCES += \
     lib/engine/undo/rs_undocycle.cpp \
     lib/engine/rs_flags.cpp \
     lib/engine/document/entities/lc_rect.cpp \
+    lib/engine/utils/lc_imagecache.cpp \
+    lib/engine/utils/lc_objectpool.cpp \
+    lib/engine/document/lc_memoryreport.cpp \
+    lib/engine/document/lc_regenscheduler.cpp \
     lib/engine/utils/lc_rtree.cpp \
     lib/engine/undo/lc_undosection.cpp \
     lib/engine/rs.cpp \
@@ -1560,7 +1588,9 @@ HEADERS += \
     plugins/intern/qc_actiongetent.h \
     main/main.h \
     main/console_dxf2pdf/console_dxf2pdf.h \
-    main/console_dxf2pdf/pdf_print_loop.h
+    main/console_dxf2pdf/pdf_print_loop.h \
+    main/console_benchmark/benchmark_drawing.h \
+    main/console_benchmark/console_benchmark.h
 
 SOURCES += \
     main/qc_dialogfactory.cpp \
@@ -1570,7 +1600,9 @@ SOURCES += \
     plugins/intern/qc_actiongetent.cpp \
     main/main.cpp \
     main/console_dxf2pdf/console_dxf2pdf.cpp \
-    main/console_dxf2pdf/pdf_print_loop.cpp
+    main/console_dxf2pdf/pdf_print_loop.cpp \
+    main/console_benchmark/benchmark_drawing.cpp \
+    main/console_benchmark/console_benchmark.cpp
 
 # If C99 emulation is needed, add the respective source files.
 contains(DEFINES, EMU_C99) {
@@ -461,6 +461,9 @@ void QG_DlgOptionsGeneral::init(){
 
         bool checked = LC_GET_BOOL("CircleRenderAsArcs", false);
         rbRenderCirclesAsArcs->setChecked(checked);
+
+        checked = LC_GET_BOOL("TiledRendering", false);
+        cbRenderTiled->setChecked(checked);
     }
 
     LC_GROUP("NewDrawingDefaults");
@@ -534,6 +537,8 @@ void QG_DlgOptionsGeneral::init(){
         bool autoBackup = LC_GET_BOOL("AutoBackupDocument", true);
         cbAutoBackup->setChecked(autoBackup);
         cbAutoSaveTime->setEnabled(autoBackup);
+        sbUndoCycleLimit->setValue(LC_GET_INT("UndoCycleLimit", 0));
+        sbUndoMemoryLimit->setValue(LC_GET_INT("UndoMemoryLimit", 512));
         cbUseQtFileOpenDialog->setChecked(LC_GET_BOOL("UseQtFileOpenDialog", true));
         cbWheelScrollInvertH->setChecked(LC_GET_BOOL("WheelScrollInvertH"));
         cbWheelScrollInvertV->setChecked(LC_GET_BOOL("WheelScrollInvertV"));
@@ -776,6 +781,7 @@ void QG_DlgOptionsGeneral::ok(){
             LC_SET("ArcRenderInterpolateSegmentAngle", sbRenderArcSegmentAngle->value() * 100);
             LC_SET("ArcRenderInterpolateSegmentSagitta", sbRenderArcMaxSagitta->value() * 100);
             LC_SET("CircleRenderAsArcs", rbRenderCirclesAsArcs->isChecked());
+            LC_SET("TiledRendering", cbRenderTiled->isChecked());
         }
 
         LC_GROUP("Colors"); {
@@ -831,6 +837,8 @@ void QG_DlgOptionsGeneral::ok(){
             LC_SET("Unit", RS_Units::unitToString(RS_Units::stringToUnit(cbUnit->currentText()), false/*untr.*/));
             LC_SET("AutoSaveTime", cbAutoSaveTime->value());
             LC_SET("AutoBackupDocument", cbAutoBackup->isChecked());
+            LC_SET("UndoCycleLimit", sbUndoCycleLimit->value());
+            LC_SET("UndoMemoryLimit", sbUndoMemoryLimit->value());
             LC_SET("UseQtFileOpenDialog", cbUseQtFileOpenDialog->isChecked());
             LC_SET("WheelScrollInvertH", cbWheelScrollInvertH->isChecked());
             LC_SET("WheelScrollInvertV", cbWheelScrollInvertV->isChecked());
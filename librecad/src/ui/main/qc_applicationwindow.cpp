@@ -1761,22 +1761,24 @@ void QC_ApplicationWindow::slotFileAutoSave() {
 
     QC_MDIWindow *w = getMDIWindow();
     if (w) {
-        bool cancelled;
-        if (w->slotFileSave(cancelled, true)) {
-            // auto-save cannot be cancelled by user, so the
-            // "cancelled" parameter is a dummy
-            statusBar()->showMessage(tr("Auto-saved drawing"), 2000);
-        } else {
-            // error
-            m_autosaveTimer->stop();
-            QMessageBox::information(this, QMessageBox::tr("Warning"),
-                                     tr("Cannot auto-save the file\n%1\nPlease "
-                                        "check the permissions.\n"
-                                        "Auto-save disabled.")
-                                         .arg(w->getDocument()->getAutoSaveFilename()),
-                                     QMessageBox::Ok);
-            statusBar()->showMessage(tr("Auto-saving failed"), 2000);
-        }
+        const QString fileName = w->getDocument()->getAutoSaveFilename();
+        w->autoSave([this, fileName](bool saved) {
+            if (saved) {
+                statusBar()->showMessage(tr("Auto-saved drawing"), 2000);
+            } else {
+                // error
+                if (m_autosaveTimer != nullptr) {
+                    m_autosaveTimer->stop();
+                }
+                QMessageBox::information(this, QMessageBox::tr("Warning"),
+                                         tr("Cannot auto-save the file\n%1\nPlease "
+                                            "check the permissions.\n"
+                                            "Auto-save disabled.")
+                                             .arg(fileName),
+                                         QMessageBox::Ok);
+                statusBar()->showMessage(tr("Auto-saving failed"), 2000);
+            }
+        });
     }
 }
 
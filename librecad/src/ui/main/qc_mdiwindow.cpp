@@ -36,6 +36,7 @@
 #include <QMessageBox>
 #include <QMdiArea>
 #include <QPainter>
+#include <QThread>
 
 #include "qc_applicationwindow.h"
 #include "qc_mdiwindow.h"
@@ -43,6 +44,7 @@
 #include "qg_exitdialog.h"
 #include "qg_filedialog.h"
 #include "qg_graphicview.h"
+#include "lc_graphicsnapshot.h"
 #include "rs_debug.h"
 #include "rs_graphic.h"
 #include "rs_insert.h"
@@ -122,6 +124,10 @@ QC_MDIWindow::QC_MDIWindow(RS_Document *doc, QWidget *parent, bool printPreview)
 QC_MDIWindow::~QC_MDIWindow()
 {
     RS_DEBUG->print("~QC_MDIWindow: begin");
+    // the copy of the drawing is written independently, only the thread must not be deleted while running
+    if (autoSaveThread != nullptr) {
+        autoSaveThread->wait();
+    }
     try {
         if(!(graphicView != nullptr && graphicView->isCleanUp())){
 
@@ -452,6 +458,46 @@ bool QC_MDIWindow::slotFileSave(bool &cancelled, bool isAutoSave) {
 
 
 
+bool QC_MDIWindow::autoSave(std::function<void(bool)> onFinished) {
+    RS_DEBUG->print("QC_MDIWindow::autoSave()");
+    RS_Graphic* graphic = getGraphic();
+    if (graphic == nullptr || autoSaveThread != nullptr) {
+        return false;
+    }
+    if (!graphic->isModified()) {
+        onFinished(true);
+        return true;
+    }
+
+    auto snapshot = std::make_shared<LC_GraphicSnapshot>(*graphic, graphic->getAutoSaveFilename(),
+                                                         graphic->getFormatType());
+    QThread* thread = QThread::create([snapshot]() {
+        snapshot->write();
+    });
+    autoSaveThread = thread;
+
+    QPointer<QC_MDIWindow> window{this};
+    connect(thread, &QThread::finished, thread, [thread, window, snapshot, onFinished]() {
+        thread->deleteLater();
+        if (window.isNull()) {
+            snapshot->discard();
+            return;
+        }
+        window->autoSaveThread = nullptr;
+        // the drawing was saved meanwhile, and the autosave file removed
+        RS_Graphic* graphic = window->getGraphic();
+        if (graphic == nullptr || !graphic->isModified()) {
+            snapshot->discard();
+            onFinished(true);
+            return;
+        }
+        onFinished(snapshot->commit());
+    });
+    thread->start(QThread::LowPriority);
+    return true;
+}
+
+
 /**
  * Saves the current file. The user is asked for a new filename
  * and format.
@@ -27,8 +27,11 @@
 #ifndef QC_MDIWINDOW_H
 #define QC_MDIWINDOW_H
 
+#include <functional>
+
 #include <QMdiSubWindow>
 #include <QList>
+#include <QPointer>
 #include "rs.h"
 #include "rs_layerlistlistener.h"
 #include "rs_blocklistlistener.h"
@@ -41,6 +44,7 @@ class RS_Pen;
 class QMdiArea;
 class RS_EventHandler;
 class QCloseEvent;
+class QThread;
 
 /**
  * MDI document window. Contains a document and a view (window).
@@ -90,6 +94,15 @@ public:
 
     QC_MDIWindow* getPrintPreview();
 
+    /**
+     * Saves a copy of the drawing into the autosave file on a worker thread.
+     * Only copying the drawing blocks the caller.
+     *
+     * @param onFinished called with the result, if the window still exists
+     * @return false if an autosave of this window is still running.
+     */
+    bool autoSave(std::function<void(bool)> onFinished);
+
     // Methods from RS_LayerListListener Interface:
     void layerListModified(bool) override {
         setWindowModified(document->isModified());
@@ -145,6 +158,8 @@ private:
      */
     QC_MDIWindow* parentWindow{nullptr};
     QMdiArea* cadMdiArea = nullptr;
+    /** thread writing the autosave file, or NULL */
+    QPointer<QThread> autoSaveThread;
 };
 
 